@@ -0,0 +1,7469 @@
+#include "NinjaFood.h"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <iomanip>
+#include <ctime>
+#include <chrono>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <sstream>
+#include <cstdlib>
+#include <filesystem>
+#include <list>
+#include <array>
+#include <deque>
+#include <unordered_set>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <thread>
+#include <atomic>
+#include <cstring>
+#include <condition_variable>
+#include <cmath>
+#include <random>
+#include <type_traits>
+#include <charconv>
+#include <cstdio>
+#include <cstddef>
+#include <cerrno>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#endif
+
+using namespace std;
+
+// Number of menu items shown per page when browsing the menu
+const int MENU_PAGE_SIZE = 10;
+
+// Number of bytes read from standard input at a time (scripted input is read in large blocks, not byte by byte)
+const size_t INPUT_BUFFER_SIZE = 1 << 16;
+
+// Maximum number of option modifiers a single menu item can have (one bit each in an order line)
+const int MAX_ITEM_MODIFIERS = 31;
+
+// Maximum number of branch menus kept in memory at once (the least recently used one is dropped first)
+const int BRANCH_CACHE_CAPACITY = 4;
+
+// Number of item prices in each block of a price snapshot (a price change copies only the block it falls in)
+const int PRICE_CHUNK_SIZE = 32;
+
+// Maximum number of items the shared catalog of a branch can hold (a bigger menu is read from its file alone)
+const int SHARED_CATALOG_CAPACITY = 1024;
+
+// Number of bytes of an item name kept in the shared catalog (a longer name is taken from the menu file instead)
+const int SHARED_NAME_SIZE = 64;
+
+// Number of milliseconds a kiosk waits for another kiosk to set up the shared catalog, or to finish publishing
+// its items, before working without it
+const int SHARED_CATALOG_WAIT_MS = 2000;
+
+// Number of seconds the items in an unpaid cart stay reserved after the cart was last changed
+const int RESERVATION_TTL_SECONDS = 15 * 60;
+
+// Number of one-second slots in the reservation timer wheel (more than RESERVATION_TTL_SECONDS, so a
+// reservation never has to wait for the wheel to go round more than once)
+const int RESERVATION_WHEEL_SLOTS = 1024;
+
+// Order ID the stock of a paid order is reserved under while it is written to the menu file
+// (order IDs given out to carts start at 1)
+const int COMMITTING_ORDER_ID = 0;
+
+// Returned instead of a menu index when the stock of a paid order could not be written to the menu file
+const int STOCK_NOT_SAVED = -1;
+
+// Menu rows the catalog cache records for lines of the menu file that are not items: a line that does not fit the
+// layout, and one that only does not fit because of its stock (it becomes an item once the stock is corrected)
+const int32_t MENU_LINE_SKIPPED = -1;
+const int32_t MENU_LINE_BAD_STOCK = -2;
+
+// Number of milliseconds the persistence thread lets writes gather once one is queued, so the writes of every
+// order paid meanwhile reach each file together (one open, lock and write per file instead of one per order)
+const int PERSISTENCE_BATCH_MS = 5;
+
+// Maximum number of kitchen tickets waiting for the kitchen (ordering waits while the queue is full)
+const int KITCHEN_QUEUE_CAPACITY = 64;
+
+// Maximum number of tickets the kitchen picks up from the queue at once
+const int KITCHEN_BATCH_SIZE = 8;
+
+// Number of milliseconds between checks for new events while following the event stream (NINJAFOOD_EVENTS)
+const int EVENT_POLL_MS = 200;
+
+// Number of threads settling payments in the background, so that many slow gateway replies are waited for at once
+const int SETTLEMENT_THREADS = 4;
+
+// Maximum number of times a payment is sent to the payment gateway when its reply does not come back
+const int SETTLEMENT_ATTEMPTS = 5;
+
+// Settings of the local stand-in for the payment gateway (see gatewayCharge). The seed decides which replies are
+// lost, and the card number is always declined, so a declined payment can be tried out
+const unsigned GATEWAY_SEED = 20240715;
+const string GATEWAY_DECLINED_CARD = "4000000000000002";
+
+// Number of seconds between runs of the background job that folds the stats logs into their snapshots
+const int COMPACTION_INTERVAL_SECONDS = 60;
+
+// Size (in bytes) a top dish or total sales log grows to before the compaction job, having folded it into the
+// stats snapshot, starts it again empty
+const uint64_t STATS_LOG_ROTATE_BYTES = 1 << 20;
+
+// Number of seconds a manager's session stays open without being used
+const int SESSION_IDLE_SECONDS = 15 * 60;
+
+// Permissions a manager account can have (one bit each); the account's role decides which it has
+const uint32_t PERMISSION_EDIT_MENU = 1; // Create and update the menu
+const uint32_t PERMISSION_EDIT_PRICES = 2; // Update the prices of menu items
+const uint32_t PERMISSION_VIEW_STATS = 4; // View stats and sales reports
+
+// Number of hours the stock consumption rates average over (an order this old counts for about a third
+// of a new one, and one twice as old for about a ninth)
+const double CONSUMPTION_WINDOW_HOURS = 24.0;
+
+// Number of hours it takes to get new stock delivered; an item is low on stock once it would run out within this time
+const double RESTOCK_LEAD_HOURS = 4.0;
+
+// Number of hours of consumption a restock should cover once it has been delivered
+const double RESTOCK_COVER_HOURS = 24.0;
+
+// Settings of the simulated day of orders (see runSimulation). The same seed always gives the same day,
+// so runs can be compared with each other
+const unsigned SIMULATION_SEED = 20240601;
+const double SIMULATION_ZIPF_EXPONENT = 1.0; // Popularity of the n-th most popular item is 1 / n^exponent
+const int SIMULATION_RETURNING_PERCENT = 60; // Share of orders placed by customers who ordered before
+const int SIMULATION_MAX_LINES = 4; // Maximum number of different items in one simulated order
+const int SIMULATION_MAX_QUANTITY = 3; // Maximum quantity of one simulated order line
+const int SIMULATION_ADDON_PERCENT = 25; // Chance of each add-on being chosen
+const string SIMULATION_CARD_NUMBER = "4242424242424242"; // Card the simulated customers pay with
+
+// Relative number of orders placed in each hour of the simulated day, with lunch and dinner peaks
+const int SIMULATION_HOURLY_WEIGHTS[24] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3, 6, 10, 9, 4, 3, 3, 5, 9, 10, 7, 3, 0, 0};
+
+// Branch the simulation runs in: a scratch copy of the real branch's menu, started afresh on every run
+// (the dot keeps it apart from every registered branch, whose IDs cannot contain one)
+const string SIMULATION_BRANCH_ID = ".simulation";
+
+// Structure to hold one delivery area of the restaurant and the travel time to it
+struct DeliveryArea {
+    const char* name; // Name of the area
+    int travelTime; // Travel time from the restaurant (in minutes)
+};
+
+// Delivery areas served by the restaurant; the customer picks one by its number, starting from 1
+// Everything to do with areas (the prompt, the travel times, the names on tickets and reports) comes from this table
+constexpr DeliveryArea DELIVERY_AREAS[] = {
+    {"Cahaya Gemilang", 5},
+    {"Aman Damai", 5},
+    {"Indah Kembara", 6},
+    {"Restu", 10},
+    {"Saujana", 9},
+    {"Tekun", 8},
+};
+constexpr int NUM_OF_DELIVERY_AREAS = sizeof(DELIVERY_AREAS) / sizeof(DELIVERY_AREAS[0]);
+static_assert(NUM_OF_DELIVERY_AREAS >= 1 && NUM_OF_DELIVERY_AREAS <= 9, "Delivery areas are stored as a single digit");
+
+// Kinds of account a customer names when paying with a tender, which decide how what they type is checked
+enum class TenderReference {
+    None, // Nothing to name (e.g. cash)
+    CardNumber, // A card number (12 to 19 digits, passing the Luhn check)
+    PhoneNumber // The phone number an e-wallet is registered to (10 or 11 digits)
+};
+
+// Structure to describe one tender (way of paying)
+struct TenderSpec {
+    const char* name; // Name shown to the customer and written to the payment ledger
+    TenderReference reference; // Account the customer names when paying this way
+    const char* referencePrompt; // What the customer is asked for to name the account (nullptr for none)
+    bool throughGateway; // Whether payments are charged through the payment gateway (otherwise they are settled as they are)
+    bool givesChange; // Whether the customer may hand over more than is due and get change back
+};
+
+// Tenders the customer can pay with; the customer picks one by its number, starting from 1, and may split a
+// payment across several. Everything to do with tenders (the prompt, the checks, settlement) comes from this table
+constexpr TenderSpec TENDERS[] = {
+    {"Cash", TenderReference::None, nullptr, false, true},
+    {"Card", TenderReference::CardNumber, "Card number", true, false},
+    {"E-wallet", TenderReference::PhoneNumber, "Phone number of your e-wallet", true, false},
+};
+constexpr int NUM_OF_TENDERS = sizeof(TENDERS) / sizeof(TENDERS[0]);
+static_assert(NUM_OF_TENDERS >= 1 && NUM_OF_TENDERS <= 9, "Tenders are chosen by a single digit");
+
+// Columns of the menu file, in the order they are written, used to pick a detail out of a menu row
+// (e.g. arrMenuContent[row][MENU_STOCK]). The last three columns are optional
+enum MenuField {
+    MENU_INDEX, // Index number of the item
+    MENU_NAME, // Name of the item
+    MENU_PRICE, // Price of the item, with two decimals
+    MENU_PREP_TIME, // Preparation time (in minutes)
+    MENU_STOCK, // Stock quantity
+    MENU_CATEGORY, // Category of the item
+    MENU_MODIFIERS, // Option modifiers of the item (see parseModifiers)
+    MENU_COMPONENTS, // Combo components of the item (see parseComboComponents)
+    NUM_OF_MENU_FIELDS
+};
+
+// Kinds of value a menu column holds, which decide how it is checked when the menu is read
+enum class MenuFieldKind {
+    Integer, // A whole number
+    Price, // An amount of money
+    Text // Any text without commas
+};
+
+// Structure to describe one column of the menu file
+struct MenuFieldSpec {
+    MenuField field; // The column
+    MenuFieldKind kind; // Kind of value it holds
+    bool optional; // Whether the column may be left out (optional columns come last and are written up to the last one used)
+};
+
+// The layout of the menu file: readMenuFile and writeMenu both follow this list, so they always agree
+constexpr MenuFieldSpec MENU_FIELDS[] = {
+    {MENU_INDEX, MenuFieldKind::Integer, false},
+    {MENU_NAME, MenuFieldKind::Text, false},
+    {MENU_PRICE, MenuFieldKind::Price, false},
+    {MENU_PREP_TIME, MenuFieldKind::Integer, false},
+    {MENU_STOCK, MenuFieldKind::Integer, false},
+    {MENU_CATEGORY, MenuFieldKind::Text, true},
+    {MENU_MODIFIERS, MenuFieldKind::Text, true},
+    {MENU_COMPONENTS, MenuFieldKind::Text, true},
+};
+
+// Function to check at compile time that MENU_FIELDS lists every column once, in order, with the optional ones last
+constexpr bool menuFieldsInOrder() {
+    if (sizeof(MENU_FIELDS) / sizeof(MENU_FIELDS[0]) != NUM_OF_MENU_FIELDS)
+        return false;
+    for (int i = 0; i < NUM_OF_MENU_FIELDS; i++) {
+        if (MENU_FIELDS[i].field != i || (i > 0 && MENU_FIELDS[i - 1].optional && !MENU_FIELDS[i].optional))
+            return false;
+    }
+    return true;
+}
+static_assert(menuFieldsInOrder(), "MENU_FIELDS must list the menu columns in order, optional columns last");
+
+// Structure to hold an amount of money as a whole number of cents, so totals never drift by rounding
+// Amounts are written to files and shown on screen with exactly two decimals, e.g. "12.50"
+struct Money {
+    int64_t cents = 0; // The amount in cents
+
+    Money operator+(Money other) const { return Money{cents + other.cents}; }
+    Money operator-(Money other) const { return Money{cents - other.cents}; }
+    Money operator*(int64_t factor) const { return Money{cents * factor}; }
+    Money& operator+=(Money other) { cents += other.cents; return *this; }
+    Money& operator-=(Money other) { cents -= other.cents; return *this; }
+    bool operator==(Money other) const { return cents == other.cents; }
+    bool operator!=(Money other) const { return cents != other.cents; }
+    bool operator<(Money other) const { return cents < other.cents; }
+    bool operator>(Money other) const { return cents > other.cents; }
+    bool operator<=(Money other) const { return cents <= other.cents; }
+    bool operator>=(Money other) const { return cents >= other.cents; }
+    string str() const; // The amount with two decimals, e.g. "12.50"
+};
+
+// Structure to hold one version of the item prices of a menu, which a cart is priced at from start to finish
+// The prices are kept by menu index in blocks of PRICE_CHUNK_SIZE. A block is never changed once made, so a new
+// version shares every block whose prices did not change with the version before it, and a cart pinning an older
+// version only keeps the blocks that have changed since alive
+struct PriceSnapshot {
+    uint64_t version = 0; // Version of the prices, counted from 1 in each kiosk process
+    vector<shared_ptr<const array<Money, PRICE_CHUNK_SIZE>>> chunks; // Prices by menu index (-1 cents if there is no such item)
+};
+
+// Structure to hold one line of a customer's cart, as shown on the receipt
+struct ReceiptLine {
+    int menuIndex = 0; // Menu index of the item
+    string itemName; // Name of the item, with the options chosen
+    int modifierMask = 0; // The options chosen, one bit per modifier of the item
+    Money itemPrice; // Price of one unit, with the options chosen, as quoted when the line was ordered
+    int preparationTime = 0; // Preparation time of one unit, in minutes
+    int quantity = 0; // Number of units ordered
+};
+
+// Structure to hold details about users (manager and customer)
+struct UserDetails {
+    // Manager credentials for logging into the system
+    string username; // Store the username of the restaurant manager
+    string password; // Store the password of the restaurant manager
+
+    // Customer details for making orders
+    string customerName; // Store the name of the customer
+    string phoneNumber; // Store the phone number of the customer
+    int orderId = 0; // Reservation holding the stock of the customer's unpaid cart (0 if none)
+    shared_ptr<const PriceSnapshot> pinnedPrices; // Prices the customer's cart is priced at (taken when the cart is started)
+    string orderedAt; // Date and time the customer's cart was ordered, as given by ctime
+    vector<ReceiptLine> cart; // The customer's unpaid cart (kept by this kiosk only, so kiosks never share a cart)
+};
+
+// Structure to hold one line of a simulated order
+struct SimulatedLine {
+    int row; // Menu row of the item
+    int quantity; // Number of units ordered
+    int modifierMask; // The options chosen, one bit per modifier of the item
+};
+
+// Structure to hold the counts collected while simulating a day of orders
+struct SimulationStats {
+    int numOfOrders = 0; // Orders placed
+    int numOfPaidOrders = 0; // Orders paid for
+    int numOfLines = 0; // Order lines placed
+    int numOfRejectedLines = 0; // Order lines rejected by acceptOrder (not enough stock)
+    int numOfEmptyOrders = 0; // Orders abandoned because every line was rejected
+    int numOfFailedPayments = 0; // Orders turned down once paid (stock gone since the lines were accepted), to be refunded
+    int numOfUnsettledOrders = 0; // Orders cancelled because their payment was declined or failed
+    int numOfNewcomers = 0; // Paid orders from new customers
+    Money totalRevenue; // Amount paid, after discounts
+    int hourOrders[24] = {}; // Orders placed in each hour of the day
+};
+
+// Structure to hold a simulated order whose payment is being settled, to be finished once it has been
+struct SimulatedOrder {
+    UserDetails customer; // The customer who placed the order
+    int orderId = 0; // The order's cart, holding its stock until the order is finished
+    string paymentKey; // Idempotency key of the order's payment
+    time_t placedAt = 0; // When the order was placed
+    char deliveryAreaNum = '1'; // Area the order is delivered to
+    int previousOrders = 0; // Number of orders the customer made before
+    vector<int> orderedMenuIndices; // Menu index of each accepted line
+    vector<string> orderedItemNames; // Name of each accepted line, with its options
+    vector<int> orderedQuantities; // Quantity of each accepted line
+    Money total; // Amount paid, after discounts
+    vector<Money> lineRevenue; // Revenue of each line, after discounts
+};
+
+// Structure to hold the search index over menu item names, built once when the catalog is loaded
+// The trigram table lists every packed 3-character sequence of the names in ascending order, with the menu rows
+// containing it: the rows of trigram t are trigramRows[trigramStart[t]] up to trigramRows[trigramStart[t + 1]].
+// A menu loaded from the catalog cache uses the table where it lies in the mapped cache; otherwise the table is
+// built in the storage vectors
+struct MenuSearchIndex {
+    int totalNumItems = 0; // Number of menu items covered by the index
+    vector<string> lowerNames; // Lowercased item names, one per menu row
+    size_t numOfTrigrams = 0; // Number of trigrams in the table
+    const uint32_t* trigrams = nullptr; // The trigrams, in ascending order
+    const uint32_t* trigramStart = nullptr; // Start of each trigram's rows (one extra entry at the end)
+    const int* trigramRows = nullptr; // Rows of every trigram, back to back
+    vector<uint32_t> trigramStorage; // Holds the trigrams when the table was built rather than mapped
+    vector<uint32_t> trigramStartStorage; // Holds the starts when the table was built
+    vector<int> trigramRowStorage; // Holds the rows when the table was built
+};
+
+// Structure to hold one option modifier of a menu item (a size choice or an add-on with its price difference)
+struct MenuModifier {
+    string name; // Name of the option, e.g. "Large" or "Cheese"
+    char kind; // 'S' for a size (customer picks exactly one) or 'A' for an add-on (customer picks any)
+    Money priceDelta; // Amount added to the item price when the option is chosen
+};
+
+// Structure to hold one component of a combo meal
+struct ComboComponent {
+    int row; // Menu row of the component item
+    int quantity; // Number of the component item used by one combo
+};
+
+// Structure to hold the categories, option modifiers and combo components of the whole menu
+// Modifiers and components of all items are kept back to back in flat arrays, and item i owns
+// the entries from start[i] up to (not including) start[i + 1]
+struct MenuModel {
+    vector<string> categories; // Distinct category names (category 0 means "no category")
+    vector<uint16_t> itemCategory; // Category of each menu row (index into categories)
+    vector<uint32_t> modifierStart; // Start of each row's modifiers (one extra entry at the end)
+    vector<MenuModifier> modifiers; // Option modifiers of every item
+    vector<uint32_t> componentStart; // Start of each row's combo components (one extra entry at the end)
+    vector<ComboComponent> components; // Combo components of every item
+};
+
+// Structure to hold one happy-hour window of a promotion plan (a percentage off while the window is open)
+struct HappyHourWindow {
+    int startMinute; // Opening time, in minutes after midnight
+    int endMinute; // Closing time, in minutes after midnight (before startMinute if the window runs past midnight)
+    int category; // Category the window applies to (-1 for every item)
+    uint8_t percent; // Percentage taken off
+    uint16_t rule; // Rule the window comes from (index into ruleNames)
+};
+
+// Structure to hold one loyalty tier of a promotion plan
+struct LoyaltyTier {
+    int minVisits; // Number of previous orders needed to reach the tier
+    uint8_t percent; // Percentage taken off the order
+    uint16_t rule; // Rule the tier comes from (index into ruleNames)
+};
+
+// Structure to hold the promotion rules of a branch compiled into tables, so pricing a cart is a
+// single loop over its lines: item and category rules are resolved to the best discount of every
+// menu row when the rules are loaded, instead of being matched against each line at checkout
+struct PromotionPlan {
+    vector<string> ruleNames; // Name of each rule, shown to the customer when it is applied
+    vector<uint8_t> rowPercent; // Best percentage off each menu row from the item and category rules
+    vector<uint16_t> rowPercentRule; // Rule giving each row's percentage
+    vector<uint16_t> rowBuyQuantity; // Units paid for in each row's buy-X-get-Y deal (0 = no deal)
+    vector<uint16_t> rowFreeQuantity; // Units given free in each row's buy-X-get-Y deal
+    vector<uint16_t> rowDealRule; // Rule giving each row's deal
+    vector<HappyHourWindow> happyHours; // Happy-hour windows
+    uint8_t newcomerPercent = 0; // Percentage off the first order of a new customer
+    uint16_t newcomerRule = 0; // Rule giving the newcomer percentage
+    vector<LoyaltyTier> loyaltyTiers; // Loyalty tiers, highest number of visits first
+};
+
+// Structure to hold one line of a cart being priced
+struct CartLine {
+    int row; // Menu row of the item
+    Money unitPrice; // Price of one unit, including its options
+    int quantity; // Number of units ordered
+};
+
+// Structure to hold the result of pricing a cart with a promotion plan
+struct PricedCart {
+    Money subtotal; // Price of the cart before any discount
+    Money discount; // Total of all discounts
+    Money total; // Amount to pay
+    vector<Money> lineRevenue; // Amount paid for each line, after its share of every discount
+    vector<Money> ruleSavings; // Amount taken off by each rule (index into ruleNames)
+};
+
+// Structure to hold the profile of one customer as a fixed-size record (48 bytes), so the profile file
+// can be updated in place; the customer's name is kept in a separate name heap file
+struct CustomerProfile {
+    uint64_t phoneKey; // Phone number packed into a number (see customerPhoneKey)
+    uint32_t nameOffset; // Position of the customer's name in the name heap
+    uint32_t nameLength; // Length of the customer's name
+    uint32_t visitCount; // Number of paid orders
+    int32_t favouriteItem; // Menu index of the item the customer orders most (0 if none yet)
+    int32_t favouriteWeight; // Running count that keeps the favourite item up to date
+    uint32_t reserved; // Unused; keeps the record size a multiple of 8
+    int64_t lifetimeSpend; // Total amount paid, in cents
+    int64_t lastOrderTime; // When the last order was paid
+};
+static_assert(sizeof(CustomerProfile) == 48, "customer profile records are stored in files and must keep their size");
+
+// Structure to hold the customer profiles of the current branch in memory, with an index by phone number
+// Every kiosk process of the branch adds to and updates the same profile file, so the profiles are brought up to
+// date from the file (see refreshCustomerProfile) before one is used, and changed under the file's lock
+struct CustomerProfileStore {
+    bool loaded = false; // Whether the profiles have been read from the profile file
+    vector<CustomerProfile> profiles; // Every profile, in the order they were created (the order of the file)
+    unordered_map<uint64_t, uint32_t> profileOfPhone; // Packed phone number -> position in profiles
+    fstream file; // The profile file, kept open once the profiles are loaded
+    int lockDescriptor = -1; // The profile file's lock file, kept open once the profiles are loaded (-1 if none)
+};
+
+// Structure to hold the stock reserved by one unpaid cart
+struct StockReservation {
+    unordered_map<int, int> quantities; // Quantity reserved of each stocked item (combos are reserved as their components)
+    time_t expiresAt = 0; // When the reservation lapses if the cart is not paid
+};
+
+// Structure to hold the stock reservations of the current branch. Ordering reserves stock instead of
+// deducting it; stock is only deducted when the order is paid. A timer wheel with one slot per second
+// lists the carts due to expire in that second, so expired carts are found without checking every cart
+// The reservations are held by this kiosk process only: other kiosks of the branch (even with a shared
+// catalog) do not see them, so a cart's stock is kept from the carts of the same kiosk, and across kiosks
+// the stock check made when an order is paid (see commitOrderStock) is what keeps the stock from running out
+struct ReservationTable {
+    mutex lock; // Protects all of the members below
+    unordered_map<int, StockReservation> reservations; // Reservation of each unpaid cart, by order ID
+    unordered_map<int, int> reservedStock; // Total quantity reserved of each stocked item, by menu index
+    vector<vector<int>> wheel = vector<vector<int>>(RESERVATION_WHEEL_SLOTS); // Order IDs due to expire in each second
+    time_t wheelTime = 0; // Last second the wheel has been advanced to
+    int lastOrderId = 0; // Last order ID given out
+};
+
+// Structure to hold the input layer: standard input is read in blocks and handed out one line at a time,
+// and every prompt reads a whole line and then checks it. A typo therefore only ever costs one line,
+// and never leaves the input stuck on characters that cannot be read
+struct InputReader {
+    vector<char> buffer = vector<char>(INPUT_BUFFER_SIZE); // Bytes read from standard input
+    size_t position = 0; // Next byte of the buffer to hand out
+    size_t length = 0; // Number of bytes in the buffer
+    bool ended = false; // Whether standard input has run out
+};
+
+// Structure to hold the start of the binary catalog cache (menu.cache) of a branch
+// The cache holds a branch's menu, model, search index and promotion plan exactly as they are kept in
+// memory, so a new process can load them without parsing the text files. The stock, which changes with
+// every paid order, is left out: it is read from the menu file where it lies whenever the cache is loaded,
+// and the rest of the menu file (its layout) must hash the same as when the cache was built. The promotions
+// file must be the one the cache was built from: same size, and same modification time or content hash
+struct CatalogCacheHeader {
+    char magic[8]; // File type marker, "NFCAT" followed by the format version
+    uint64_t menuLayoutHash; // Content hash of the menu file the cache was built from, without its stock column
+    uint64_t promotionsSize; // Size of the promotions file the cache was built from (0 if there was none)
+    uint64_t promotionsHash; // Content hash of that promotions file
+    int64_t promotionsModified; // Modification time of that promotions file (in file clock ticks)
+    uint64_t totalNumItems; // Number of items on the menu
+};
+static_assert(NUM_OF_MENU_FIELDS == 8, "The catalog cache stores 8 menu details per item: change its format version along with MENU_FIELDS");
+
+// Structure to hold a file mapped into memory (or read into memory where mapping is not available)
+struct MappedFile {
+    const char* data = nullptr; // Contents of the file
+    size_t size = 0; // Size of the file
+    string buffer; // Holds the contents when the file could not be mapped
+    bool mapped = false; // Whether data points into a memory mapping (rather than into buffer)
+};
+
+// Structure to hold a position in the catalog cache while it is being read
+struct CacheReader {
+    const char* cursor; // Next byte to read
+    const char* end; // End of the cache
+    bool ok = true; // Cleared when the cache turns out to be shorter than its contents say
+};
+
+// Structure to hold one item of a shared catalog (see SharedCatalogSegment)
+struct SharedCatalogItem {
+    atomic<uint64_t> stock; // Live stock: the layout epoch it belongs to (upper 32 bits) and the count (lower 32 bits)
+    atomic<int32_t> fileStock; // Stock last written to the menu file for the item (only changed under the file lock)
+    atomic<int32_t> menuIndex; // Index number of the item (sequence-locked, like the members below)
+    atomic<int64_t> priceCents; // Price of the item, in cents
+    atomic<int32_t> nameLength; // Length of the item name (more than SHARED_NAME_SIZE if it did not fit)
+    atomic<uint64_t> nameWords[SHARED_NAME_SIZE / 8]; // The item name, 8 characters per word
+};
+
+// Structure to hold the shared catalog of a branch: a shared memory segment that every kiosk process of the
+// branch on the same host maps, so they all see the same live stock and prices without reading the menu file.
+// The stock counts are changed with atomic compare-and-swap only. The item details (index, price and name)
+// are protected by a sequence lock: a writer makes the sequence odd while it changes them, and a reader
+// retries whenever the sequence was odd or changed while it read. Whenever the items are published again
+// the layout epoch goes up, so a stock count still tagged with the previous epoch is never changed
+// The menu file stays the lasting copy: each write of the file records its size and modification time here,
+// and a menu file that no longer matches has been changed by something else (a new item or an edit by hand)
+// A segment that can no longer be trusted (see abandonSharedCatalog) is marked unusable, and every kiosk then
+// works from the menu file alone
+struct SharedCatalogSegment {
+    char magic[8]; // Segment type marker, "NFSHM" followed by the format version
+    atomic<uint32_t> ready; // Set once the process that created the segment has filled it
+    atomic<uint32_t> unusable; // Set when no kiosk may use the segment any more
+    atomic<uint32_t> layoutEpoch; // Number of times the items have been published
+    atomic<uint64_t> sequence; // Sequence lock of the item details: odd while they are being written
+    atomic<int32_t> numOfItems; // Number of items (sequence-locked)
+    atomic<uint64_t> menuSize; // Size of the menu file when it was last written or published
+    atomic<int64_t> menuModified; // Modification time of the menu file then (in file clock ticks)
+    SharedCatalogItem items[SHARED_CATALOG_CAPACITY]; // The items, in the order of the menu file
+};
+static_assert(atomic<uint64_t>::is_always_lock_free && atomic<int64_t>::is_always_lock_free
+              && atomic<int32_t>::is_always_lock_free && atomic<uint32_t>::is_always_lock_free,
+              "The shared catalog needs lock-free atomics, as it is shared between processes");
+
+// Structure to hold this process's view of the shared catalog of the current branch
+struct SharedCatalog {
+    SharedCatalogSegment* segment = nullptr; // The mapped segment (nullptr when working from the menu file alone)
+    string name; // Name of the segment's shared memory object
+    int descriptor = -1; // The segment's shared memory object, locked (flock) while the menu file is written
+    mutex writer; // Lets one thread of this process at a time hold the file lock
+    mutex slotLock; // Protects the members below
+    uint32_t mappedEpoch = 0; // Layout epoch slotOfIndex was built for
+    unordered_map<int, int> slotOfIndex; // Slot of each item in the segment, by menu index
+};
+
+// Structure to hold a manager account, as read from the login credentials file
+struct ManagerAccount {
+    string password; // Password of the account
+    string role; // Role of the account: owner, supervisor or staff
+};
+
+// Structure to hold a logged in manager's session
+struct ManagerSession {
+    string username; // Manager the session belongs to
+    string role; // Role of the manager's account
+    uint32_t permissions = 0; // Permissions the role grants (PERMISSION_ bits)
+    time_t expiresAt = 0; // When the session ends if it is not used again
+};
+
+// Structure to hold the manager accounts (read from the credentials file once) and the open sessions,
+// so checking a login or a session is a single lookup instead of a scan of the credentials file
+struct SessionTable {
+    mutex lock; // Protects all of the members below
+    bool accountsLoaded = false; // Whether the accounts have been read from the credentials file
+    unordered_map<string, ManagerAccount> accounts; // Manager accounts, by username
+    unordered_map<string, ManagerSession> sessions; // Open sessions, by session token
+};
+
+// Structure to hold how fast a stocked item is being used up
+struct ConsumptionRate {
+    double perHour = 0; // Exponentially weighted quantity used per hour, as of updatedAt (recent orders count the most)
+    time_t updatedAt = 0; // Time the rate was last brought up to date
+};
+
+// Structure to hold the consumption rates of the stocked items of the current branch. The rates are
+// updated with each paid order, so forecasts never need to go through the order history again
+struct StockForecast {
+    mutex lock; // Protects all of the members below
+    bool loaded = false; // Whether the rates have been read from the forecast file
+    unordered_map<int, ConsumptionRate> rates; // Consumption rate of each stocked item, by menu index
+};
+
+// Stages of a kitchen ticket, in the order a ticket goes through them
+enum class TicketState : uint8_t { Queued, Cooking, Ready, Dispatched };
+
+// Structure to hold one kitchen ticket: the items of a paid order for the kitchen to prepare
+struct KitchenTicket {
+    int ticketNo = 0; // Number of the ticket, shown to the customer
+    string customerName; // Name of the customer
+    string deliveryArea; // Area the order is delivered to
+    vector<string> items; // Items to prepare, e.g. "2 x Burger (Large)"
+    int preparationTime = 0; // Total preparation time of the items (in minutes)
+    time_t queuedAt = 0; // When the ticket was sent to the kitchen
+    time_t readyAt = 0; // When the kitchen expects the ticket to be ready (set once cooking starts)
+    TicketState state = TicketState::Queued; // Current stage of the ticket
+};
+
+// Structure to hold the bounded queue of tickets between the ordering front ends (any number of
+// producers) and the kitchen (a single consumer). Tickets are kept in a fixed ring buffer; a front end
+// waits while the queue is full, so a busy kitchen slows down ordering instead of losing tickets
+struct TicketQueue {
+    mutex lock; // Protects all of the members below
+    condition_variable notEmpty; // Signalled when a ticket is added
+    condition_variable notFull; // Signalled when tickets are taken out
+    vector<KitchenTicket> slots = vector<KitchenTicket>(KITCHEN_QUEUE_CAPACITY); // The ring buffer
+    size_t head = 0; // Slot of the oldest ticket
+    size_t count = 0; // Number of tickets in the queue
+};
+
+// Structure to hold the tickets the kitchen has picked up (the kitchen display), as last read from the kitchen
+// tickets file that every kiosk process of the branch shares (see lockKitchenBoard)
+struct KitchenBoard {
+    mutex lock; // Protects all of the members below
+    vector<KitchenTicket> tickets; // Tickets being cooked or ready, oldest first
+    int lastTicketNo = 0; // Number of the last ticket issued
+};
+
+// Outcomes of a payment once it has been settled
+enum class PaymentState : uint8_t { Settled, Declined, Failed };
+
+// Structure to hold one payment of an order (an order split across several tenders has one payment for each)
+struct Payment {
+    string key; // Idempotency key: the kiosk, the order and the number of the payment within the order
+    int tender = 0; // Tender paid with (position in TENDERS)
+    string reference; // Account paid from (card number or e-wallet phone number; empty for cash)
+    Money amount; // Amount paid with the tender (after any change was given)
+    time_t paidAt = 0; // When the customer paid
+    bool awaited = false; // Whether the front end waits for the outcome before the order goes ahead (see takeSettlement)
+};
+
+// Structure to hold the payments waiting to be settled, between the ordering front ends and the settlement
+// threads. A front end only adds its payment and carries on, so a slow payment gateway never holds up ordering.
+// Each payment is taken once only: one with the same idempotency key as an earlier payment is turned away
+struct SettlementQueue {
+    mutex lock; // Protects all of the members below
+    condition_variable notEmpty; // Signalled when a payment is added
+    condition_variable drained; // Signalled when every payment added has been settled
+    deque<Payment> payments; // Payments waiting for a settlement thread, oldest first
+    unordered_set<string> keys; // Idempotency keys of every payment taken since the program started
+    int settling = 0; // Number of payments being settled right now
+    bool started = false; // Whether the settlement threads are running (payments are settled straight away otherwise)
+    int numOfPayments[3] = {}; // Number of payments settled, declined and failed so far (by PaymentState)
+    condition_variable settled; // Signalled when an awaited payment has been settled
+    unordered_map<string, PaymentState> outcomes; // Outcome of each awaited payment settled but not yet taken, by key
+};
+
+// Structure to hold the local stand-in for the card and e-wallet payment gateway. Each reply takes
+// NINJAFOOD_GATEWAY_LATENCY_MS milliseconds, and NINJAFOOD_GATEWAY_LOST_PERCENT percent of the replies are lost
+// on the way back (the charge is made, but the kiosk does not hear of it and asks again). Charges are kept by
+// idempotency key, so asking again with the same key gets the first reply and never charges twice
+struct PaymentGateway {
+    mutex lock; // Protects all of the members below
+    bool configured = false; // Whether the latency and lost replies have been read from the environment
+    int latencyMs = 0; // Time each reply takes (milliseconds)
+    int lostPercent = 0; // Share of replies lost on the way back
+    mt19937 generator{GATEWAY_SEED}; // Decides which replies are lost
+    unordered_map<string, PaymentState> charges; // Outcome of every charge made, by idempotency key
+    int64_t chargedCents = 0; // Total of the charges that went through
+    int numOfLostReplies = 0; // Number of replies lost
+};
+
+// Structure to hold a file write waiting to be done by the persistence thread
+struct PendingWrite {
+    string path; // File to write to
+    string data; // Text to write
+    bool replace = false; // Whether the text replaces the whole file (otherwise it is added to the end)
+    bool events = false; // Whether the data is event records, numbered as they are added (see appendEvents)
+    bool sharedStock = false; // Whether the live stock of the shared catalog is written to the menu file (see saveSharedStock)
+};
+
+// Kinds of event in the event stream of a branch
+enum EventType : uint16_t {
+    EVENT_PRICE_CHANGED = 1, // The price of an item was updated: value is the new price in cents
+    EVENT_STOCK_CHANGED = 2, // Paid orders used stock of an item: quantity is the stock used, value the stock left
+    EVENT_ITEM_ADDED = 3, // An item was added to the menu: quantity is its stock, value its price in cents
+    EVENT_ORDER_ACCEPTED = 4, // An order line was added to a cart: quantity is the quantity, value the unit price in cents
+    EVENT_PAYMENT_COMPLETED = 5, // A cart was paid for: quantity is its number of lines, value the amount paid in cents
+    EVENT_ORDER_CANCELLED = 6 // An order was cancelled after (part of) it was paid: value is the amount to refund in cents
+};
+
+// Structure to hold one event of the event stream (events.log) of a branch
+// The stream is an append-only file of these fixed-size records, in the kiosks' own byte order, so a subscriber
+// that has seen up to sequence number n finds the next event at byte n * sizeof(EventRecord) and only ever
+// reads what is new. Every kiosk process of the branch adds to the same stream (see appendEvents)
+struct EventRecord {
+    uint64_t sequence = 0; // Number of the event in the stream (the first is 1), given when it is written
+    int64_t time = 0; // When the event happened (Unix time)
+    int64_t value = 0; // Amount in cents or stock count, depending on the type
+    uint32_t kiosk = 0; // Process ID of the kiosk the event came from
+    uint32_t orderId = 0; // Cart the event belongs to, within that kiosk (0 for menu and stock events)
+    int32_t menuIndex = 0; // Item the event is about (0 for payment events)
+    int32_t quantity = 0; // Quantity, depending on the type
+    uint16_t type = 0; // Kind of event (EventType)
+    uint16_t reserved[3] = {}; // Always 0 (keeps the records 8-byte aligned)
+};
+static_assert(sizeof(EventRecord) == 48, "Event records are 48 bytes: subscribers find events by their position in the stream");
+
+// Structure to hold the file writes of the order path, which the persistence thread does in the background
+// so a paying customer does not wait for the disk. There is at most one pending write per file: text added
+// to a file that already has a write waiting joins that write, and a new version of a file drops the old one.
+// A queued write only exists in memory until the thread has done it, so it is lost if the program crashes first
+struct PersistenceQueue {
+    mutex lock; // Protects all of the members below
+    condition_variable notEmpty; // Signalled when a write is queued
+    condition_variable drained; // Signalled when every queued write has reached its file
+    vector<PendingWrite> writes; // Writes waiting for the persistence thread
+    bool writing = false; // Whether the persistence thread is doing a batch of writes
+    bool started = false; // Whether the persistence thread is running (files are written straight away otherwise)
+    int flushing = 0; // Number of threads waiting in flushWrites (the batch is then written without waiting for more)
+};
+
+// Structure to hold the menu of one branch, kept in memory while the branch is in use
+// A loaded menu is never changed; when the menu file changes a new one is loaded in its place
+struct BranchCatalog {
+    string branchId; // Branch the menu belongs to
+    int totalNumItems = 0; // Number of items on the menu
+    string** arrMenuContent = nullptr; // Menu details, as returned by readMenu
+    MenuModel model; // Categories, modifiers and combos of the menu
+    MenuSearchIndex searchIndex; // Item name search index of the menu
+    filesystem::file_time_type menuModified; // Modification time of the menu file when it was loaded
+    uintmax_t menuSize = 0; // Size of the menu file when it was loaded
+    PromotionPlan promotions; // Promotion rules of the branch, compiled against the menu
+    filesystem::file_time_type promotionsModified; // Modification time of the promotions file when it was loaded
+    uintmax_t promotionsSize = 0; // Size of the promotions file when it was loaded
+    string* menuCells = nullptr; // Menu details of every item in one block, when loaded from the catalog cache
+    uint32_t sharedEpoch = 0; // Layout epoch of the shared catalog the menu matched when loaded (0 if none)
+    shared_ptr<const PriceSnapshot> prices; // Item prices of the menu, as one version (see PriceSnapshot)
+    MappedFile cacheFile; // The catalog cache, kept mapped while the search index uses it (when loaded from it)
+
+    // Release the dynamically allocated menu details when the last user of the menu is done with it
+    ~BranchCatalog() {
+        if (menuCells != nullptr)
+            delete[] menuCells; // Loaded from the cache: the rows point into one block
+        else {
+            for (int i = 0; i < totalNumItems; i++)
+                delete[] arrMenuContent[i];
+        }
+        delete[] arrMenuContent;
+#ifndef _WIN32
+        if (cacheFile.mapped)
+            munmap((void*)cacheFile.data, cacheFile.size);
+#endif
+    }
+};
+
+// Structure to hold the key statistics of one branch
+struct BranchStats {
+    string branchId; // Branch the statistics belong to
+    int totalNumItems = 0; // Number of items on the branch's menu
+    int numOfDishOrders = 0; // Number of accepted order lines (entries in the top dish file)
+    int topDishIndex = 0; // The index of the most popular dish
+    int maxQuantity = 0; // Quantity ordered of the most popular dish
+    string topDishName; // Name of the most popular dish
+    Money topDishPrice; // Price of the most popular dish
+    int totalOrders = 0; // Number of paid orders
+    Money totalSales; // Total sales value
+    int numOfCustomers = 0; // Number of customers served
+    int numOfProfiles = 0; // Number of customers with a profile
+    int numOfRepeatCustomers = 0; // Number of customers who ordered more than once
+    Money lifetimeSpend; // Total spent by all profiled customers
+    string topCustomerName; // Customer who has spent the most
+    Money topCustomerSpend; // Amount spent by that customer
+    int topCustomerVisits = 0; // Number of orders of that customer
+    int topCustomerFavourite = 0; // Menu index of that customer's favourite item
+};
+
+// Structure to hold how far the stats snapshot has folded one log. The log is told apart from a file put in
+// its place by its file number (inode), so the compaction job can start a log again once it is folded
+struct LogPosition {
+    uint64_t file = 0; // File number of the log the offset is in (0 if not known)
+    uint64_t offset = 0; // Bytes of that log folded into the snapshot
+    uint64_t nextFile = 0; // File number of the empty log that takes its place when it is started again (0 if none)
+};
+
+// Structure to hold the top dish and total sales logs of a branch folded up to a point: the stats only
+// need these totals, so readers start from the snapshot and read just the log lines added since
+// (the customers are counted by the customer profiles, which hold one record per customer)
+// Snapshot structure (stats_snapshot.txt), one value per line after its name:
+//      topdish offset numOfDishOrders file nextFile
+//      sales offset totalOrders totalSalesCents numOfCustomers file nextFile
+//      dish menuIndex quantity (one line per dish, in the order the dishes were first ordered)
+struct StatsSnapshot {
+    LogPosition topdish; // How far the top dish file is folded into the snapshot
+    int numOfDishOrders = 0; // Number of order lines folded
+    vector<int> dishOrder; // Dish indices, in the order they were first ordered
+    unordered_map<int, int> dishQuantity; // Total quantity ordered of each dish
+    LogPosition sales; // How far the total sales file is folded into the snapshot
+    int totalOrders = 0; // Number of sales records folded
+    Money totalSales; // Total of the sales records folded
+    int numOfCustomers = 0; // Number of valid sales records folded
+};
+
+// Structure to hold the revenue totals of a sales report (all amounts in cents)
+// Each worker thread fills its own report from part of the order lines, and the reports are then merged
+struct SalesReport {
+    int numOfOrderLines = 0; // Number of order lines included in the report
+    int64_t totalRevenue = 0; // Revenue of all included order lines
+    vector<int64_t> itemRevenue; // Revenue of each menu item (by menu index)
+    vector<int64_t> itemQuantity; // Quantity sold of each menu item (by menu index)
+    unordered_map<int, string> itemNames; // Name of each menu item (by menu index)
+    int64_t hourRevenue[24] = {}; // Revenue by hour of the day the order was paid
+    int64_t areaRevenue[NUM_OF_DELIVERY_AREAS + 1] = {}; // Revenue by delivery area (from 1; 0 is unused)
+    int64_t newcomerRevenue = 0; // Revenue from first-time customers
+    int64_t returningRevenue = 0; // Revenue from returning customers
+};
+
+// Structure to hold the order history in columns: one contiguous array per field, so analytics
+// scan only the fields they need. Item names are stored once in a dictionary and referred to by
+// number, and payment times are stored as the difference from the previous order line
+struct OrderColumns {
+    int64_t baseTimestamp = 0; // Payment time the first difference is counted from
+    uint64_t sourceSize = 0; // Bytes of the order history text file already converted
+    vector<string> names; // Dictionary of item names
+    vector<int32_t> timestampDeltas; // Payment time minus the previous line's payment time (seconds)
+    vector<int32_t> menuIndices; // Menu index of each order line
+    vector<uint32_t> nameIds; // Item name of each order line (index into names)
+    vector<int32_t> quantities; // Quantity of each order line
+    vector<int64_t> revenueCents; // Revenue of each order line, in cents
+    vector<uint8_t> areas; // Delivery area (from 1) of each order line
+    vector<uint8_t> newcomers; // 1 if the order line was paid by a first-time customer
+};
+
+// Branch (outlet) whose data files are used; empty for the main branch, whose files stay in the working directory
+string currentBranchId;
+bool branchSelected = false; // Whether the branch has been chosen for this run of the program
+
+// Recently used branch menus, most recently used first, and the mutex protecting them
+list<shared_ptr<BranchCatalog>> branchCatalogCache;
+mutex branchCatalogMutex;
+
+// Latest menu of the current branch, read and replaced only with atomic_load and atomic_store, so finding
+// the current menu never waits for the mutex above (e.g. while another branch's menu is being loaded)
+shared_ptr<BranchCatalog> publishedCatalog;
+
+// Version of the latest price snapshot made (protected by branchCatalogMutex)
+uint64_t latestPriceVersion = 0;
+
+// Shared catalog (live stock and prices) of the current branch, when the kiosk processes share one
+SharedCatalog sharedCatalog;
+
+// Customer profiles of the current branch (loaded the first time a customer pays)
+CustomerProfileStore customerProfiles;
+
+// Stock reserved by unpaid carts of the current branch
+ReservationTable stockReservations;
+
+// Consumption rates of the stocked items of the current branch (loaded the first time they are needed)
+StockForecast stockForecast;
+
+// The input layer all prompts read from
+InputReader input;
+
+// Manager accounts and open sessions, and the session of the manager using this terminal (empty if none)
+SessionTable managerSessions;
+string currentSessionToken;
+
+// Queue of tickets waiting for the kitchen, and the tickets the kitchen is working on
+TicketQueue kitchenQueue;
+KitchenBoard kitchenBoard;
+
+// File writes waiting for the persistence thread
+PersistenceQueue persistence;
+
+// Payments waiting to be settled, and the payment gateway they are settled with
+SettlementQueue settlements;
+PaymentGateway paymentGateway;
+
+// Background threads (the kitchen, the stats compaction, the persistence of orders and the settlement of payments), and what they wait on between runs.
+// They are stopped and joined when the program exits, before the data they use is destroyed
+vector<thread> backgroundThreads;
+atomic<bool> backgroundStopping(false); // Set when the program is exiting
+mutex backgroundLock; // Used with backgroundWake
+condition_variable backgroundWake; // Signalled when the program is exiting
+
+// Function prototypes for various operations in the program
+char getUserType(); // Function to determine whether the user is a manager or a customer
+void signup(UserDetails& ud); // Function to allow manager to sign up
+void login(UserDetails& ud); // Function to allow manager to log in
+void getManagerAction(); // Function for manager to choose actions to perform
+void getCustomerAction(UserDetails& ud); // Function for customer to choose their actions
+//void trackManagerActions(int arrManagerChoices[]); // Tracks manager actions (currently not used)
+void continueProgram(); // Asks user if they want to continue using the program
+int logout(); // Allows the user to log out from the system
+void selectBranch(); // Asks which branch (outlet) the program is being used for
+string branchPath(string branchId, string fileName); // Returns the path of a data file of the given branch
+string dataPath(string fileName); // Returns the path of a data file of the current branch
+vector<string> readBranchIds(); // Returns the IDs of all registered branches
+shared_ptr<BranchCatalog> loadBranchCatalog(string branchId); // Returns the menu of a branch, loading it if needed
+shared_ptr<const PriceSnapshot> buildPriceSnapshot(string** arrMenuContent, int totalNumItems, const shared_ptr<const PriceSnapshot>& previous); // Makes a version of a menu's prices
+bool snapshotPrice(const PriceSnapshot& prices, int menuIndex, Money& price); // Looks up the price of an item in a version of the prices
+
+// Internal functions for the binary catalog cache, not directly invoked by the user
+bool loadCatalogCache(string path, BranchCatalog& catalog, CatalogCacheHeader& header, vector<int32_t>& lineItems, bool& refreshHeader); // Loads a catalog from its cache if it is current
+void saveCatalogCache(string path, const BranchCatalog& catalog, const CatalogCacheHeader& header, const vector<int32_t>& lineItems); // Writes the cache of a catalog
+bool scanMenuStock(string path, uint64_t& layoutHash, const int32_t* lineItems, size_t numOfLines, string* menuCells); // Hashes a menu file's layout and reads its stock column
+uint64_t hashFile(string path); // Returns the content hash of a file (FNV-1a; 0 if the file cannot be read)
+bool mapFile(string path, MappedFile& file); // Maps a whole file into memory for reading
+void unmapFile(MappedFile& file); // Releases a mapped file
+template <typename T> void appendCacheArray(string& out, const vector<T>& values); // Adds an array to a cache being written
+void appendCacheStrings(string& out, const vector<string>& values); // Adds a list of strings to a cache being written
+template <typename T> const T* viewCacheArray(CacheReader& reader, size_t& count); // Finds an array in the cache without copying it
+template <typename T> void readCacheArray(CacheReader& reader, vector<T>& values); // Reads an array from the cache
+bool viewCacheStrings(CacheReader& reader, const uint32_t*& ends, size_t& count, const char*& characters); // Finds a list of strings in the cache
+void readCacheStrings(CacheReader& reader, vector<string>& values); // Reads a list of strings from the cache
+void readCacheStrings(CacheReader& reader, string* values, size_t count); // Reads a list of a known number of strings from the cache
+
+// Internal functions for the shared catalog, not directly invoked by the user
+void startSharedCatalog(); // Maps the shared catalog of the current branch, setting it up if no kiosk has yet
+void stopSharedCatalog(); // Stops using the shared catalog (the kiosk then works from the menu file alone)
+bool useSharedCatalog(); // Checks whether the kiosk uses a shared catalog, letting go of one marked unusable
+void abandonSharedCatalog(); // Marks the shared catalog unusable for every kiosk
+bool lockSharedCatalog(); // Takes the file lock of the shared catalog; returns false if there is no shared catalog
+void unlockSharedCatalog(); // Releases the file lock of the shared catalog
+void syncSharedCatalog(bool force); // Publishes the menu file to the shared catalog if it was changed elsewhere (or always)
+bool publishSharedCatalog(string** arrMenuContent, int totalNumItems); // Publishes the items of the menu to the shared catalog
+void stampSharedCatalog(); // Records the size and modification time of the menu file in the shared catalog
+bool sharedCatalogMatches(filesystem::file_time_type menuModified, uintmax_t menuSize); // Checks the menu file is the one last recorded
+bool sharedCatalogCurrent(); // Checks the menu file as it is now is the one last recorded
+bool saveSharedStock(); // Writes the live stock to the menu file; returns false if it could not be written
+bool sharedStockSaved(); // Checks the menu file already holds the live stock (the caller holds the file lock)
+int findSharedSlot(int menuIndex, uint32_t& epoch); // Finds the slot of an item in the shared catalog (-1 if it is not there)
+bool readSharedItem(int menuIndex, Money& price, string& name); // Reads the live price and name of an item
+int takeSharedStock(const unordered_map<int, int>& needs, const unordered_map<int, int>& reservedStock); // Deducts an order's stock from the live counts
+int itemStock(string** arrMenuContent, int row); // Returns the stock of a stocked item (live, when it is in the shared catalog)
+
+// Manager-specific operations
+void createOrUpdateMenu(); // Manager can create or modify the restaurant menu
+void updatePrices(); // Manager can adjust the price of menu items
+void viewStats(); // Manager can view restaurant stats like popular dishes and sales
+void managerHelpInfo(); // Provides help or instructions for the manager on using the system
+void viewGroupStats(); // Manager can view the stats of every branch side by side
+void viewSalesReport(); // Manager can generate an end-of-day or end-of-month sales report
+void viewKitchenDisplay(); // Manager can view the kitchen tickets and mark ready orders as dispatched
+void viewStockForecast(); // Manager can view how fast items are used up and how much to restock
+BranchStats computeBranchStats(string branchId); // Calculates the key statistics of one branch
+
+// Internal functions for the stats snapshots, not directly invoked by the user
+bool loadStatsSnapshot(string path, StatsSnapshot& snapshot); // Reads the stats snapshot of a branch
+bool saveStatsSnapshot(string path, const StatsSnapshot& snapshot); // Writes the stats snapshot of a branch
+int lockStatsSnapshot(string branchId, bool exclusive); // Takes the lock of a branch's stats snapshot and logs
+void unlockStatsSnapshot(int descriptor); // Releases the lock of a stats snapshot
+bool foldStatsLogs(string branchId, StatsSnapshot& snapshot); // Adds the log lines written since the snapshot was taken
+string readLogTail(string path, LogPosition& position); // Reads the complete lines added to a log file since the given position
+uint64_t logFileNumber(string path); // Finds the file number (inode) of a log
+bool rotateStatsLog(string branchId, string logName, StatsSnapshot& snapshot); // Starts a folded stats log again
+void compactBranchStats(string branchId); // Brings the stats snapshot of a branch up to date
+void startCompaction(); // Starts the background job that keeps the stats snapshots up to date
+void runCompaction(); // Background job: folds the stats logs of every branch into their snapshots
+void startBackgroundThread(void (*job)()); // Starts a background thread, to be stopped when the program exits
+void stopBackgroundThreads(); // Stops the background threads and waits for them to finish
+
+// Internal functions for manager actions, not directly invoked by manager
+Money calcTotalPaymentsPerOrder(const vector<CartLine>& cartLines); // Calculates the total payment for a given order
+int calcEstDeliveryTime(const vector<ReceiptLine>& cart, string& deliveryArea, int& totalPrepTime); // Estimates delivery time based on location and prep time
+int displayMenu(); // Displays the menu to the user (manager or customer)
+void displayMenuHeader(int totalNumItems); // Displays the heading of the menu table
+void displayMenuRow(string** arrMenuContent, const MenuModel& model, int row); // Displays a single item of the menu table
+void displayMenuPage(string** arrMenuContent, const MenuModel& model, const vector<int>& rows, int page); // Displays one page of the given menu rows
+void buildMenuSearchIndex(string** arrMenuContent, int totalNumItems, MenuSearchIndex& searchIndex); // Builds the item name search index
+vector<int> searchMenu(const MenuSearchIndex& searchIndex, string query); // Finds the menu rows whose item name matches the query
+int browseMenu(string** arrMenuContent, int totalNumItems, const MenuModel& model, const MenuSearchIndex& searchIndex, string prompt); // Lets the user page/search the menu and pick an item
+bool itemAlreadyExists(string itemName); // Checks if the item already exists in the menu when updating
+int acceptOrder(int**, int x, int orderId, const PriceSnapshot& prices); // Accepts or rejects an order based on item availability
+string** readMenu(int&); // Reads the current menu and returns it in a dynamic 2D array
+string** readMenuFile(string path, int& totalNumItems); // Reads the given menu file and returns it in a dynamic 2D array
+string** readMenuFileLines(string path, int& totalNumItems, vector<int32_t>& lineItems); // Reads a menu file, noting the menu row of each line
+bool parseMenuLine(string line, string* fields); // Splits one line of the menu file into the details of an item
+string formatMenuLine(const string* fields); // Joins the details of an item into one line of the menu file
+bool writeMenu(string** arrMenuContent, int totalNumItems); // Writes the whole menu back to the menu file; returns false if it could not be written
+bool writeMenuFile(string** arrMenuContent, int totalNumItems, bool liveStock); // Writes a menu to the menu file (the caller holds any lock)
+int lockMenuFile(); // Takes the file lock of the menu file, when there is no shared catalog to lock it
+void unlockMenuFile(int descriptor); // Releases the file lock of the menu file
+int findMenuRow(string** arrMenuContent, int totalNumItems, int menuIndex); // Finds the row of a menu item from its index number
+void buildMenuModel(string** arrMenuContent, int totalNumItems, MenuModel& model); // Builds the categories, modifiers and combos of the menu
+bool parseModifiers(string text, vector<MenuModifier>& modifiers); // Parses the option modifiers column of a menu item
+bool parseComboComponents(string text, string** arrMenuContent, int totalNumItems, vector<ComboComponent>& components); // Parses the combo components column of a menu item
+int availableStock(string** arrMenuContent, const MenuModel& model, int row); // Returns the stock available for a menu item
+Money orderLinePrice(const PriceSnapshot& prices, string** arrMenuContent, const MenuModel& model, int row, int modifierMask); // Returns the unit price of an item with its chosen options
+vector<CartLine> priceReceiptLines(const vector<ReceiptLine>& cart, const PriceSnapshot& prices, const BranchCatalog& catalog); // Prices a customer's cart at the prices it is pinned to
+string orderLineName(string** arrMenuContent, const MenuModel& model, int row, int modifierMask); // Returns the name of an item with its chosen options
+
+// Customer-specific operations
+void orderOnline(UserDetails& ud); // Allows customer to place an online food order
+void makePayments(UserDetails& ud); // Allows customer to make a payment for the order
+int chooseModifiers(string** arrMenuContent, const MenuModel& model, int row); // Lets the customer choose the options of an item
+
+// Internal functions for customer actions, not directly invoked by customer
+int countPreviousOrders(UserDetails& ud); // Collects the customer's details and returns how many orders they made before
+string deliveryAreaName(char deliveryAreaNum); // Returns the name of a delivery area from its number
+void recordOrderHistory(time_t paidAt, char deliveryAreaNum, bool newcomer, const vector<int>& menuIndices, const vector<string>& itemNames, const vector<int>& quantities, const vector<Money>& lineRevenue); // Appends a paid order to the order history
+
+// Internal functions for stock reservations, not directly invoked by the user
+int createReservation(); // Starts a reservation for a new cart and returns its order ID
+bool reserveStock(int orderId, string** arrMenuContent, const MenuModel& model, int row, int quantity); // Reserves stock for an order line
+void releaseReservation(int orderId); // Gives the stock reserved by a cart back
+void dropReservation(ReservationTable& table, int orderId); // Removes a cart's reservation (the caller holds the table's lock)
+int commitOrderStock(int orderId, const vector<int>& menuIndices, const vector<int>& quantities); // Deducts the stock of a paid order
+int reservedQuantity(int menuIndex); // Returns the quantity of an item reserved by unpaid carts
+void advanceReservations(ReservationTable& table, time_t now); // Releases the reservations that have expired
+void addStockNeeds(const MenuModel& model, int row, int quantity, unordered_map<int, int>& needs); // Adds up the stock an order line uses
+
+// Internal functions for manager sessions, not directly invoked by the user
+void loadManagerAccounts(SessionTable& table); // Reads the manager accounts from the credentials file (the caller holds the table's lock)
+bool verifyManager(string username, string password); // Checks a username and password against the manager accounts
+bool managerAccountExists(string username); // Checks whether a manager account already uses the given username
+int countManagerAccounts(); // Returns the number of manager accounts
+string addManagerAccount(string username, string password); // Adds a new manager account and returns its role
+uint32_t rolePermissions(string role); // Returns the permissions a role grants
+string startSession(string username); // Opens a session for a manager and returns its token
+bool checkSession(string token, ManagerSession& session); // Finds an open session, keeping it open for longer
+void endSession(string token); // Closes a session
+bool requirePermission(uint32_t permission, string action); // Checks the current manager may perform an action, telling them if not
+
+// Internal functions for stock forecasting, not directly invoked by the user
+void loadStockForecast(StockForecast& forecast); // Reads the consumption rates, working them out from the order history the first time
+void saveStockForecast(const StockForecast& forecast); // Writes the consumption rates to the forecast file
+void addConsumption(ConsumptionRate& rate, int quantity, time_t usedAt); // Adds a quantity used at the given time to a consumption rate
+double currentRate(const ConsumptionRate& rate, time_t now); // Returns a consumption rate as of the given time
+void recordStockConsumption(const unordered_map<int, int>& usedStock, time_t usedAt); // Updates the rates with the stock used by a paid order
+void showLowStockAlerts(); // Warns the manager about items that will run out before new stock can arrive
+
+// Internal functions for the kitchen, not directly invoked by the user
+void startKitchen(); // Starts the kitchen thread that works through the ticket queue
+void runKitchen(); // Kitchen thread: picks up tickets, cooks them and marks them ready
+bool pushKitchenTicket(TicketQueue& queue, const KitchenTicket& ticket, chrono::milliseconds wait); // Adds a ticket, waiting while the queue is full
+size_t popKitchenTickets(TicketQueue& queue, vector<KitchenTicket>& batch, chrono::milliseconds wait); // Takes a batch of tickets from the queue
+void submitKitchenTicket(UserDetails& ud, string deliveryArea, const vector<string>& items, int preparationTime); // Sends a paid order to the kitchen
+void loadKitchenBoard(KitchenBoard& board); // Reads the unfinished tickets of the current branch
+void saveKitchenBoard(const KitchenBoard& board); // Writes the tickets of the kitchen display
+int lockKitchenBoard(KitchenBoard& board); // Takes the file lock of the kitchen tickets and reads them again
+void unlockKitchenBoard(int descriptor); // Releases the file lock of the kitchen tickets
+string escapeTicketField(const string& text); // Marks the delimiters in a field of the kitchen tickets file
+vector<string> splitTicketLine(const string& line, size_t numOfFields); // Splits a line of the kitchen tickets file
+string ticketStateName(TicketState state); // Returns the name of a ticket stage
+
+// Internal functions for writing the files of the order path in the background, not directly invoked by the user
+void startPersistence(); // Starts the persistence thread
+void runPersistence(); // Persistence thread: writes the queued files in batches
+void queueAppend(string path, string data); // Queues text to be added to the end of a file
+void queueReplace(string path, string data); // Queues a new version of a whole file
+void queueSharedStock(); // Queues a write of the live stock of the shared catalog to the menu file
+void flushWrites(); // Waits until every queued write has reached its file
+void writeFile(const PendingWrite& write); // Does one file write
+bool replaceFile(string path, const string& data); // Writes a new version of a whole file and renames it into place
+bool appendFile(string path, const string& data); // Adds text to the end of a file, following a log started again
+
+// Internal functions for the event stream, not directly invoked by the user
+void addEvent(vector<EventRecord>& events, EventType type, int orderId, int menuIndex, int quantity, int64_t value); // Adds an event to a batch
+void queueEvents(const vector<EventRecord>& events); // Queues a batch of events to be added to the event stream
+bool appendEvents(string path, string data); // Adds event records to the end of an event stream, numbering them
+size_t readEvents(string path, uint64_t afterSequence, vector<EventRecord>& events); // Reads the events after a sequence number
+void followEvents(uint64_t afterSequence); // Prints the events of a branch as they are added
+string describeEvent(const EventRecord& event); // Describes an event in one line of text
+
+// Internal functions for payments, not directly invoked by the user
+bool takePayments(int orderId, Money amountDue, Money& amountPaid); // Takes the payment of an order, with one tender or several
+bool validTenderReference(TenderReference reference, const string& text); // Checks the account a customer pays from
+string paymentKey(int orderId, int paymentNo); // Returns the idempotency key of a payment of an order
+bool submitPayment(const Payment& payment); // Hands a payment over to be settled (once only)
+void startSettlement(); // Starts the settlement threads
+void runSettlement(); // Settlement thread: settles the payments as they come
+void flushSettlements(); // Waits until every payment handed over has been settled
+bool takeSettlement(const string& key, PaymentState& state, bool wait); // Takes the outcome of an awaited payment
+PaymentState settlePayment(const Payment& payment); // Settles one payment, through the gateway if its tender needs it
+bool gatewayCharge(const Payment& payment, PaymentState& outcome); // Sends a charge to the payment gateway; false if the reply was lost
+int gatewayLatencyMs(); // Returns the time each reply of the payment gateway takes
+void recordPayment(const Payment& payment, PaymentState state); // Adds a settled payment to the payment ledger
+string paymentStateName(PaymentState state); // Returns the name of a payment outcome
+
+// Internal functions for customer profiles, not directly invoked by the user
+uint64_t customerPhoneKey(string phoneNumber); // Packs a phone number into a number
+void loadCustomerProfiles(CustomerProfileStore& store); // Reads the customer profiles of the current branch
+void lockCustomerProfiles(CustomerProfileStore& store); // Takes the file lock of the customer profiles
+void unlockCustomerProfiles(CustomerProfileStore& store); // Releases the file lock of the customer profiles
+int refreshCustomerProfile(CustomerProfileStore& store, uint64_t phoneKey); // Reads new profiles and a customer's profile again from the profile file
+uint32_t customerVisitCount(string phoneNumber); // Returns the number of paid orders of a customer
+bool readCustomerProfiles(string path, vector<CustomerProfile>& profiles); // Reads every record of a profile file
+void writeCustomerProfile(CustomerProfileStore& store, uint32_t position); // Writes one profile back to the profile file
+string readCustomerName(string path, const CustomerProfile& profile); // Reads a customer's name from a name heap file
+void recordCustomerOrder(UserDetails& ud, time_t paidAt, Money amountPaid, const vector<int>& menuIndices, const vector<int>& quantities); // Updates a customer's profile after payment
+
+// Internal functions for promotions, not directly invoked by the user
+void compilePromotions(string path, string** arrMenuContent, int totalNumItems, const MenuModel& model, PromotionPlan& plan); // Compiles a promotions file into a plan
+bool parseTimeOfDay(string text, int& minutes); // Parses a time such as "14:30" into minutes after midnight
+PricedCart priceCart(const PromotionPlan& plan, const MenuModel& model, const vector<CartLine>& lines, int previousOrders, time_t now); // Applies the promotions to a cart
+
+// Internal functions for the input layer, used by every prompt
+bool readInputLine(InputReader& reader, string& line); // Reads the next line of input; returns false at the end of input
+string readLine(); // Reads the next line typed by the user (ends the program at the end of input)
+string readToken(); // Reads the next non-blank line typed by the user, without surrounding spaces
+char readChoice(); // Reads a one-character choice (returns '\0' if more or less than one character was typed)
+bool parseInt(const string& text, int& value); // Parses a whole number; returns false if the text is not one
+bool readInt(int& value); // Reads a whole number typed by the user; returns false if it is not one
+char promptChoice(string prompt, string choices); // Shows a prompt until one of the given choices is typed
+
+// Internal functions for money amounts
+bool parseMoney(string text, Money& amount); // Parses an amount such as "12.50"; returns false if it is not a valid amount
+Money percentOf(Money amount, int percent); // Returns a percentage of an amount, rounded to the nearest cent
+ostream& operator<<(ostream& out, Money amount); // Writes an amount with two decimals
+Money abs(Money amount); // Returns an amount without its sign
+string formatCents(int64_t cents); // Formats an amount in cents as dollars and cents, e.g. "12.50"
+int64_t parseCents(const char* text, char** end); // Parses an amount such as "12.50" into cents without rounding errors
+
+// Internal functions for reports, not directly invoked by the user
+SalesReport buildSalesReport(const OrderColumns& columns, time_t periodStart, time_t periodEnd); // Aggregates the order lines in parallel
+void mergeSalesReport(SalesReport& into, const SalesReport& from); // Adds the totals of one report to another
+
+// Internal functions for the columnar order snapshot, not directly invoked by the user
+bool loadOrderSnapshot(string path, OrderColumns& columns); // Loads the columnar snapshot of the order history
+void saveOrderSnapshot(string path, const OrderColumns& columns); // Saves the columnar snapshot of the order history
+void refreshOrderSnapshot(OrderColumns& columns); // Adds the order lines paid since the snapshot was saved
+void parseOrderHistoryChunk(const string& chunk, OrderColumns& columns, int64_t& lastTimestamp); // Converts order history text into columns
+void decodeTimestamps(const int32_t* deltas, size_t numOfRows, int64_t baseTimestamp, int64_t* timestamps); // Turns timestamp differences back into times
+void buildPeriodMask(const int64_t* timestamps, size_t numOfRows, int64_t periodStart, int64_t periodEnd, uint8_t* mask); // Marks the rows within a period
+int64_t sumMasked(const int64_t* values, const uint8_t* mask, size_t numOfRows); // Adds up the values of the marked rows
+template <typename Key> void groupSumMasked(const Key* keys, const int64_t* values, const uint8_t* mask, size_t numOfRows, int64_t* sums); // Adds up the marked values per key
+
+// Internal functions for the simulated day of orders, not directly invoked by the user
+void runSimulation(int numOfOrders); // Runs a synthetic day of orders through the order and payment path and reports on it
+void simulateOrder(UserDetails& ud, time_t placedAt, char deliveryAreaNum, const vector<SimulatedLine>& lines, deque<SimulatedOrder>& unsettled, SimulationStats& stats); // Places and pays for one simulated order
+void finishSimulatedOrders(deque<SimulatedOrder>& unsettled, bool wait, SimulationStats& stats); // Finishes the simulated orders whose payment has been settled
+uintmax_t simulationFileSize(string fileName); // Returns the size of a data file of the simulation branch (0 if missing)
+
+// Function to run the program: the main page, from which managers and customers carry on to their pages
+// (called by main, and again whenever a user is redirected back to the main page)
+int runProgram() {
+    UserDetails ud; // Declare a variable to store user details (manager or customer)
+
+    // The NINJAFOOD_SIMULATE environment variable runs a simulated day of that many orders instead (for load tests)
+    const char* simulatedOrders = getenv("NINJAFOOD_SIMULATE");
+    if (simulatedOrders != nullptr && !branchSelected) {
+        runSimulation(atoi(simulatedOrders));
+        return 0;
+    }
+
+    // The NINJAFOOD_EVENTS environment variable prints the event stream after that sequence number instead, and
+    // keeps printing new events as they come (for dashboards and kitchen screens)
+    const char* followedEvents = getenv("NINJAFOOD_EVENTS");
+    if (followedEvents != nullptr && !branchSelected) {
+        followEvents(strtoull(followedEvents, nullptr, 10));
+        return 0;
+    }
+
+    // Display a welcome message to the user
+    cout << "===================================================================\n";
+    cout << "====================== Welcome to NinjaFood! ======================\n";
+    cout << "===================================================================\n\n";
+		 
+    char choice = 'Y'; // Variable to store user's choice to continue or exit the program
+
+    cout << "\n=> Would you like to start using this program? [Y/N] "; // Prompt user to start
+    choice = readChoice();
+
+    // INPUT VALIDATION: Ensure user input is either 'Y', 'y', 'N', or 'n'
+    while (choice != 'Y' && choice != 'y' && choice != 'N' && choice != 'n')
+    {
+        cout << "\n/// Invalid selection. Please try again!";
+        cout << "\n=> Do you wish to continue using this program? [Y/N] "; // Re-prompt if invalid input
+        choice = readChoice();
+    }
+
+    if (choice == 'Y' || choice == 'y') // If user chooses to continue
+    {
+        // Ask which branch the program is used for, and start its kitchen, the stats compaction, the
+        // persistence thread, the settlement of payments and its shared catalog (only once per run)
+        if (!branchSelected) {
+            selectBranch();
+            startKitchen();
+            startCompaction();
+            startPersistence();
+            startSettlement();
+            startSharedCatalog();
+        }
+
+        // Ask user whether they are a manager or customer
+        char userTypeChoice = getUserType();
+
+        // If the user is a restaurant manager
+        if (userTypeChoice == 'M' || userTypeChoice == 'm')
+        {
+            // Let the manager carry on with a session still open (its token is checked, so no password is asked
+            // for until the session has gone unused for SESSION_IDLE_SECONDS), or else log in
+            ManagerSession session;
+            if (checkSession(currentSessionToken, session)) {
+                char resume = 'Y'; // Whether the manager carries on with the open session
+                cout << "\n=> Continue as " << session.username << " (" << session.role << ")? [Y/N] ";
+                resume = readChoice();
+                if (resume == 'Y' || resume == 'y') {
+                    ud.username = session.username;
+                    cout << "\n/// Welcome back, " << session.username << " (" << session.role << ").\n";
+                } else {
+                    endSession(currentSessionToken);
+                    currentSessionToken.clear();
+                    login(ud);
+                }
+            }
+            else
+                login(ud);
+            // Warn the manager about items that are running out
+            showLowStockAlerts();
+            // Provide manager with options for tasks to perform
+            getManagerAction();
+        }
+        else
+        {
+            // A customer now has the kiosk, so a manager session left open must not be resumable from it
+            if (!currentSessionToken.empty()) {
+                endSession(currentSessionToken);
+                currentSessionToken.clear();
+            }
+            // If the user is a customer, allow them to place an order
+            getCustomerAction(ud);
+        }
+    }
+
+    else // If user opts to exit
+    {
+
+        // Display a thank you message and exit the program
+        cout << "\n====== Thank you for using NinjaFood's Food Ordering System program! ======\n"
+            << "===================== Have a nice day and take care :) ====================\n";
+        exit(0); // Terminate the program
+
+    }
+    return 0;
+}
+
+// Function to determine the user's identity: whether they are a restaurant manager or a customer
+char getUserType() {
+    // Prompt the user to choose their role until they enter 'M', 'm', 'C' or 'c'
+    return promptChoice("\n=> Please select your identity: \n"
+                        "[M] Restaurant Manager\n"
+                        "[C] Customer\n", "MmCc");
+}
+
+// Login function to authenticate restaurant managers and secure system access
+void login(UserDetails& ud) {
+    bool matchFound = false; // Flag to track whether a valid login is found
+    char choice; // Variable to store user input (login or sign up choice)
+
+    cout << "\n**************************** LOGIN PAGE ****************************\n";
+
+    // Prompt the user to choose between logging in or signing up (either '1' or '2')
+    cout << "\n/// Welcome. You are accessing as RESTAURANT MANAGER.\n";
+    choice = promptChoice("=> Please select an option below to proceed:\n"
+                          "[1] Login\n"
+                          "[2] Sign up\n", "12");
+
+    // If the manager chooses login
+    if (choice == '1') {
+        // Check if any manager account exists (the credentials file is missing or empty otherwise)
+        if (countManagerAccounts() == 0) {
+            cout << "\n/// No login credentials found. Please sign up first!\n"
+                << "/// Redirecting to sign up page...\n\n";
+
+            // If there are no accounts, redirect to sign-up process
+            signup(ud);
+        }
+        else {
+            // Loop until valid login credentials are entered
+            while (!matchFound) {
+                cout << "\n=> Enter username: ";
+                ud.username = readToken(); // Get the manager's username
+                cout << "=> Enter password: ";
+                ud.password = readToken(); // Get the manager's password
+
+                // Look the username up in the manager accounts and check the password
+                matchFound = verifyManager(ud.username, ud.password);
+
+                // If no match is found, prompt user to try again
+                if (!matchFound) {
+                    cout << "\n/// Incorrect username or password."
+                        << "\n/// Please ensure the username and password are entered correctly (case-sensitive)."
+                        << "\n/// Try again!\n";
+                }
+                else {
+                    // Open a session, so the manager's actions are checked against their role without logging in again
+                    currentSessionToken = startSession(ud.username);
+                    ManagerSession session;
+                    checkSession(currentSessionToken, session);
+                    cout << "\n/// Login successful! Welcome as RESTAURANT MANAGER (" << session.role << ").\n\n"; // Successful login message
+                    break; // Exit the loop if login is successful
+                }
+            }
+        }
+    }
+    else {
+        signup(ud); // If user selects sign-up, proceed to sign-up process
+    }
+}
+
+// Function to log out the restaurant manager and redirect back to the main page
+// The manager's session stays open, so they can resume it from the main page until it expires or a customer
+// takes over the kiosk
+int logout() {
+    cout << "\n/// Redirecting to main page...\n\n"; // Notify the user that they are being redirected
+    return runProgram(); // Run the main page again to return to the main menu
+}
+
+// Function to read the manager accounts from the credentials file (the caller must hold the table's lock)
+// Credentials structure: username, password and role, separated by tabs
+// Accounts without a role (created before roles existed) belong to the owner
+void loadManagerAccounts(SessionTable& table) {
+    ifstream file("login_credentials.txt");
+    string line; // One account of the credentials file
+
+    table.accounts.clear();
+    table.accountsLoaded = true;
+
+    while (getline(file, line)) {
+        size_t passwordStart = line.find('\t');
+        if (passwordStart == string::npos)
+            continue;
+        size_t roleStart = line.find('\t', passwordStart + 1);
+
+        ManagerAccount account;
+        account.password = line.substr(passwordStart + 1, roleStart == string::npos ? string::npos : roleStart - passwordStart - 1);
+        account.role = roleStart == string::npos ? "owner" : line.substr(roleStart + 1);
+        table.accounts[line.substr(0, passwordStart)] = account;
+    }
+}
+
+// Function to check a username and password against the manager accounts
+bool verifyManager(string username, string password) {
+    lock_guard<mutex> lock(managerSessions.lock);
+    if (!managerSessions.accountsLoaded)
+        loadManagerAccounts(managerSessions);
+
+    auto found = managerSessions.accounts.find(username);
+    return found != managerSessions.accounts.end() && found->second.password == password;
+}
+
+// Function to check whether a manager account already uses the given username
+bool managerAccountExists(string username) {
+    lock_guard<mutex> lock(managerSessions.lock);
+    if (!managerSessions.accountsLoaded)
+        loadManagerAccounts(managerSessions);
+
+    return managerSessions.accounts.count(username) > 0;
+}
+
+// Function to find the number of manager accounts
+int countManagerAccounts() {
+    lock_guard<mutex> lock(managerSessions.lock);
+    if (!managerSessions.accountsLoaded)
+        loadManagerAccounts(managerSessions);
+
+    return (int)managerSessions.accounts.size();
+}
+
+// Function to add a new manager account to the credentials file and the account table
+// The first account becomes the owner; later accounts are staff until the owner changes their role in the file
+string addManagerAccount(string username, string password) {
+    lock_guard<mutex> lock(managerSessions.lock);
+    if (!managerSessions.accountsLoaded)
+        loadManagerAccounts(managerSessions);
+
+    ManagerAccount account;
+    account.password = password;
+    account.role = managerSessions.accounts.empty() ? "owner" : "staff";
+    managerSessions.accounts[username] = account;
+
+    fstream file;
+    file.open("login_credentials.txt", ios::out | ios::app); // Append the account to the credentials file
+    file << username << '\t' << password << '\t' << account.role << "\n";
+    file.close();
+
+    return account.role;
+}
+
+// Function to find the permissions a role grants
+//      owner      - everything
+//      supervisor - create/update the menu and update prices
+//      staff      - neither of those, nor the stats and sales reports
+uint32_t rolePermissions(string role) {
+    if (role == "owner")
+        return PERMISSION_EDIT_MENU | PERMISSION_EDIT_PRICES | PERMISSION_VIEW_STATS;
+    if (role == "supervisor")
+        return PERMISSION_EDIT_MENU | PERMISSION_EDIT_PRICES;
+    return 0;
+}
+
+// Function to open a session for a manager who has logged in; returns the session's token
+// The token is 128 random bits, written as 32 hexadecimal digits
+string startSession(string username) {
+    random_device random; // Source of unpredictable numbers for the token
+    ostringstream token;
+    for (int i = 0; i < 4; i++)
+        token << hex << setw(8) << setfill('0') << (uint32_t)random();
+
+    time_t now = time(0);
+    lock_guard<mutex> lock(managerSessions.lock);
+    if (!managerSessions.accountsLoaded)
+        loadManagerAccounts(managerSessions);
+
+    // Drop the sessions that have ended (sessions are only opened at login, so this is rare)
+    for (auto it = managerSessions.sessions.begin(); it != managerSessions.sessions.end();) {
+        if (it->second.expiresAt <= now)
+            it = managerSessions.sessions.erase(it);
+        else
+            ++it;
+    }
+
+    ManagerSession& session = managerSessions.sessions[token.str()];
+    session.username = username;
+    session.role = managerSessions.accounts[username].role;
+    session.permissions = rolePermissions(session.role);
+    session.expiresAt = now + SESSION_IDLE_SECONDS;
+    return token.str();
+}
+
+// Function to find an open session from its token, copying it into session
+// Using a session keeps it open for another SESSION_IDLE_SECONDS; returns false if it has ended
+bool checkSession(string token, ManagerSession& session) {
+    time_t now = time(0);
+    lock_guard<mutex> lock(managerSessions.lock);
+
+    auto found = managerSessions.sessions.find(token);
+    if (found == managerSessions.sessions.end())
+        return false;
+    if (found->second.expiresAt <= now) {
+        managerSessions.sessions.erase(found);
+        return false;
+    }
+
+    found->second.expiresAt = now + SESSION_IDLE_SECONDS;
+    session = found->second;
+    return true;
+}
+
+// Function to close a session
+void endSession(string token) {
+    lock_guard<mutex> lock(managerSessions.lock);
+    managerSessions.sessions.erase(token);
+}
+
+// Function to check that the manager using this terminal may perform an action, telling them if not
+bool requirePermission(uint32_t permission, string action) {
+    ManagerSession session;
+    if (!checkSession(currentSessionToken, session)) {
+        cout << "\n/// Your session has ended. Please log in again to " << action << ".\n";
+        return false;
+    }
+    if ((session.permissions & permission) == 0) {
+        cout << "\n/// Sorry, your account's role (" << session.role << ") is not allowed to " << action << ".\n";
+        return false;
+    }
+    return true;
+}
+
+// Function to ask which branch (outlet) the program is being used for
+// The NINJAFOOD_BRANCH environment variable can preselect the branch (e.g. on a kiosk)
+// Every branch keeps its own menu, stock, sales and customer files in branches/<branch ID>/,
+// while the main branch (no ID) keeps using the files in the working directory
+void selectBranch() {
+    string branchId; // The branch ID entered by the user
+    bool valid = false; // Whether the entered branch ID is valid
+    vector<string> branchIds = readBranchIds(); // Every registered branch, including the main branch
+
+    const char* presetBranch = getenv("NINJAFOOD_BRANCH");
+    if (presetBranch != nullptr) {
+        branchId = presetBranch;
+    } else if (branchIds.size() > 1) {
+        // Only ask when other branches exist, so a single restaurant works as before
+        cout << "\n=> Please enter the ID of your branch (leave blank for the main branch).\n"
+             << "/// Registered branches:";
+        for (const string& id : branchIds) {
+            if (!id.empty())
+                cout << " " << id;
+        }
+        cout << "\n=> Branch ID: ";
+        branchId = readLine();
+    }
+
+    // Validate the branch ID - letters, digits, '-' and '_' only, at most 20 characters
+    while (!valid) {
+        valid = branchId.length() <= 20;
+        for (char c : branchId)
+            valid = valid && (isalnum((unsigned char)c) || c == '-' || c == '_');
+
+        if (!valid) {
+            cout << "\n/// Invalid branch ID (letters, digits, '-' and '_' only, max 20 characters). Please try again!";
+            cout << "\n=> Branch ID: ";
+            branchId = readLine();
+        }
+    }
+
+    // Register a new branch and create its data folder
+    if (!branchId.empty() && find(branchIds.begin(), branchIds.end(), branchId) == branchIds.end()) {
+        cout << "\n/// Branch " << branchId << " is new. Creating its data folder...\n";
+        filesystem::create_directories(branchPath(branchId, ""));
+
+        fstream branchesFile;
+        branchesFile.open("branches.txt", ios::out | ios::app); // Open the branch registry to add the new branch
+        branchesFile << branchId << "\n";
+        branchesFile.close();
+    }
+
+    currentBranchId = branchId;
+    branchSelected = true;
+
+    if (!currentBranchId.empty())
+        cout << "\n/// You are using branch: " << currentBranchId << "\n";
+}
+
+// Function to return the path of a data file (e.g. "menu.txt") of the given branch
+string branchPath(string branchId, string fileName) {
+    if (branchId.empty())
+        return fileName; // The main branch keeps its files in the working directory
+    return "branches/" + branchId + "/" + fileName;
+}
+
+// Function to return the path of a data file (e.g. "menu.txt") of the current branch
+string dataPath(string fileName) {
+    return branchPath(currentBranchId, fileName);
+}
+
+// Function to read the IDs of every registered branch from the branch registry
+// The main branch (empty ID) is always listed first
+vector<string> readBranchIds() {
+    vector<string> branchIds(1, ""); // Start with the main branch
+    string branchId; // Each branch ID read from the file
+
+    fstream branchesFile;
+    branchesFile.open("branches.txt", ios::in); // Open the branch registry in read mode
+
+    while (getline(branchesFile, branchId)) {
+        if (!branchId.empty() && find(branchIds.begin(), branchIds.end(), branchId) == branchIds.end())
+            branchIds.push_back(branchId);
+    }
+
+    branchesFile.close(); // Close the branch registry
+    return branchIds;
+}
+
+// Function to return the menu of a branch, loading it only when it is not already in memory
+// The menu file's modification time and size tell whether the copy in memory is still current. With a shared
+// catalog, kiosks writing back their stock change the file but not the menu (the stock is read from the shared
+// catalog), so the copy also stays current as long as no other change has been published since it was loaded.
+// Only BRANCH_CACHE_CAPACITY menus are kept; loading another one drops the least recently used
+shared_ptr<BranchCatalog> loadBranchCatalog(string branchId) {
+    // Bring the current branch's shared catalog in line with its menu file first, if the file was changed elsewhere
+    uint32_t sharedEpoch = 0; // Layout epoch of the shared catalog, if it matches the menu file
+    if (branchId == currentBranchId && useSharedCatalog()) {
+        syncSharedCatalog(false);
+        SharedCatalogSegment* segment = sharedCatalog.segment;
+        sharedEpoch = segment != nullptr ? segment->layoutEpoch.load() : 0;
+    }
+
+    string path = branchPath(branchId, "menu.txt"); // The branch's menu file
+    error_code error; // Set (instead of throwing) when the menu file does not exist
+    filesystem::file_time_type menuModified = filesystem::last_write_time(path, error);
+    uintmax_t menuSize = error ? 0 : filesystem::file_size(path, error);
+    string promotionsPath = branchPath(branchId, "promotions.txt"); // The branch's promotions file
+    filesystem::file_time_type promotionsModified = filesystem::last_write_time(promotionsPath, error);
+    uintmax_t promotionsSize = error ? 0 : filesystem::file_size(promotionsPath, error);
+    if (sharedEpoch != 0 && !sharedCatalogMatches(menuModified, menuSize))
+        sharedEpoch = 0; // Changed again since: the file has to be read
+
+    // Whether a loaded copy of a menu is still the branch's current menu
+    auto isCurrent = [&](const BranchCatalog& loaded) {
+        bool sameMenu = sharedEpoch != 0 ? loaded.sharedEpoch == sharedEpoch
+                                         : loaded.menuModified == menuModified && loaded.menuSize == menuSize;
+        return loaded.branchId == branchId && sameMenu
+            && loaded.promotionsModified == promotionsModified && loaded.promotionsSize == promotionsSize;
+    };
+
+    // The current branch's menu is usually the published one, which is found without taking the lock
+    shared_ptr<BranchCatalog> published = atomic_load(&publishedCatalog);
+    if (published != nullptr && isCurrent(*published))
+        return published;
+
+    {
+        lock_guard<mutex> lock(branchCatalogMutex);
+
+        // Look for a current copy of the branch's menu, marking it as the most recently used
+        for (auto it = branchCatalogCache.begin(); it != branchCatalogCache.end(); ++it) {
+            if (isCurrent(**it)) {
+                branchCatalogCache.splice(branchCatalogCache.begin(), branchCatalogCache, it);
+                if (branchId == currentBranchId)
+                    atomic_store(&publishedCatalog, branchCatalogCache.front());
+                return branchCatalogCache.front();
+            }
+        }
+    }
+
+    // Load the menu without holding the lock, so other branches can be loaded at the same time
+    shared_ptr<BranchCatalog> catalog = make_shared<BranchCatalog>();
+    catalog->branchId = branchId;
+    catalog->sharedEpoch = sharedEpoch;
+    catalog->menuModified = menuModified;
+    catalog->menuSize = menuSize;
+    catalog->promotionsModified = promotionsModified;
+    catalog->promotionsSize = promotionsSize;
+
+    // Use the binary cache of the menu when it is current, and otherwise parse the text files and rebuild it
+    string cachePath = branchPath(branchId, "menu.cache"); // The branch's catalog cache
+    // (a change of stock alone keeps the cache current, so paying for an order never rewrites it)
+    CatalogCacheHeader header; // What the cache was (or is being) built from
+    vector<int32_t> lineItems; // Menu row of each line of the menu file (see MENU_LINE_SKIPPED)
+    bool refreshHeader = false; // Whether the promotions file was touched without being changed
+    if (loadCatalogCache(cachePath, *catalog, header, lineItems, refreshHeader)) {
+        if (refreshHeader)
+            saveCatalogCache(cachePath, *catalog, header, lineItems);
+    } else {
+        // The files are hashed before they are parsed, so a change made while parsing makes the cache out of date
+        scanMenuStock(path, header.menuLayoutHash, nullptr, 0, nullptr);
+        header.promotionsHash = hashFile(promotionsPath);
+        catalog->arrMenuContent = readMenuFileLines(path, catalog->totalNumItems, lineItems);
+        buildMenuModel(catalog->arrMenuContent, catalog->totalNumItems, catalog->model);
+        buildMenuSearchIndex(catalog->arrMenuContent, catalog->totalNumItems, catalog->searchIndex);
+        compilePromotions(promotionsPath, catalog->arrMenuContent, catalog->totalNumItems, catalog->model, catalog->promotions);
+        saveCatalogCache(cachePath, *catalog, header, lineItems);
+    }
+
+    lock_guard<mutex> lock(branchCatalogMutex);
+
+    // Make the menu's prices a version of their own, sharing what has not changed with the copy being replaced
+    shared_ptr<const PriceSnapshot> previousPrices; // Prices of the older copy of the branch's menu, if any
+    for (const shared_ptr<BranchCatalog>& cached : branchCatalogCache) {
+        if (cached->branchId == branchId)
+            previousPrices = cached->prices;
+    }
+    catalog->prices = buildPriceSnapshot(catalog->arrMenuContent, catalog->totalNumItems, previousPrices);
+
+    // Replace any older copy of the branch's menu with the new one
+    branchCatalogCache.remove_if([&](const shared_ptr<BranchCatalog>& cached) { return cached->branchId == branchId; });
+    branchCatalogCache.push_front(catalog);
+
+    // Drop the least recently used menus (they are freed once nobody is using them)
+    while ((int)branchCatalogCache.size() > BRANCH_CACHE_CAPACITY)
+        branchCatalogCache.pop_back();
+
+    // Publish the new menu of the current branch; orders still using the old one keep it until they are done
+    if (branchId == currentBranchId)
+        atomic_store(&publishedCatalog, catalog);
+
+    return catalog;
+}
+
+// Function to make a version of the item prices of a menu (the caller holds branchCatalogMutex)
+// Blocks of prices that are the same as in the previous version are shared with it rather than copied, and if
+// no price changed at all the previous version itself is returned, so the version only moves on with the prices
+shared_ptr<const PriceSnapshot> buildPriceSnapshot(string** arrMenuContent, int totalNumItems, const shared_ptr<const PriceSnapshot>& previous) {
+    // Lay the prices out by menu index
+    vector<Money> prices; // Price of each menu index (-1 cents where there is no item)
+    for (int row = 0; row < totalNumItems; row++) {
+        int menuIndex = stoi(arrMenuContent[row][MENU_INDEX]);
+        if (menuIndex < 0)
+            continue;
+        if ((int)prices.size() <= menuIndex)
+            prices.resize(menuIndex + 1, Money{-1});
+        parseMoney(arrMenuContent[row][MENU_PRICE], prices[menuIndex]);
+    }
+    size_t numOfChunks = (prices.size() + PRICE_CHUNK_SIZE - 1) / PRICE_CHUNK_SIZE;
+    prices.resize(numOfChunks * PRICE_CHUNK_SIZE, Money{-1});
+
+    shared_ptr<PriceSnapshot> snapshot = make_shared<PriceSnapshot>();
+    bool changed = previous == nullptr || previous->chunks.size() != numOfChunks; // Whether any price changed
+    for (size_t c = 0; c < numOfChunks; c++) {
+        array<Money, PRICE_CHUNK_SIZE> chunk; // Prices of the menu indices in this block
+        copy(prices.begin() + c * PRICE_CHUNK_SIZE, prices.begin() + (c + 1) * PRICE_CHUNK_SIZE, chunk.begin());
+        if (previous != nullptr && c < previous->chunks.size() && *previous->chunks[c] == chunk)
+            snapshot->chunks.push_back(previous->chunks[c]);
+        else {
+            snapshot->chunks.push_back(make_shared<const array<Money, PRICE_CHUNK_SIZE>>(chunk));
+            changed = true;
+        }
+    }
+    if (!changed)
+        return previous;
+
+    snapshot->version = ++latestPriceVersion;
+    return snapshot;
+}
+
+// Function to look up the price of an item in a version of the prices
+// Returns false, changing nothing, if the item was not on the menu in that version
+bool snapshotPrice(const PriceSnapshot& prices, int menuIndex, Money& price) {
+    if (menuIndex < 0 || menuIndex / PRICE_CHUNK_SIZE >= (int)prices.chunks.size())
+        return false;
+    Money found = (*prices.chunks[menuIndex / PRICE_CHUNK_SIZE])[menuIndex % PRICE_CHUNK_SIZE];
+    if (found.cents < 0)
+        return false;
+    price = found;
+    return true;
+}
+
+// Function to load a catalog from its binary cache, if the cache was built from the current menu layout and promotions
+// The catalog must already hold the modification time and size of the promotions file. The header is filled in with
+// them (and the content hashes), ready for writing a new cache. refreshHeader is set if the promotions file has a new
+// modification time but the same content, so the cache's header should be updated (lineItems is then filled in too)
+// The cache stays mapped in the catalog, and the search index is used where it lies. The stock is read from the
+// menu file itself (see scanMenuStock). Returns false if there is no current cache, leaving the catalog's menu empty
+bool loadCatalogCache(string path, BranchCatalog& catalog, CatalogCacheHeader& header, vector<int32_t>& lineItems, bool& refreshHeader) {
+    MappedFile& file = catalog.cacheFile; // The cache, mapped into memory
+    CatalogCacheHeader stored; // The header the cache was written with
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "NFCAT\0\0\2", 8);
+    header.promotionsSize = catalog.promotionsSize;
+    header.promotionsModified = catalog.promotionsModified.time_since_epoch().count();
+
+    if (!mapFile(path, file))
+        return false;
+    if (file.size < sizeof(stored)) {
+        unmapFile(file);
+        return false;
+    }
+    memcpy(&stored, file.data, sizeof(stored));
+
+    // The cache must be of this format, and built from a promotions file of the same size
+    bool current = memcmp(stored.magic, header.magic, 8) == 0 && stored.promotionsSize == header.promotionsSize;
+
+    // A promotions file with a new modification time may still hold the same content (e.g. copied to the kiosk again)
+    if (current && stored.promotionsModified != header.promotionsModified) {
+        current = hashFile(branchPath(catalog.branchId, "promotions.txt")) == stored.promotionsHash;
+        refreshHeader = true;
+    }
+    if (!current) {
+        unmapFile(file);
+        return false;
+    }
+    header.menuLayoutHash = stored.menuLayoutHash;
+    header.promotionsHash = stored.promotionsHash;
+
+    // Read the menu details (NUM_OF_MENU_FIELDS per item, straight into one block of strings), the menu model, the search
+    // index and the promotion plan. The line items and the search index's trigram table are used where they lie
+    CacheReader reader{file.data + sizeof(stored), file.data + file.size};
+    vector<string> modifierNames; // Name of each modifier
+    vector<char> modifierKinds; // Kind of each modifier
+    vector<int64_t> modifierDeltas; // Price change of each modifier, in cents
+    size_t numOfLines = 0; // Number of lines of the menu file
+    size_t numOfTrigramStarts = 0; // Number of entries in trigramStart
+    size_t numOfTrigramRows = 0; // Number of entries in trigramRows
+    vector<uint16_t> newcomer; // Newcomer percentage and rule
+    MenuSearchIndex& searchIndex = catalog.searchIndex;
+
+    size_t totalNumItems = stored.totalNumItems;
+    if (totalNumItems > file.size / 8) {
+        unmapFile(file); // Cannot be right: every item takes more than 8 bytes
+        return false;
+    }
+    catalog.menuCells = new string[totalNumItems * NUM_OF_MENU_FIELDS];
+    readCacheStrings(reader, catalog.menuCells, totalNumItems * NUM_OF_MENU_FIELDS);
+    const int32_t* cachedLineItems = viewCacheArray<int32_t>(reader, numOfLines); // Menu row of each line
+    readCacheStrings(reader, catalog.model.categories);
+    readCacheArray(reader, catalog.model.itemCategory);
+    readCacheArray(reader, catalog.model.modifierStart);
+    readCacheStrings(reader, modifierNames);
+    readCacheArray(reader, modifierKinds);
+    readCacheArray(reader, modifierDeltas);
+    readCacheArray(reader, catalog.model.componentStart);
+    readCacheArray(reader, catalog.model.components);
+    readCacheStrings(reader, searchIndex.lowerNames);
+    searchIndex.trigrams = viewCacheArray<uint32_t>(reader, searchIndex.numOfTrigrams);
+    searchIndex.trigramStart = viewCacheArray<uint32_t>(reader, numOfTrigramStarts);
+    searchIndex.trigramRows = viewCacheArray<int>(reader, numOfTrigramRows);
+    readCacheStrings(reader, catalog.promotions.ruleNames);
+    readCacheArray(reader, catalog.promotions.rowPercent);
+    readCacheArray(reader, catalog.promotions.rowPercentRule);
+    readCacheArray(reader, catalog.promotions.rowBuyQuantity);
+    readCacheArray(reader, catalog.promotions.rowFreeQuantity);
+    readCacheArray(reader, catalog.promotions.rowDealRule);
+    readCacheArray(reader, catalog.promotions.happyHours);
+    readCacheArray(reader, newcomer);
+    readCacheArray(reader, catalog.promotions.loyaltyTiers);
+
+    // Check that the parts fit together before using them
+    size_t numOfTrigrams = searchIndex.numOfTrigrams;
+    bool valid = reader.ok && reader.cursor == reader.end
+              && catalog.model.itemCategory.size() == totalNumItems
+              && catalog.model.modifierStart.size() == totalNumItems + 1 && catalog.model.modifierStart.back() == modifierNames.size()
+              && modifierKinds.size() == modifierNames.size() && modifierDeltas.size() == modifierNames.size()
+              && catalog.model.componentStart.size() == totalNumItems + 1 && catalog.model.componentStart.back() == catalog.model.components.size()
+              && searchIndex.lowerNames.size() == totalNumItems
+              && numOfTrigramStarts == numOfTrigrams + 1 && searchIndex.trigramStart[numOfTrigrams] == numOfTrigramRows
+              && catalog.promotions.rowPercent.size() == totalNumItems && newcomer.size() == 2;
+    for (size_t t = 0; valid && t < numOfTrigrams; t++)
+        valid = searchIndex.trigramStart[t] <= searchIndex.trigramStart[t + 1]
+             && (t == 0 || searchIndex.trigrams[t - 1] < searchIndex.trigrams[t]);
+    for (size_t row = 0; valid && row < numOfTrigramRows; row++)
+        valid = searchIndex.trigramRows[row] >= 0 && (size_t)searchIndex.trigramRows[row] < totalNumItems;
+    size_t numOfItemLines = 0; // Number of lines holding an item (they hold the items in order)
+    for (size_t line = 0; valid && line < numOfLines; line++) {
+        if (cachedLineItems[line] >= 0)
+            valid = (size_t)cachedLineItems[line] == numOfItemLines++;
+        else
+            valid = cachedLineItems[line] == MENU_LINE_SKIPPED || cachedLineItems[line] == MENU_LINE_BAD_STOCK;
+    }
+    valid = valid && numOfItemLines == totalNumItems;
+
+    // Read the stock of every item from the menu file, whose layout must be the one the cache was built from
+    uint64_t layoutHash = 0; // Content hash of the menu file without its stock column
+    valid = valid && scanMenuStock(branchPath(catalog.branchId, "menu.txt"), layoutHash, cachedLineItems, numOfLines, catalog.menuCells)
+         && layoutHash == stored.menuLayoutHash;
+    if (!valid) {
+        unmapFile(file);
+        delete[] catalog.menuCells;
+        catalog.menuCells = nullptr;
+        catalog.model = MenuModel();
+        catalog.searchIndex = MenuSearchIndex();
+        catalog.promotions = PromotionPlan();
+        return false;
+    }
+    if (refreshHeader)
+        lineItems.assign(cachedLineItems, cachedLineItems + numOfLines);
+
+    catalog.totalNumItems = (int)totalNumItems;
+    catalog.arrMenuContent = new string*[totalNumItems];
+    for (size_t i = 0; i < totalNumItems; i++)
+        catalog.arrMenuContent[i] = catalog.menuCells + i * NUM_OF_MENU_FIELDS;
+
+    catalog.model.modifiers.resize(modifierNames.size());
+    for (size_t k = 0; k < modifierNames.size(); k++) {
+        catalog.model.modifiers[k].name = move(modifierNames[k]);
+        catalog.model.modifiers[k].kind = modifierKinds[k];
+        catalog.model.modifiers[k].priceDelta = Money{modifierDeltas[k]};
+    }
+    searchIndex.totalNumItems = (int)totalNumItems;
+
+    catalog.promotions.newcomerPercent = (uint8_t)newcomer[0];
+    catalog.promotions.newcomerRule = newcomer[1];
+    return true;
+}
+
+// Function to go through the lines of a menu file where they lie in memory, hashing everything but the stock column
+// (the layout of the menu, which the catalog cache is built from) and reading the stock of each item
+// With lineItems (the menu row of each line, as recorded in the catalog cache), the stock of each item is stored in
+// its row of menuCells. Returns false if the file cannot be read or does not fit lineItems: it has a different
+// number of lines, an item's stock is not a whole number, or a line left out only for its stock now has a valid one
+bool scanMenuStock(string path, uint64_t& layoutHash, const int32_t* lineItems, size_t numOfLines, string* menuCells) {
+    MappedFile menu; // The menu file, mapped into memory
+    uint64_t hash = 14695981039346656037ULL;
+    size_t line = 0; // Number of the current line
+    bool fits = true; // Whether the lines fit lineItems so far
+
+    if (!mapFile(path, menu))
+        return false;
+    for (size_t start = 0; start < menu.size; line++) {
+        const char* text = menu.data + start; // The current line
+        const char* newline = (const char*)memchr(text, '\n', menu.size - start);
+        size_t length = newline != nullptr ? newline - text : menu.size - start;
+        start += length + 1;
+        if (length > 0 && text[length - 1] == '\r') // As parseMenuLine does
+            --length;
+
+        // Find the stock column: it follows the MENU_STOCK columns before it and ends at the next comma
+        size_t stockStart = length; // Where the stock column starts (the end of the line if there is none)
+        size_t stockEnd = length; // Where it ends
+        int numOfCommas = 0;
+        for (size_t i = 0; i < length && numOfCommas <= MENU_STOCK; i++) {
+            if (text[i] != ',')
+                continue;
+            if (++numOfCommas == MENU_STOCK)
+                stockStart = i + 1;
+            else if (numOfCommas == MENU_STOCK + 1)
+                stockEnd = i;
+        }
+
+        for (size_t i = 0; i < length; i++) {
+            if (i == stockStart)
+                i = stockEnd;
+            if (i < length) {
+                hash ^= (unsigned char)text[i];
+                hash *= 1099511628211ULL;
+            }
+        }
+        hash ^= '\n';
+        hash *= 1099511628211ULL;
+
+        if (lineItems == nullptr || !fits)
+            continue;
+        if (line >= numOfLines) {
+            fits = false;
+            continue;
+        }
+
+        // Read the stock as parseMenuLine does (a whole number, with any spaces around it)
+        int stock = 0;
+        string stockText(text + stockStart, stockEnd - stockStart);
+        size_t first = stockText.find_first_not_of(" \t");
+        bool validStock = first != string::npos
+                       && parseInt(stockText.substr(first, stockText.find_last_not_of(" \t") - first + 1), stock);
+        if (lineItems[line] >= 0 && validStock)
+            menuCells[lineItems[line] * NUM_OF_MENU_FIELDS + MENU_STOCK] = to_string(stock);
+        else if (lineItems[line] >= 0 || (lineItems[line] == MENU_LINE_BAD_STOCK && validStock))
+            fits = false;
+    }
+    unmapFile(menu);
+
+    layoutHash = hash;
+    return lineItems == nullptr || (fits && line == numOfLines);
+}
+
+// Function to write the binary cache of a catalog, with the given header and the menu row of each line of the menu file
+// The stock is left out (it is read from the menu file on loading). The cache is written to a file of its own and
+// then renamed over the old one, so a process starting at the same time reads either the old or the new cache in full
+void saveCatalogCache(string path, const BranchCatalog& catalog, const CatalogCacheHeader& header, const vector<int32_t>& lineItems) {
+    string out; // The cache being written
+    vector<string> cells; // Menu details of every item, one after the other
+    vector<string> modifierNames; // Name of each modifier
+    vector<char> modifierKinds; // Kind of each modifier
+    vector<int64_t> modifierDeltas; // Price change of each modifier, in cents
+    const MenuSearchIndex& searchIndex = catalog.searchIndex;
+    size_t numOfTrigrams = searchIndex.numOfTrigrams;
+
+    CatalogCacheHeader written = header;
+    written.totalNumItems = catalog.totalNumItems;
+    out.append((const char*)&written, sizeof(written));
+
+    for (int i = 0; i < catalog.totalNumItems; i++) {
+        cells.insert(cells.end(), catalog.arrMenuContent[i], catalog.arrMenuContent[i] + NUM_OF_MENU_FIELDS);
+        cells[i * NUM_OF_MENU_FIELDS + MENU_STOCK].clear();
+    }
+    for (const MenuModifier& modifier : catalog.model.modifiers) {
+        modifierNames.push_back(modifier.name);
+        modifierKinds.push_back(modifier.kind);
+        modifierDeltas.push_back(modifier.priceDelta.cents);
+    }
+    vector<uint16_t> newcomer = {catalog.promotions.newcomerPercent, catalog.promotions.newcomerRule};
+
+    appendCacheStrings(out, cells);
+    appendCacheArray(out, lineItems);
+    appendCacheStrings(out, catalog.model.categories);
+    appendCacheArray(out, catalog.model.itemCategory);
+    appendCacheArray(out, catalog.model.modifierStart);
+    appendCacheStrings(out, modifierNames);
+    appendCacheArray(out, modifierKinds);
+    appendCacheArray(out, modifierDeltas);
+    appendCacheArray(out, catalog.model.componentStart);
+    appendCacheArray(out, catalog.model.components);
+    appendCacheStrings(out, searchIndex.lowerNames);
+    appendCacheArray(out, vector<uint32_t>(searchIndex.trigrams, searchIndex.trigrams + numOfTrigrams));
+    appendCacheArray(out, vector<uint32_t>(searchIndex.trigramStart, searchIndex.trigramStart + numOfTrigrams + 1));
+    appendCacheArray(out, vector<int>(searchIndex.trigramRows, searchIndex.trigramRows + searchIndex.trigramStart[numOfTrigrams]));
+    appendCacheStrings(out, catalog.promotions.ruleNames);
+    appendCacheArray(out, catalog.promotions.rowPercent);
+    appendCacheArray(out, catalog.promotions.rowPercentRule);
+    appendCacheArray(out, catalog.promotions.rowBuyQuantity);
+    appendCacheArray(out, catalog.promotions.rowFreeQuantity);
+    appendCacheArray(out, catalog.promotions.rowDealRule);
+    appendCacheArray(out, catalog.promotions.happyHours);
+    appendCacheArray(out, newcomer);
+    appendCacheArray(out, catalog.promotions.loyaltyTiers);
+
+    replaceFile(path, out);
+}
+
+// Function to add an array of plain values to a cache being written: the number of values, then the values
+// Every array starts at a multiple of 8 bytes, so the values can be read straight from the mapped cache
+template <typename T>
+void appendCacheArray(string& out, const vector<T>& values) {
+    static_assert(is_trivially_copyable<T>::value, "cache arrays must hold plain values");
+    uint64_t count = values.size();
+    out.append((const char*)&count, sizeof(count));
+    out.append((const char*)values.data(), values.size() * sizeof(T));
+    out.append((8 - out.size() % 8) % 8, '\0');
+}
+
+// Function to add a list of strings to a cache being written: the end offset of each string, then their characters
+void appendCacheStrings(string& out, const vector<string>& values) {
+    vector<uint32_t> ends; // Where each string ends within the characters
+    string characters; // The strings back to back
+    for (const string& value : values) {
+        characters += value;
+        ends.push_back((uint32_t)characters.size());
+    }
+    appendCacheArray(out, ends);
+    appendCacheArray(out, vector<char>(characters.begin(), characters.end()));
+}
+
+// Function to find an array written by appendCacheArray, moving the reader past it
+// Returns a pointer to the values where they lie in the cache (valid while the cache stays mapped),
+// or nullptr (with count 0) if the cache is too short
+template <typename T>
+const T* viewCacheArray(CacheReader& reader, size_t& count) {
+    uint64_t numOfValues = 0;
+    count = 0;
+    if (!reader.ok || reader.end - reader.cursor < (ptrdiff_t)sizeof(numOfValues)) {
+        reader.ok = false;
+        return nullptr;
+    }
+    memcpy(&numOfValues, reader.cursor, sizeof(numOfValues));
+    reader.cursor += sizeof(numOfValues);
+
+    uint64_t size = numOfValues * sizeof(T);
+    uint64_t padding = (8 - size % 8) % 8;
+    if (numOfValues > (uint64_t)(reader.end - reader.cursor) / sizeof(T) || size + padding > (uint64_t)(reader.end - reader.cursor)) {
+        reader.ok = false;
+        return nullptr;
+    }
+    const T* first = (const T*)reader.cursor;
+    reader.cursor += size + padding;
+    count = (size_t)numOfValues;
+    return first;
+}
+
+// Function to read an array written by appendCacheArray
+template <typename T>
+void readCacheArray(CacheReader& reader, vector<T>& values) {
+    size_t count = 0;
+    const T* first = viewCacheArray<T>(reader, count);
+    values.assign(first, first + count);
+}
+
+// Function to find a list of strings written by appendCacheStrings; returns false if the list is damaged
+bool viewCacheStrings(CacheReader& reader, const uint32_t*& ends, size_t& count, const char*& characters) {
+    size_t numOfCharacters = 0;
+    ends = viewCacheArray<uint32_t>(reader, count);
+    characters = viewCacheArray<char>(reader, numOfCharacters);
+
+    uint32_t start = 0;
+    for (size_t i = 0; i < count && reader.ok; i++) {
+        if (ends[i] < start || ends[i] > numOfCharacters)
+            reader.ok = false;
+        start = ends[i];
+    }
+    return reader.ok;
+}
+
+// Function to read a list of strings written by appendCacheStrings
+void readCacheStrings(CacheReader& reader, vector<string>& values) {
+    const uint32_t* ends = nullptr; // Where each string ends within the characters
+    const char* characters = nullptr; // The strings back to back
+    size_t count = 0;
+
+    values.clear();
+    if (!viewCacheStrings(reader, ends, count, characters))
+        return;
+    values.reserve(count);
+    for (size_t i = 0; i < count; i++)
+        values.emplace_back(characters + (i == 0 ? 0 : ends[i - 1]), ends[i] - (i == 0 ? 0 : ends[i - 1]));
+}
+
+// Function to read a list of strings written by appendCacheStrings into the given strings
+// The list must hold exactly count strings, or the reader is marked as failed
+void readCacheStrings(CacheReader& reader, string* values, size_t count) {
+    const uint32_t* ends = nullptr; // Where each string ends within the characters
+    const char* characters = nullptr; // The strings back to back
+    size_t numOfValues = 0;
+
+    if (!viewCacheStrings(reader, ends, numOfValues, characters) || numOfValues != count) {
+        reader.ok = false;
+        return;
+    }
+    for (size_t i = 0; i < count; i++)
+        values[i].assign(characters + (i == 0 ? 0 : ends[i - 1]), ends[i] - (i == 0 ? 0 : ends[i - 1]));
+}
+
+// Function to work out the content hash of a file (64-bit FNV-1a)
+uint64_t hashFile(string path) {
+    MappedFile file;
+    uint64_t hash = 14695981039346656037ULL;
+    if (!mapFile(path, file))
+        return 0;
+    for (size_t i = 0; i < file.size; i++) {
+        hash ^= (unsigned char)file.data[i];
+        hash *= 1099511628211ULL;
+    }
+    unmapFile(file);
+    return hash;
+}
+
+// Function to map a whole file into memory for reading; returns false if the file cannot be opened
+// Where memory mapping is not available, the file is read into a buffer instead
+bool mapFile(string path, MappedFile& file) {
+#ifndef _WIN32
+    int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0)
+        return false;
+    off_t size = lseek(descriptor, 0, SEEK_END);
+    if (size > 0) {
+        void* data = mmap(nullptr, (size_t)size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (data != MAP_FAILED) {
+            file.data = (const char*)data;
+            file.size = (size_t)size;
+            file.mapped = true;
+        }
+    }
+    close(descriptor);
+    if (size <= 0 || file.mapped)
+        return size >= 0;
+#endif
+    ifstream in(path, ios::binary);
+    if (!in)
+        return false;
+    file.buffer.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    file.data = file.buffer.data();
+    file.size = file.buffer.size();
+    return true;
+}
+
+// Function to release a file mapped by mapFile
+void unmapFile(MappedFile& file) {
+#ifndef _WIN32
+    if (file.mapped)
+        munmap((void*)file.data, file.size);
+#endif
+    file.data = nullptr;
+    file.size = 0;
+    file.mapped = false;
+    file.buffer.clear();
+}
+
+// Function to map the shared catalog of the current branch, so every kiosk process of the branch on this host
+// sees the same live stock and prices. The first kiosk to start creates it from the menu file, and the others
+// wait for it to be filled. Where shared memory is not available (or cannot be set up), the kiosk works from
+// the menu file alone
+void startSharedCatalog() {
+    stopSharedCatalog(); // A simulation moves on to the catalog of its scratch branch
+#ifndef _WIN32
+    // Every kiosk using the same menu file finds the same segment, named after the full path of the file
+    string path = filesystem::absolute(dataPath("menu.txt")).string();
+    uint64_t hash = 14695981039346656037ULL;
+    for (char c : path) {
+        hash ^= (unsigned char)c;
+        hash *= 1099511628211ULL;
+    }
+    char name[40];
+    snprintf(name, sizeof(name), "/ninjafood-2-%016llx", (unsigned long long)hash);
+
+    bool created = true; // Whether this kiosk is the first, and sets the segment up
+    int descriptor = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (descriptor < 0 && errno == EEXIST) {
+        created = false;
+        descriptor = shm_open(name, O_RDWR, 0600);
+    }
+    if (descriptor < 0)
+        return;
+    if (created && ftruncate(descriptor, sizeof(SharedCatalogSegment)) != 0) {
+        close(descriptor);
+        shm_unlink(name);
+        return;
+    }
+
+    // Map the segment once the kiosk that created it has given it its size
+    struct stat info;
+    for (int waited = 0; waited < SHARED_CATALOG_WAIT_MS && fstat(descriptor, &info) == 0
+                         && info.st_size < (off_t)sizeof(SharedCatalogSegment); waited++)
+        this_thread::sleep_for(chrono::milliseconds(1));
+    void* data = MAP_FAILED;
+    if (fstat(descriptor, &info) == 0 && info.st_size >= (off_t)sizeof(SharedCatalogSegment))
+        data = mmap(nullptr, sizeof(SharedCatalogSegment), PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    if (data == MAP_FAILED) {
+        close(descriptor);
+        return;
+    }
+    sharedCatalog.descriptor = descriptor;
+    sharedCatalog.name = name;
+
+    if (created) {
+        // Fill the segment from the menu file, and only then let the other kiosks use it
+        sharedCatalog.segment = new (data) SharedCatalogSegment();
+        syncSharedCatalog(true);
+        if (sharedCatalog.segment == nullptr) {
+            shm_unlink(name); // The menu does not fit: no kiosk shares a catalog for it
+            return;
+        }
+        memcpy(sharedCatalog.segment->magic, "NFSHM\0\0\2", 8);
+        sharedCatalog.segment->ready.store(1, memory_order_release);
+        return;
+    }
+
+    SharedCatalogSegment* segment = (SharedCatalogSegment*)data;
+    for (int waited = 0; waited < SHARED_CATALOG_WAIT_MS && segment->ready.load(memory_order_acquire) == 0; waited++)
+        this_thread::sleep_for(chrono::milliseconds(1));
+    if (segment->ready.load(memory_order_acquire) == 0 || memcmp(segment->magic, "NFSHM\0\0\2", 8) != 0
+        || segment->unusable.load() != 0) {
+        munmap(data, sizeof(SharedCatalogSegment));
+        close(descriptor);
+        sharedCatalog.descriptor = -1;
+        return;
+    }
+    sharedCatalog.segment = segment;
+    syncSharedCatalog(false); // Catch up with changes made to the menu file while no kiosk was running
+#endif
+}
+
+// Function to stop using the shared catalog; the kiosk then reads the stock and prices from the menu file
+// (the segment itself stays, with its live stock, for the other kiosks and the next start)
+void stopSharedCatalog() {
+#ifndef _WIN32
+    if (sharedCatalog.segment != nullptr)
+        munmap((void*)sharedCatalog.segment, sizeof(SharedCatalogSegment));
+    if (sharedCatalog.descriptor >= 0)
+        close(sharedCatalog.descriptor);
+#endif
+    sharedCatalog.segment = nullptr;
+    sharedCatalog.descriptor = -1;
+    sharedCatalog.name.clear();
+
+    lock_guard<mutex> lock(sharedCatalog.slotLock);
+    sharedCatalog.mappedEpoch = 0;
+    sharedCatalog.slotOfIndex.clear();
+}
+
+// Function to check whether this kiosk uses a shared catalog; a catalog that a kiosk has marked unusable is let go
+// of here, so the kiosk carries on from the menu file alone
+bool useSharedCatalog() {
+    if (sharedCatalog.segment != nullptr && sharedCatalog.segment->unusable.load() != 0)
+        stopSharedCatalog();
+    return sharedCatalog.segment != nullptr;
+}
+
+// Function to mark the shared catalog unusable for every kiosk of the branch: its items were left half published
+// by a kiosk that died while publishing them, or the menu has outgrown it. Each kiosk stops using it the next time
+// it checks (see useSharedCatalog). Its name is removed, so the next kiosk to start sets up a new one from the menu
+// file. This only marks the segment, so it is safe to call while reading it
+void abandonSharedCatalog() {
+    if (sharedCatalog.segment == nullptr)
+        return;
+    sharedCatalog.segment->unusable.store(1);
+#ifndef _WIN32
+    if (!sharedCatalog.name.empty())
+        shm_unlink(sharedCatalog.name.c_str());
+#endif
+}
+
+// Function to take the file lock of the shared catalog, which is held while the menu file is written or
+// published so the file and the segment change together. It locks out the other threads of this process
+// and the other kiosk processes. Returns false (taking nothing) if there is no shared catalog
+bool lockSharedCatalog() {
+    if (!useSharedCatalog())
+        return false;
+    sharedCatalog.writer.lock();
+#ifndef _WIN32
+    flock(sharedCatalog.descriptor, LOCK_EX);
+#endif
+    return true;
+}
+
+// Function to release the file lock of the shared catalog
+void unlockSharedCatalog() {
+#ifndef _WIN32
+    flock(sharedCatalog.descriptor, LOCK_UN);
+#endif
+    sharedCatalog.writer.unlock();
+}
+
+// Function to publish the menu file to the shared catalog if the file was changed by anything other than a kiosk
+// writing back its stock (e.g. a new item, or an edit by hand), or always if force is set (e.g. after a price update)
+void syncSharedCatalog(bool force) {
+    if (!useSharedCatalog() || (!force && sharedCatalogCurrent()))
+        return;
+
+    if (!lockSharedCatalog())
+        return;
+    bool published = true; // Whether the menu fitted in the shared catalog
+
+    // Check again with the lock held: another kiosk may have published the file meanwhile
+    if (force || !sharedCatalogCurrent()) {
+        // The file is recorded before it is read, so a change made while reading it is published next time
+        stampSharedCatalog();
+        int totalNumItems = 0;
+        string** arrMenuContent = readMenu(totalNumItems);
+        published = publishSharedCatalog(arrMenuContent, totalNumItems);
+        for (int i = 0; i < totalNumItems; i++)
+            delete[] arrMenuContent[i];
+        delete[] arrMenuContent;
+    }
+
+    unlockSharedCatalog();
+    if (!published) {
+        // The menu has outgrown the shared catalog: every kiosk works from the menu file alone, so none of them
+        // goes on deducting stock the others no longer see
+        abandonSharedCatalog();
+        stopSharedCatalog();
+    }
+}
+
+// Function to publish the items of a menu to the shared catalog (the caller holds its file lock)
+// An item keeps its live stock unless the menu holds a different stock than was last written to the file,
+// which means the stock was changed in the file itself (e.g. restocked by hand); new items take the menu's
+// stock. The live counts are moved to the next layout epoch first, so kiosks deducting stock meanwhile
+// wait and then try again against the new layout. Returns false if the menu has too many items to fit
+bool publishSharedCatalog(string** arrMenuContent, int totalNumItems) {
+    SharedCatalogSegment* segment = sharedCatalog.segment;
+    if (totalNumItems > SHARED_CATALOG_CAPACITY)
+        return false;
+
+    uint32_t epoch = segment->layoutEpoch.load() + 1;
+    if (epoch == 0)
+        epoch = 1; // 0 stands for no epoch (see BranchCatalog)
+
+    // Move the live counts to the next epoch, noting each item's live stock and the stock last written to the file
+    unordered_map<int, pair<int, int>> previous; // Live and last written stock, by menu index
+    for (int slot = 0; slot < segment->numOfItems.load(); slot++) {
+        SharedCatalogItem& item = segment->items[slot];
+        uint64_t stock = item.stock.load();
+        while (!item.stock.compare_exchange_weak(stock, (uint64_t)epoch << 32 | (uint32_t)stock)) {
+        }
+        previous[item.menuIndex.load()] = {(int32_t)(uint32_t)stock, item.fileStock.load()};
+    }
+
+    // Write the items under the sequence lock (odd while they are being written)
+    uint64_t sequence = segment->sequence.load(memory_order_relaxed);
+    segment->sequence.store(sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    for (int row = 0; row < totalNumItems; row++) {
+        SharedCatalogItem& item = segment->items[row];
+        int menuIndex = stoi(arrMenuContent[row][MENU_INDEX]);
+        int fileStock = stoi(arrMenuContent[row][MENU_STOCK]);
+        auto found = previous.find(menuIndex);
+        int stock = found != previous.end() && found->second.second == fileStock ? found->second.first : fileStock;
+        Money price;
+        parseMoney(arrMenuContent[row][MENU_PRICE], price);
+        const string& name = arrMenuContent[row][MENU_NAME];
+        uint64_t nameWords[SHARED_NAME_SIZE / 8] = {};
+        memcpy(nameWords, name.data(), min(name.size(), (size_t)SHARED_NAME_SIZE));
+
+        item.menuIndex.store(menuIndex, memory_order_relaxed);
+        item.priceCents.store(price.cents, memory_order_relaxed);
+        item.nameLength.store((int32_t)min(name.size(), (size_t)SHARED_NAME_SIZE + 1), memory_order_relaxed);
+        for (int k = 0; k < SHARED_NAME_SIZE / 8; k++)
+            item.nameWords[k].store(nameWords[k], memory_order_relaxed);
+        item.fileStock.store(fileStock);
+        item.stock.store((uint64_t)epoch << 32 | (uint32_t)stock);
+    }
+    segment->numOfItems.store(totalNumItems, memory_order_relaxed);
+    segment->layoutEpoch.store(epoch, memory_order_release);
+    segment->sequence.store(sequence + 2, memory_order_release);
+    return true;
+}
+
+// Function to record the size and modification time of the menu file in the shared catalog, once the file has
+// been written or published by a kiosk (the caller holds the file lock)
+void stampSharedCatalog() {
+    string path = dataPath("menu.txt"); // The menu file of the current branch
+    error_code error; // Set (instead of throwing) when the menu file does not exist
+    filesystem::file_time_type menuModified = filesystem::last_write_time(path, error);
+    uintmax_t menuSize = error ? 0 : filesystem::file_size(path, error);
+    sharedCatalog.segment->menuModified.store(menuModified.time_since_epoch().count());
+    sharedCatalog.segment->menuSize.store(menuSize);
+}
+
+// Function to check whether the menu file is the one last written or published by a kiosk, so the shared catalog
+// holds all of its changes (returns false if there is no shared catalog)
+bool sharedCatalogMatches(filesystem::file_time_type menuModified, uintmax_t menuSize) {
+    SharedCatalogSegment* segment = sharedCatalog.segment;
+    return segment != nullptr && segment->menuSize.load() == menuSize
+        && segment->menuModified.load() == menuModified.time_since_epoch().count();
+}
+
+// Function to check whether the menu file, as it is now, is the one last written or published by a kiosk
+bool sharedCatalogCurrent() {
+    string path = dataPath("menu.txt"); // The menu file of the current branch
+    error_code error; // Set (instead of throwing) when the menu file does not exist
+    filesystem::file_time_type menuModified = filesystem::last_write_time(path, error);
+    uintmax_t menuSize = error ? 0 : filesystem::file_size(path, error);
+    return sharedCatalogMatches(menuModified, menuSize);
+}
+
+// Function to find the slot of an item in the shared catalog, also returning the layout epoch the slot belongs to
+// The slots are looked up again only when the items have been published since the last lookup
+// A writer only holds the sequence lock for as long as it takes to publish the items, so one that holds it for
+// SHARED_CATALOG_WAIT_MS has died while publishing: the shared catalog is then abandoned (see abandonSharedCatalog)
+// Returns -1 if the item is not in the shared catalog (or there is none, or it was just abandoned)
+int findSharedSlot(int menuIndex, uint32_t& epoch) {
+    SharedCatalogSegment* segment = sharedCatalog.segment;
+    if (segment == nullptr || segment->unusable.load() != 0)
+        return -1;
+
+    lock_guard<mutex> lock(sharedCatalog.slotLock);
+    epoch = segment->layoutEpoch.load(memory_order_acquire);
+    if (epoch != sharedCatalog.mappedEpoch) {
+        // Read where every item is now, starting again if the items were being written meanwhile
+        auto deadline = chrono::steady_clock::now() + chrono::milliseconds(SHARED_CATALOG_WAIT_MS);
+        for (;;) {
+            uint64_t sequence = segment->sequence.load(memory_order_acquire);
+            if (sequence % 2 == 0) {
+                epoch = segment->layoutEpoch.load(memory_order_relaxed);
+                int numOfItems = min(segment->numOfItems.load(memory_order_relaxed), SHARED_CATALOG_CAPACITY);
+                sharedCatalog.slotOfIndex.clear();
+                for (int slot = 0; slot < numOfItems; slot++)
+                    sharedCatalog.slotOfIndex[segment->items[slot].menuIndex.load(memory_order_relaxed)] = slot;
+                atomic_thread_fence(memory_order_acquire);
+                if (segment->sequence.load(memory_order_relaxed) == sequence)
+                    break;
+            }
+            if (chrono::steady_clock::now() > deadline) {
+                sharedCatalog.mappedEpoch = 0;
+                sharedCatalog.slotOfIndex.clear();
+                abandonSharedCatalog();
+                return -1;
+            }
+            this_thread::yield();
+        }
+        sharedCatalog.mappedEpoch = epoch;
+    }
+
+    auto found = sharedCatalog.slotOfIndex.find(menuIndex);
+    return found == sharedCatalog.slotOfIndex.end() ? -1 : found->second;
+}
+
+// Function to read the live price and name of an item from the shared catalog, so a price update shows at once
+// in every kiosk (a name that did not fit in the shared catalog is left as it is)
+// Returns false, changing nothing, if the item is not in the shared catalog
+bool readSharedItem(int menuIndex, Money& price, string& name) {
+    uint32_t epoch = 0; // Layout epoch of the slot (not needed: the slot's index number is checked instead)
+    int slot = findSharedSlot(menuIndex, epoch);
+    if (slot == -1)
+        return false;
+
+    const SharedCatalogItem& item = sharedCatalog.segment->items[slot];
+    const atomic<uint64_t>& sequence = sharedCatalog.segment->sequence;
+    int32_t slotIndex = 0; // Index number of the item in the slot
+    int64_t priceCents = 0; // Price of that item
+    int32_t nameLength = 0; // Length of its name
+    uint64_t nameWords[SHARED_NAME_SIZE / 8]; // Its name
+
+    // Copy the item's details, starting again if they were being written meanwhile (as long as the writer is alive)
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(SHARED_CATALOG_WAIT_MS);
+    for (;;) {
+        uint64_t before = sequence.load(memory_order_acquire);
+        if (before % 2 == 0) {
+            slotIndex = item.menuIndex.load(memory_order_relaxed);
+            priceCents = item.priceCents.load(memory_order_relaxed);
+            nameLength = item.nameLength.load(memory_order_relaxed);
+            for (int k = 0; k < SHARED_NAME_SIZE / 8; k++)
+                nameWords[k] = item.nameWords[k].load(memory_order_relaxed);
+            atomic_thread_fence(memory_order_acquire);
+            if (sequence.load(memory_order_relaxed) == before)
+                break;
+        }
+        if (chrono::steady_clock::now() > deadline) {
+            abandonSharedCatalog();
+            return false;
+        }
+        this_thread::yield();
+    }
+
+    if (slotIndex != menuIndex)
+        return false; // The items were published again since the slot was found
+    price.cents = priceCents;
+    if (nameLength <= SHARED_NAME_SIZE)
+        name.assign((const char*)nameWords, nameLength);
+    return true;
+}
+
+// Function to deduct the stock an order uses (by menu index) from the live counts of the shared catalog, leaving
+// the stock reserved by other carts alone. Either all of it is deducted or none: if an item runs short, the stock
+// already deducted is given back. If the items are published meanwhile, the order is tried again
+// Returns 0 on success, or the menu index of an item without enough stock
+int takeSharedStock(const unordered_map<int, int>& needs, const unordered_map<int, int>& reservedStock) {
+    SharedCatalogSegment* segment = sharedCatalog.segment;
+
+    for (;;) {
+        vector<pair<int, int>> taken; // Menu index and quantity of each item deducted so far
+        uint32_t epoch = 0; // Layout epoch of the first item; the others must belong to the same one
+        bool republished = false; // Whether the items were published again meanwhile
+        int unavailableItem = 0; // Menu index of an item without enough stock
+
+        for (const auto& need : needs) {
+            uint32_t slotEpoch = 0;
+            int slot = findSharedSlot(need.first, slotEpoch);
+            if (epoch == 0)
+                epoch = slotEpoch;
+            if (slotEpoch != epoch) {
+                republished = true;
+                break;
+            }
+            if (slot == -1) {
+                unavailableItem = need.first; // The item has been taken off the menu
+                break;
+            }
+
+            auto reserved = reservedStock.find(need.first);
+            int reservedQuantity = reserved == reservedStock.end() ? 0 : reserved->second;
+            atomic<uint64_t>& stock = segment->items[slot].stock;
+            uint64_t count = stock.load();
+            bool deducted = false;
+            while (!deducted && (uint32_t)(count >> 32) == epoch && need.second <= (int32_t)(uint32_t)count - reservedQuantity)
+                deducted = stock.compare_exchange_weak(count, count - need.second);
+            if (!deducted) {
+                if ((uint32_t)(count >> 32) != epoch)
+                    republished = true;
+                else
+                    unavailableItem = need.first;
+                break;
+            }
+            taken.push_back(need);
+        }
+
+        if (!republished && unavailableItem == 0)
+            return 0;
+
+        // Give back the stock already deducted (publishing keeps the live counts, so it is found by menu index)
+        for (const auto& item : taken) {
+            uint32_t slotEpoch = 0;
+            int slot = findSharedSlot(item.first, slotEpoch);
+            if (slot != -1)
+                segment->items[slot].stock.fetch_add(item.second);
+        }
+
+        if (!republished)
+            return unavailableItem;
+        this_thread::yield();
+    }
+}
+
+// Function to find the stock of a stocked item: its live count when it is in the shared catalog, or otherwise the
+// stock column of the menu (which is then current, as a menu is loaded again whenever its file changes)
+int itemStock(string** arrMenuContent, int row) {
+    uint32_t epoch = 0; // Layout epoch of the slot
+    int slot = findSharedSlot(stoi(arrMenuContent[row][MENU_INDEX]), epoch);
+    if (slot == -1)
+        return stoi(arrMenuContent[row][MENU_STOCK]);
+    return (int32_t)(uint32_t)sharedCatalog.segment->items[slot].stock.load();
+}
+
+// Function for a new restaurant manager to sign up, creating login credentials
+void signup(UserDetails& ud) {
+    string newUsername; // Variable to store the new username for sign up
+    bool valid = false; // Flag to indicate whether the entered credentials are valid
+
+    cout << "\n*************************** SIGN UP PAGE ***************************\n";
+    cout << "\n/// You are signing up as RESTAURANT MANAGER.\n";
+
+    // Loop until a valid username is entered
+    while (!valid) {
+        // Prompt the user to enter a new username
+        cout << "\n=> Enter new username: ";
+        newUsername = readLine();
+
+        // The username separates the fields of the credentials file, so it cannot be blank or hold a tab
+        valid = !newUsername.empty() && newUsername.find('\t') == string::npos;
+        if (!valid)
+            cout << "\n/// Please enter a username without tabs. Please try again!\n";
+
+        // If the new username matches an existing one, prompt the user to choose another one
+        else if (managerAccountExists(newUsername)) {
+            valid = false;
+            cout << "\n/// This username already exists. Please try again!\n";
+        }
+    }
+    // Prompt the user to enter a new password with a minimum length of 6 characters
+    cout << "=> Enter new password (min 6 characters): ";
+    ud.password = readLine();
+
+    // Validate the entered password length
+    while (ud.password.length() < 6) {
+        cout << "\n/// Password must be at least 6 characters!\n";
+        cout << "=> Enter new password (min 6 characters): ";
+        ud.password = readLine(); // Re-enter the password if it doesn't meet the requirements
+    }
+
+    // If the password is valid, add the account (the first account of the restaurant is its owner)
+    string role = addManagerAccount(newUsername, ud.password);
+
+    cout << "\n/// Sign up successful! Your account's role is: " << role << "\n"
+        << "/// Redirecting to login page...\n\n";
+
+    // After sign-up, automatically redirect to the login page
+    login(ud);
+}
+
+// Function to determine the action the restaurant manager would like to perform
+void getManagerAction() {
+    // A manager whose session has ended (after being left unused) must log in again
+    ManagerSession session;
+    if (!checkSession(currentSessionToken, session)) {
+        UserDetails ud;
+        cout << "\n/// Your session has ended. Please log in again.\n";
+        login(ud);
+    }
+
+    // Prompt the user to select an action from the available options, until a valid choice is entered
+    char actionChoice = promptChoice("\n=> Please select an action as RESTAURANT MANAGER: \n"
+                                     "[1] Create/update menu\n"
+                                     "[2] Update prices\n"
+                                     "[3] View stats (most popular dish, total number of customers, total sales, total number of orders)\n"
+                                     "[5] View group stats (stats of every branch side by side)\n"
+                                     "[6] View end-of-day / end-of-month sales report\n"
+                                     "[7] View kitchen display (order tickets and their status)\n"
+                                     "[8] View stock forecast (low stock and restock quantities)\n"
+                                     "\n/// Do you need help navigating the system? Select the option below! \n"
+                                     "[4] View Manager Help info\n", "12345678");
+
+    // Based on the action choice, call the appropriate function to perform the task
+    switch (actionChoice) {
+    case '1':
+        createOrUpdateMenu(); // Call function to create or update the menu
+        break;
+    case '2':
+        updatePrices(); // Call function to update prices in the menu
+        break;
+    case '3':
+        viewStats(); // Call function to view the statistics (most popular dish, sales, etc.)
+        break;
+    case '4':
+        managerHelpInfo(); // Call function to view help information for the manager
+        break;
+    case '5':
+        viewGroupStats(); // Call function to view the statistics of every branch
+        break;
+    case '6':
+        viewSalesReport(); // Call function to generate the end-of-day or end-of-month report
+        break;
+    case '7':
+        viewKitchenDisplay(); // Call function to view and dispatch the kitchen tickets
+        break;
+    case '8':
+        viewStockForecast(); // Call function to view the consumption rates and restock quantities
+        break;
+    default:
+        // This block should not be reached due to the input validation above
+        cout << "Error!\n";
+    }
+}
+
+// Function to get the customer action, either to make an order or proceed with payment
+void getCustomerAction(UserDetails& ud) {
+    // Prompt the customer to choose between ordering online or making a payment (either '1' or '2')
+    char actionChoice = promptChoice("\n=> Please select an action as CUSTOMER: \n"
+                                     "[1] Order online\n"
+                                     "[2] Make payment\n", "12");
+
+    // Based on the action choice, proceed with the appropriate function
+    switch (actionChoice) {
+    case '1':
+        orderOnline(ud); // Call the function to allow the customer to order online
+        break;
+    case '2':
+        makePayments(ud); // Call the function to allow the customer to make a payment
+        break;
+    default:
+        cout << "Error!\n"; // This should not happen due to input validation
+    }
+}
+
+// Function to display guidelines and help for the restaurant manager to use the system effectively
+void managerHelpInfo() {
+    cout << "\n********************** MANAGER HELP INFO PAGE ***********************\n";
+    cout << "\n/// You have selected the option to: View Manager Help Info\n";
+    cout << "\nWelcome to the NinjaFood Ordering System!\n"
+        << "This system enables Restaurant Managers to manage the restaurant's menu, view statistics, and perform other administrative tasks.\n";
+
+    // Description of the available options for the manager
+    cout << "\n===> Options Specifications"
+        << "\n\n[1] Create/Update Menu"
+        << "\n\t This option allows the Restaurant Manager to create a new menu or update the existing one."
+        << "\n\t The menu includes the following details for each item: "
+        << "\n\t\t 1. Item name"
+        << "\n\t\t 2. Item price"
+        << "\n\t\t 3. Preparation time (the time required to prepare the item)"
+        << "\n\t\t 4. Stock quantity (number of items available for order)"
+        << "\n\t\t 5. Category (optional, e.g. Burgers or Drinks)"
+        << "\n\t\t 6. Options (optional sizes and add-ons, each with a price difference)"
+        << "\n\t\t 7. Combo items (optional; a combo takes its stock from the items it contains)"
+
+        << "\n\n[2] Update Prices"
+        << "\n\t This option allows the Restaurant Manager to modify the price of any menu item."
+
+        << "\n\n[3] View Stats"
+        << "\n\t This option displays the restaurant's key statistics, including the following details: "
+        << "\n\t\t 1. Most popular dish"
+        << "\n\t\t 2. Total number of orders for today"
+        << "\n\t\t 3. Total sales for today"
+        << "\n\t\t 4. Total number of customers for today"
+
+        << "\n\n[5] View Group Stats"
+        << "\n\t This option displays the stats of every branch side by side, with totals for the whole group."
+        << "\n\t Each branch keeps its own menu, stock and sales. Set the NINJAFOOD_BRANCH environment variable"
+        << "\n\t to a branch ID to start the program for that branch (new branch IDs are registered automatically)."
+
+        << "\n\n[6] View Sales Report"
+        << "\n\t This option generates an end-of-day or end-of-month report of the paid orders, showing revenue:"
+        << "\n\t\t 1. By menu item"
+        << "\n\t\t 2. By hour of the day"
+        << "\n\t\t 3. By delivery area"
+        << "\n\t\t 4. From newcomers and from returning customers"
+        << "\n\t The report is also saved to a text file."
+
+        << "\n\n[7] View Kitchen Display"
+        << "\n\t Every paid order is sent to the kitchen as a numbered ticket. This option shows each ticket's status:"
+        << "\n\t QUEUED (waiting for the kitchen), COOKING, READY or DISPATCHED."
+        << "\n\t Enter the number of a READY ticket to dispatch it for delivery."
+
+        << "\n\n[8] View Stock Forecast"
+        << "\n\t This option shows how fast each item is being used up (recent orders count the most), and:"
+        << "\n\t\t 1. How many hours the available stock will last"
+        << "\n\t\t 2. The stock level at which to reorder (the stock used while a restock is delivered)"
+        << "\n\t\t 3. How much to restock to cover the next day"
+        << "\n\t Items that will run out before new stock can arrive are marked LOW, and are listed when you log in.";
+
+    // Description of the manager roles
+    cout << "\n\n===> Roles"
+        << "\n\t Every manager account has a role, set in login_credentials.txt (after the password):"
+        << "\n\t\t owner      - can use every option (the first account to sign up is the owner)"
+        << "\n\t\t supervisor - can use every option except [3], [5] and [6]"
+        << "\n\t\t staff      - can use every option except [1], [2], [3], [5] and [6]"
+        << "\n\t After logging in, your session stays open for " << SESSION_IDLE_SECONDS / 60 << " minutes after your last action,"
+        << "\n\t so you can come back from the main page without logging in again.";
+
+    // Description of the promotions file
+    cout << "\n\n===> Promotions"
+        << "\n\t Promotions are read from promotions.txt (one rule per line, lines starting with # are ignored):"
+        << "\n\t\t NEWCOMER,name,percent                      - percent off a new customer's first order"
+        << "\n\t\t LOYALTY,name,minOrders,percent             - percent off for customers with at least minOrders orders"
+        << "\n\t\t HAPPYHOUR,name,HH:MM,HH:MM,percent[,category] - percent off items ordered between the two times"
+        << "\n\t\t ITEM,name,itemNo,percent                   - percent off one menu item"
+        << "\n\t\t CATEGORY,name,category,percent             - percent off every item of a category"
+        << "\n\t\t BUYXGETY,name,itemNo,buy,free              - out of every (buy + free) units of an item, free units are free"
+        << "\n\t Each item gets its best item discount, then the best order discount applies to the rest."
+        << "\n\t Without a promotions file, new customers get 10% off their first order.";
+
+    cout << "\n=============================================================\n";
+
+    // Ask the user whether they want to continue using the program
+    continueProgram();
+}
+
+// Function to read the menu file of the current branch into a dynamically allocated 2D array
+// The function takes a reference to totalNumItems, which represents the total number of items in the menu
+string** readMenu(int& totalNumItems) {
+    return readMenuFile(dataPath("menu.txt"), totalNumItems);
+}
+
+// Function to read a menu file and store all its contents into a dynamically allocated 2D array
+// The function takes a reference to totalNumItems, which represents the total number of items in the menu
+// Each line is split into the columns listed in MENU_FIELDS; lines that do not fit the layout are skipped
+string** readMenuFile(string path, int& totalNumItems) {
+    vector<int32_t> lineItems; // Menu row of each line (not needed here)
+    return readMenuFileLines(path, totalNumItems, lineItems);
+}
+
+// Function to read a menu file as readMenuFile does, also noting the menu row of each line of the file in lineItems
+// (MENU_LINE_SKIPPED for a line that does not fit the layout, or MENU_LINE_BAD_STOCK if only its stock does not fit)
+string** readMenuFileLines(string path, int& totalNumItems, vector<int32_t>& lineItems) {
+    string line; // Variable to store each line in the menu file temporarily
+    vector<string> cells; // Menu details of every item read so far, NUM_OF_MENU_FIELDS per item
+
+    fstream file;
+    file.open(path, ios::in); // Open the menu file in read mode
+
+    // Read each line into the details of one item
+    string fields[NUM_OF_MENU_FIELDS]; // The details of the current item
+    lineItems.clear();
+    while (getline(file, line)) {
+        if (parseMenuLine(line, fields)) {
+            lineItems.push_back(cells.size() / NUM_OF_MENU_FIELDS);
+            cells.insert(cells.end(), fields, fields + NUM_OF_MENU_FIELDS);
+            continue;
+        }
+
+        // Check whether the line would fit with a valid stock
+        size_t stockStart = 0; // Start of the stock column
+        for (int column = 0; column < MENU_STOCK && stockStart != string::npos; column++) {
+            size_t comma = line.find(',', stockStart);
+            stockStart = comma == string::npos ? string::npos : comma + 1;
+        }
+        bool badStock = false; // Whether only the stock keeps the line off the menu
+        if (stockStart != string::npos) {
+            size_t stockEnd = line.find(',', stockStart);
+            badStock = parseMenuLine(line.substr(0, stockStart) + "0" + (stockEnd == string::npos ? "" : line.substr(stockEnd)), fields);
+        }
+        lineItems.push_back(badStock ? MENU_LINE_BAD_STOCK : MENU_LINE_SKIPPED);
+    }
+    file.close(); // Close the file after reading the menu
+
+    // Dynamically allocate a 2D array to store the menu details
+    totalNumItems = cells.size() / NUM_OF_MENU_FIELDS; // Update totalNumItems with the total number of menu items
+    string** arrMenuContent = new string*[totalNumItems];
+    for (int j = 0; j < totalNumItems; j++) {
+        arrMenuContent[j] = new string[NUM_OF_MENU_FIELDS]; // Each item has one detail per menu column
+        for (int k = 0; k < NUM_OF_MENU_FIELDS; k++)
+            arrMenuContent[j][k] = move(cells[j * NUM_OF_MENU_FIELDS + k]);
+    }
+
+    return arrMenuContent; // Return the 2D array containing the menu details
+}
+
+// Function to split one line of the menu file into the details of an item, following MENU_FIELDS
+// Numbers and prices are stored in their usual form (e.g. "8.00"), and optional columns missing from the end
+// of the line are left empty. Returns false if a required column is missing or a number or price is not valid
+bool parseMenuLine(string line, string* fields) {
+    size_t start = 0; // Start of the current column
+    bool lineEnded = false; // Whether every column of the line has been used
+
+    if (!line.empty() && line.back() == '\r') // Menu files edited on Windows end their lines with "\r\n"
+        line.pop_back();
+
+    for (const MenuFieldSpec& spec : MENU_FIELDS) {
+        string& value = fields[spec.field];
+        if (lineEnded) {
+            if (!spec.optional)
+                return false;
+            value.clear();
+            continue;
+        }
+
+        // The last column takes the rest of the line
+        size_t end = spec.field == NUM_OF_MENU_FIELDS - 1 ? string::npos : line.find(',', start);
+        lineEnded = end == string::npos;
+        value = line.substr(start, lineEnded ? string::npos : end - start);
+        start = end + 1;
+
+        // Check the value and store it in its usual form
+        if (spec.kind == MenuFieldKind::Integer) {
+            size_t first = value.find_first_not_of(" \t");
+            int number = 0;
+            if (first == string::npos || !parseInt(value.substr(first, value.find_last_not_of(" \t") - first + 1), number))
+                return false;
+            value = to_string(number);
+        }
+        else if (spec.kind == MenuFieldKind::Price) {
+            Money price;
+            if (!parseMoney(value, price))
+                return false;
+            value = price.str();
+        }
+    }
+    return true;
+}
+
+// Function to write the whole menu back to the menu file, replacing its previous content
+// With a shared catalog, the live stock of each item is written (whatever stock the given menu holds), under
+// the shared catalog's file lock. Without one, the stock in the menu file is copied into the given menu first,
+// under the menu file's lock, so orders paid since the menu was read keep their stock
+// Returns false (leaving the menu file as it was) if the menu could not be written
+bool writeMenu(string** arrMenuContent, int totalNumItems) {
+    bool shared = lockSharedCatalog(); // Whether the stock is taken from the shared catalog
+    int menuLock = shared ? -1 : lockMenuFile(); // The menu file's lock, without a shared catalog
+    if (!shared) {
+        int numOfFileItems = 0; // Number of items in the menu file
+        string** arrFileContent = readMenu(numOfFileItems);
+        for (int i = 0; i < totalNumItems; i++) {
+            int row = findMenuRow(arrFileContent, numOfFileItems, stoi(arrMenuContent[i][MENU_INDEX]));
+            if (row != -1)
+                arrMenuContent[i][MENU_STOCK] = arrFileContent[row][MENU_STOCK];
+        }
+        for (int i = 0; i < numOfFileItems; i++)
+            delete[] arrFileContent[i];
+        delete[] arrFileContent;
+    }
+
+    bool written = writeMenuFile(arrMenuContent, totalNumItems, shared);
+    if (shared) {
+        if (written)
+            stampSharedCatalog();
+        unlockSharedCatalog();
+    } else {
+        unlockMenuFile(menuLock);
+    }
+    return written;
+}
+
+// Function to write the live stock of the shared catalog to the menu file, along with the latest published menu
+// (a menu loaded before a price update was published would write the old price back)
+// The file is not written again if it already holds the live stock: the orders of every kiosk of the branch
+// deducted since the last write are written at once by whichever kiosk comes first, and the others find it done
+// Returns false if the menu file could not be written (the live stock stays in the shared catalog)
+bool saveSharedStock() {
+    for (;;) {
+        shared_ptr<BranchCatalog> catalog = loadBranchCatalog(currentBranchId);
+        if (!lockSharedCatalog())
+            return false;
+        bool current = catalog->sharedEpoch == sharedCatalog.segment->layoutEpoch.load() && sharedCatalogCurrent();
+        bool saved = current && sharedStockSaved(); // Whether another kiosk has written the live stock already
+        bool written = current && !saved && writeMenuFile(catalog->arrMenuContent, catalog->totalNumItems, true);
+        if (written)
+            stampSharedCatalog();
+        unlockSharedCatalog();
+        if (current)
+            return saved || written;
+    }
+}
+
+// Function to check that the stock last written to the menu file is the live stock of every item of the shared
+// catalog (the caller holds its file lock, and has checked the menu file is the one last recorded)
+bool sharedStockSaved() {
+    SharedCatalogSegment* segment = sharedCatalog.segment; // The mapped segment
+    int numOfItems = min(segment->numOfItems.load(), SHARED_CATALOG_CAPACITY); // Number of items published
+    for (int slot = 0; slot < numOfItems; slot++) {
+        if ((int32_t)(uint32_t)segment->items[slot].stock.load() != segment->items[slot].fileStock.load())
+            return false;
+    }
+    return true;
+}
+
+// Function to write a menu to the menu file, with the live stock of the shared catalog if liveStock is set
+// (the caller then holds its file lock). Each item is written as the columns listed in MENU_FIELDS
+// The menu is written to a file of its own and then renamed over the old one, so a kiosk reading the menu
+// (and a catalog still in use) always has either the old or the new menu in full, never a half-written one
+// Returns false if the new menu could not be written, in which case the old one is left in place
+bool writeMenuFile(string** arrMenuContent, int totalNumItems, bool liveStock) {
+    string out; // The new menu file
+    vector<pair<int, int>> writtenStock; // Shared catalog slot and stock written, of each item with live stock
+
+    // Loop through the menu and add each item's details to the file
+    for (int j = 0; j < totalNumItems; j++) {
+        uint32_t epoch = 0; // Layout epoch of the item's slot
+        int slot = liveStock ? findSharedSlot(stoi(arrMenuContent[j][MENU_INDEX]), epoch) : -1;
+        if (slot == -1) {
+            out += formatMenuLine(arrMenuContent[j]) + "\n";
+            continue;
+        }
+
+        SharedCatalogItem& item = sharedCatalog.segment->items[slot];
+        string fields[NUM_OF_MENU_FIELDS]; // The item's details, with its live stock
+        copy(arrMenuContent[j], arrMenuContent[j] + NUM_OF_MENU_FIELDS, fields);
+        int stock = (int32_t)(uint32_t)item.stock.load();
+        fields[MENU_STOCK] = to_string(stock);
+        writtenStock.push_back({slot, stock});
+        out += formatMenuLine(fields) + "\n";
+    }
+
+    // Put the new menu in place of the old one in one step
+    if (!replaceFile(dataPath("menu.txt"), out))
+        return false;
+
+    // Remember the stock written, so a stock changed in the file by hand can be told apart
+    for (const auto& written : writtenStock)
+        sharedCatalog.segment->items[written.first].fileStock.store(written.second);
+    return true;
+}
+
+// Function to take the file lock of the menu file when the branch has no shared catalog (whose file lock is used
+// otherwise). It is held while the menu file is read, changed and written back, so kiosks paying at the same time
+// never write over each other's stock. Returns the descriptor to pass to unlockMenuFile (-1 where file locks are
+// not available)
+int lockMenuFile() {
+    int descriptor = -1; // The lock file
+#ifndef _WIN32
+    descriptor = open(dataPath("menu.lock").c_str(), O_RDWR | O_CREAT, 0644);
+    if (descriptor >= 0)
+        flock(descriptor, LOCK_EX);
+#endif
+    return descriptor;
+}
+
+// Function to release the file lock of the menu file
+void unlockMenuFile(int descriptor) {
+#ifndef _WIN32
+    if (descriptor >= 0)
+        close(descriptor); // Closing the lock file releases the lock
+#endif
+}
+
+// Function to join the details of an item into one line of the menu file, following MENU_FIELDS
+// The optional columns are only written up to the last one the item uses, so plain menus keep their original layout
+string formatMenuLine(const string* fields) {
+    int lastField = 0; // The last column to write
+    for (const MenuFieldSpec& spec : MENU_FIELDS) {
+        if (!spec.optional || !fields[spec.field].empty())
+            lastField = spec.field;
+    }
+
+    string line;
+    for (int i = 0; i <= lastField; i++) {
+        if (i != 0)
+            line += ",";
+        line += fields[MENU_FIELDS[i].field];
+    }
+    return line;
+}
+
+// Function to find the row of the menu array holding the item with the given index number
+// Returns -1 if no item has that index number
+int findMenuRow(string** arrMenuContent, int totalNumItems, int menuIndex) {
+    for (int i = 0; i < totalNumItems; i++) {
+        if (stoi(arrMenuContent[i][MENU_INDEX]) == menuIndex)
+            return i;
+    }
+    return -1;
+}
+
+// Function to parse the option modifiers column of a menu item
+// Format: Kind:Name:PriceDelta entries separated by ';' (e.g. "S:Regular:0;S:Large:1.50;A:Cheese:0.80")
+// where kind S is a size (the customer picks exactly one) and kind A is an add-on (the customer picks any)
+// Returns false if the text is not in this format
+bool parseModifiers(string text, vector<MenuModifier>& modifiers) {
+    string entry; // One Kind:Name:PriceDelta entry
+    int count = 0; // Number of modifiers parsed for this item
+
+    if (text.find(',') != string::npos) // Commas separate the menu columns, so they cannot appear here
+        return false;
+
+    stringstream entries(text);
+    while (getline(entries, entry, ';')) {
+        if (entry.empty())
+            continue;
+
+        size_t firstColon = entry.find(':'); // End of the kind
+        size_t secondColon = entry.find(':', firstColon + 1); // End of the name
+        if (firstColon != 1 || secondColon == string::npos || secondColon == firstColon + 1)
+            return false;
+
+        MenuModifier modifier;
+        modifier.kind = toupper((unsigned char)entry[0]);
+        modifier.name = entry.substr(firstColon + 1, secondColon - firstColon - 1);
+
+        // Convert the price difference, making sure the whole remaining text is a number
+        string strDelta = entry.substr(secondColon + 1);
+        if ((modifier.kind != 'S' && modifier.kind != 'A') || !parseMoney(strDelta, modifier.priceDelta))
+            return false;
+
+        if (++count > MAX_ITEM_MODIFIERS)
+            return false;
+        modifiers.push_back(modifier);
+    }
+    return true;
+}
+
+// Function to parse the combo components column of a menu item
+// Format: ItemNo:Quantity entries separated by ';' (e.g. "1:1;4:2" is one of item 1 and two of item 4)
+// A component must be an existing item that is not a combo itself; repeated items are merged
+// Returns false if the text is not in this format
+bool parseComboComponents(string text, string** arrMenuContent, int totalNumItems, vector<ComboComponent>& components) {
+    string entry; // One ItemNo:Quantity entry
+    size_t firstComponent = components.size(); // Components of this item start here
+
+    if (text.find(',') != string::npos) // Commas separate the menu columns, so they cannot appear here
+        return false;
+
+    stringstream entries(text);
+    while (getline(entries, entry, ';')) {
+        if (entry.empty())
+            continue;
+
+        size_t colon = entry.find(':');
+        if (colon == string::npos)
+            return false;
+
+        char* endIndex = nullptr;
+        char* endQuantity = nullptr;
+        long menuIndex = strtol(entry.substr(0, colon).c_str(), &endIndex, 10);
+        long quantity = strtol(entry.c_str() + colon + 1, &endQuantity, 10);
+        if (*endIndex != '\0' || *endQuantity != '\0' || colon == 0 || colon + 1 == entry.length() || quantity < 1)
+            return false;
+
+        // The component must exist and must not be a combo itself
+        int row = findMenuRow(arrMenuContent, totalNumItems, menuIndex);
+        if (row == -1 || !arrMenuContent[row][MENU_COMPONENTS].empty())
+            return false;
+
+        // Merge repeated items so each component appears once with its total quantity
+        bool merged = false;
+        for (size_t k = firstComponent; k < components.size(); k++) {
+            if (components[k].row == row) {
+                components[k].quantity += quantity;
+                merged = true;
+                break;
+            }
+        }
+        if (!merged)
+            components.push_back({ row, (int)quantity });
+    }
+    return true;
+}
+
+// Function to build the categories, option modifiers and combo components of the whole menu
+void buildMenuModel(string** arrMenuContent, int totalNumItems, MenuModel& model) {
+    model.categories.assign(1, ""); // Category 0 is used by items without a category
+    model.itemCategory.assign(totalNumItems, 0);
+    model.modifiers.clear();
+    model.modifierStart.assign(1, 0);
+    model.components.clear();
+    model.componentStart.assign(1, 0);
+
+    for (int i = 0; i < totalNumItems; i++) {
+        // Look up the category of the item, adding it if it has not been seen before
+        string category = arrMenuContent[i][MENU_CATEGORY];
+        if (!category.empty()) {
+            size_t c = find(model.categories.begin(), model.categories.end(), category) - model.categories.begin();
+            if (c == model.categories.size())
+                model.categories.push_back(category);
+            model.itemCategory[i] = c;
+        }
+
+        // Add the item's modifiers and combo components (a malformed column is treated as empty)
+        size_t modifiersBefore = model.modifiers.size();
+        if (!parseModifiers(arrMenuContent[i][MENU_MODIFIERS], model.modifiers))
+            model.modifiers.resize(modifiersBefore);
+        model.modifierStart.push_back(model.modifiers.size());
+
+        size_t componentsBefore = model.components.size();
+        if (!parseComboComponents(arrMenuContent[i][MENU_COMPONENTS], arrMenuContent, totalNumItems, model.components))
+            model.components.resize(componentsBefore);
+        model.componentStart.push_back(model.components.size());
+    }
+}
+
+// Function to find the stock available for a menu item (stock reserved by unpaid carts is not available)
+// A combo has no stock of its own: it is limited by whichever component item runs out first
+int availableStock(string** arrMenuContent, const MenuModel& model, int row) {
+    uint32_t first = model.componentStart[row]; // First combo component of the item
+    uint32_t last = model.componentStart[row + 1]; // End of the item's combo components
+
+    if (first == last) // Not a combo: use the item's own stock
+        return max(itemStock(arrMenuContent, row) - reservedQuantity(stoi(arrMenuContent[row][MENU_INDEX])), 0);
+
+    int stock = -1;
+    for (uint32_t k = first; k < last; k++) {
+        int componentRow = model.components[k].row; // Menu row of the component item
+        int componentStock = (itemStock(arrMenuContent, componentRow) - reservedQuantity(stoi(arrMenuContent[componentRow][MENU_INDEX])))
+                           / model.components[k].quantity;
+        if (stock == -1 || componentStock < stock)
+            stock = componentStock;
+    }
+    return max(stock, 0);
+}
+
+// Function to find the unit price of an item including the options chosen by the customer
+// The base price is taken from the version of the prices the cart is pinned to, so a price update made while
+// the customer is ordering never leaves the order priced partly at the old prices and partly at the new ones
+Money orderLinePrice(const PriceSnapshot& prices, string** arrMenuContent, const MenuModel& model, int row, int modifierMask) {
+    Money price; // Unit price of the item with its options
+
+    // Start from the base price of the item
+    if (!snapshotPrice(prices, stoi(arrMenuContent[row][MENU_INDEX]), price))
+        parseMoney(arrMenuContent[row][MENU_PRICE], price);
+
+    for (uint32_t k = model.modifierStart[row]; k < model.modifierStart[row + 1]; k++) {
+        if (modifierMask & (1 << (k - model.modifierStart[row])))
+            price += model.modifiers[k].priceDelta; // Add the price of each chosen option
+    }
+    return price;
+}
+
+// Function to price the lines of a customer's cart for payment, at the version of the prices the cart is pinned to
+// (a price update published while the customer was ordering or paying is not charged). An item taken off the menu
+// since it was ordered keeps the price it was quoted at; the order is turned down when its stock is deducted
+vector<CartLine> priceReceiptLines(const vector<ReceiptLine>& cart, const PriceSnapshot& prices, const BranchCatalog& catalog) {
+    vector<CartLine> cartLines; // The lines, as priced
+    for (const ReceiptLine& line : cart) {
+        int row = findMenuRow(catalog.arrMenuContent, catalog.totalNumItems, line.menuIndex);
+        Money unitPrice = row == -1 ? line.itemPrice : orderLinePrice(prices, catalog.arrMenuContent, catalog.model, row, line.modifierMask);
+        cartLines.push_back({row, unitPrice, line.quantity});
+    }
+    return cartLines;
+}
+
+// Function to describe an item including the options chosen by the customer, e.g. "Burger (Large + Cheese)"
+string orderLineName(string** arrMenuContent, const MenuModel& model, int row, int modifierMask) {
+    string name = arrMenuContent[row][MENU_NAME]; // Start from the item name
+    string options; // Names of the chosen options
+    Money price; // Price of the item (not needed)
+    readSharedItem(stoi(arrMenuContent[row][MENU_INDEX]), price, name); // The live name, when the kiosks share a catalog
+
+    for (uint32_t k = model.modifierStart[row]; k < model.modifierStart[row + 1]; k++) {
+        if (modifierMask & (1 << (k - model.modifierStart[row])))
+            options += (options.empty() ? "" : " + ") + model.modifiers[k].name; // No commas: they separate receipt columns
+    }
+    if (!options.empty())
+        name += " (" + options + ")";
+    return name;
+}
+
+// Manager function to allow the restaurant manager to create or update the menu
+void createOrUpdateMenu() {
+    int numbering = 1; // Integer variable to track the sequence number for menu items
+    char choice = 'Y'; // Variable to store the user's choice for whether they wish to continue adding/updating menu items
+    string itemName; // String variable to hold the name of the food item
+    string line; // Temporary string to store each line from the file
+    Money itemPrice; // Variable to store the price of the food item
+    string strItemPrice; // Price of the food item as entered by the manager
+    int preparationTime = 0; // Integer variable to store the preparation time of the food item (in minutes)
+    int stock = 0; // Integer variable to store the available stock quantity of the item
+    string category; // Category of the item (optional)
+    string modifiersText; // Option modifiers of the item (optional)
+    string componentsText; // Combo components of the item (optional)
+    string fields[NUM_OF_MENU_FIELDS]; // The details of the item, as written to the menu file
+
+    // Only managers whose role allows it may change the menu
+    if (!requirePermission(PERMISSION_EDIT_MENU, "create or update the menu")) {
+        continueProgram();
+        return;
+    }
+
+    cout << "\n*********************** CREATE/UPDATE MENU PAGE ***********************\n";
+    cout << "\n/// You have selected the option to: Update/Create Menu\n";
+
+    // Retrieve the current menu index by displaying the existing menu
+    int index = displayMenu();
+    numbering = ++index; // Increment the index to start numbering new items
+
+    if (index == 0) // Check if the menu file is empty
+        cout << "/// Menu does not exist. Creating menu...\n"; // Inform user that a new menu will be created
+
+    // Loop to allow the manager to add/update items until they choose to stop
+    while (choice == 'Y' || choice == 'y') {
+        cout << "\n=> Enter name of item #" << numbering << ": "; // Prompt for the name of the new food item
+        itemName = readLine(); // Get the item name from the user input
+
+        // Validate the item name - it should not be empty, too long, or already exist in the menu
+        while (itemName.empty() || itemName == " " || itemName.length() >= 25 || itemAlreadyExists(itemName)) {
+            if (itemName.empty() || itemName == " ") {
+                cout << "/// Item name cannot be empty!\n"; // Error if the name is empty
+            }
+            else if (itemName.length() >= 25) {
+                cout << "/// Item name cannot be more than 25 characters! Please try again.\n"; // Error if the name is too long
+            }
+            else {
+                cout << "\n/// This item already exists in the menu!";
+                cout << "\n/// Please consider the \"Update Prices\" option for this item instead.\n"; // Error if the item already exists
+            }
+
+            cout << "\n=> Enter name of item #" << numbering << ": "; // Prompt to re-enter the item name
+            itemName = readLine(); // Get the item name again
+        }
+        fields[MENU_INDEX] = to_string(numbering);
+        fields[MENU_NAME] = itemName;
+
+        cout << "=> Enter price of item #" << numbering << ": $"; // Prompt for the item price
+        strItemPrice = readToken();
+        // Validate the price - it must be a number with at most two decimals and greater than zero
+        while (!parseMoney(strItemPrice, itemPrice) || itemPrice <= Money{0}) {
+            cout << "\n/// Item price must be an amount greater than zero, e.g. 12.50! Please try again.\n";
+            cout << "=> Enter price of item #" << numbering << ": $"; // Prompt to re-enter the price
+            strItemPrice = readToken();
+        }
+        fields[MENU_PRICE] = itemPrice.str(); // The price with two decimal places
+
+        cout << "=> Enter preparation time of item #" << numbering << " (in minutes): "; // Prompt for preparation time
+        // Validate the preparation time - it must be a whole number greater than zero
+        while (!readInt(preparationTime) || preparationTime <= 0) {
+            cout << "\n/// Preparation time must be a whole number greater than zero! Please try again.\n";
+            cout << "=> Enter preparation time of item #" << numbering << " (in minutes): "; // Prompt to re-enter the preparation time
+        }
+        fields[MENU_PREP_TIME] = to_string(preparationTime);
+
+        cout << "=> Enter category of item #" << numbering << " (leave blank for none): "; // Prompt for the category
+        category = readLine();
+        // Validate the category - it cannot contain commas or be too long
+        while (category.find(',') != string::npos || category.length() >= 25) {
+            cout << "\n/// Category cannot contain commas or be more than 25 characters! Please try again.\n";
+            cout << "=> Enter category of item #" << numbering << " (leave blank for none): ";
+            category = readLine();
+        }
+
+        // Prompt for the option modifiers (sizes and add-ons with their price differences)
+        vector<MenuModifier> modifiers;
+        cout << "=> Enter options of item #" << numbering << " as Kind:Name:Price separated by ';'"
+             << "\n   (S = size, customer picks one; A = add-on, customer picks any; e.g. S:Regular:0;S:Large:1.50;A:Cheese:0.80)"
+             << "\n   Leave blank for none: ";
+        modifiersText = readLine();
+        // Validate the options - they must follow the format above
+        while (!parseModifiers(modifiersText, modifiers)) {
+            modifiers.clear();
+            cout << "\n/// Invalid options (at most " << MAX_ITEM_MODIFIERS << ", in the format Kind:Name:Price)! Please try again.\n";
+            cout << "=> Enter options of item #" << numbering << " (leave blank for none): ";
+            modifiersText = readLine();
+        }
+
+        // Prompt for the combo components (the existing items a combo meal is made of)
+        int totalNumItems = 0;
+        string** arrMenuContent = readMenu(totalNumItems);
+        vector<ComboComponent> components;
+        cout << "=> If item #" << numbering << " is a combo, enter its items as ItemNo:Quantity separated by ';'"
+             << "\n   (e.g. 1:1;4:2) or leave blank if it is not a combo: ";
+        componentsText = readLine();
+        // Validate the components - they must be existing items that are not combos themselves
+        while (!parseComboComponents(componentsText, arrMenuContent, totalNumItems, components)) {
+            components.clear();
+            cout << "\n/// Invalid combo items (each must be an existing item that is not a combo)! Please try again.\n";
+            cout << "=> Enter combo items of item #" << numbering << " (leave blank if it is not a combo): ";
+            componentsText = readLine();
+        }
+        for (int i = 0; i < totalNumItems; i++)
+            delete[] arrMenuContent[i];
+        delete[] arrMenuContent;
+
+        if (!components.empty()) {
+            // A combo has no stock of its own; it draws stock from its component items
+            stock = 0;
+            cout << "/// Item #" << numbering << " is a combo. Its stock is taken from the items it contains.\n";
+        } else {
+            cout << "=> Enter stock quantity of item #" << numbering << " : "; // Prompt for the stock quantity
+            // Validate the stock quantity - it must be a whole number greater than zero
+            while (!readInt(stock) || stock <= 0) {
+                cout << "\n/// Stock quantity must be a whole number greater than zero! Please try again.\n";
+                cout << "=> Enter stock quantity of item #" << numbering << " : "; // Prompt to re-enter the stock quantity
+            }
+        }
+        fields[MENU_STOCK] = to_string(stock);
+        fields[MENU_CATEGORY] = category;
+        fields[MENU_MODIFIERS] = modifiersText;
+        fields[MENU_COMPONENTS] = componentsText;
+
+        // Append the item to the menu file (the optional columns only up to the last one the item uses)
+        // The file is opened for each item, under the shared catalog's file lock, because a kiosk writing back its
+        // stock puts a new menu file in place of the old one: an append to a file kept open would be lost
+        bool shared = lockSharedCatalog(); // Whether other kiosks are kept from replacing the file meanwhile
+        int menuLock = shared ? -1 : lockMenuFile(); // The menu file's lock, without a shared catalog
+        ofstream file(dataPath("menu.txt"), ios::app);
+        file << formatMenuLine(fields) << "\n";
+        file.close(); // Make the new item visible to later checks (e.g. as a combo component)
+        if (shared)
+            unlockSharedCatalog();
+        else
+            unlockMenuFile(menuLock);
+
+        // Announce the new item in the event stream
+        vector<EventRecord> events;
+        addEvent(events, EVENT_ITEM_ADDED, 0, numbering, stock, itemPrice.cents);
+        queueEvents(events);
+
+        // Ask if the manager wants to continue adding more items to the menu
+        cout << "=> Do you wish to continue? [Y/N] "; // Prompt for continuation choice
+        choice = readChoice();
+
+        // Validate the user's choice for continuation
+        while (choice != 'Y' && choice != 'y' && choice != 'N' && choice != 'n') {
+            cout << "\n/// Sorry, that is not a valid selection. Please try again!";
+            cout << "\n=> Do you wish to continue? [Y/N] "; // Prompt again if the input is invalid
+            choice = readChoice();
+        }
+
+        ++numbering; // Increment the item numbering for the next item
+    }
+
+    cout << "\n/// Displaying updated menu...\n";
+    displayMenu(); // Display the updated menu to the manager
+
+    // Ask the manager if they want to continue using the system
+    continueProgram(); // Proceed with the next action in the program
+}
+
+// Function to allow the restaurant manager to update the prices of menu items
+void updatePrices() {
+    int index = 0; // Index variable to store the menu item's index
+    int userIndex = 0; // Variable to store the user's input for selecting an item by its index
+    int totalNumItems = 0; // Variable to store the total number of items in the menu
+    int updatedRow = -1; // Row of the menu array holding the item whose price is updated
+    string itemName; // Variable to store the name of the menu item
+    string strOldPrice; // Variable to store the old price of the item as a string
+    Money oldPrice; // Variable to store the old price of the item
+    string strNewPrice; // Variable to store the new price of the item as a string
+    Money newPrice; // Variable to store the new price of the item
+    char choice = 'Y'; // Variable to determine whether the manager wants to continue updating prices
+    vector<EventRecord> priceEvents; // Price change to announce in the event stream
+
+    // Only managers whose role allows it may change prices
+    if (!requirePermission(PERMISSION_EDIT_PRICES, "update prices")) {
+        continueProgram();
+        return;
+    }
+
+    // Read the current menu into a 2D array and retrieve the total number of items
+    string** arrMenuContent = readMenu(totalNumItems);
+
+    cout << "\n**************************** UPDATE PRICES ****************************\n";
+    cout << "\n/// You have selected the option to: Update Prices\n";
+
+    // Display the current menu to the manager
+    displayMenu();
+
+    // Build the item name search index and menu model so the manager can search the menu quickly
+    MenuSearchIndex searchIndex;
+    buildMenuSearchIndex(arrMenuContent, totalNumItems, searchIndex);
+    MenuModel model;
+    buildMenuModel(arrMenuContent, totalNumItems, model);
+
+    // If the menu file doesn't exist or is empty, prompt the manager to create a menu first
+    if (totalNumItems == 0) {
+        cout << "/// Menu not found! Please create the menu first and try again.\n";
+        cout << "/// Redirecting to Create/Update Menu...\n";
+        createOrUpdateMenu(); // Redirect to menu creation if menu doesn't exist
+    } else {
+        // Proceed if the menu exists and contains items
+        while (choice == 'Y' || choice == 'y') {
+            // (the manager may page through or search the menu before choosing)
+            userIndex = browseMenu(arrMenuContent, totalNumItems, model, searchIndex, "Please enter the index of the item to update the price");
+
+            // Iterate through the menu and find the selected item to update its price
+            for (int i = 0; i < totalNumItems; i++) {
+                index = stoi(arrMenuContent[i][MENU_INDEX]); // Get the index of the current item
+                if (index == userIndex) { // If item matches the user's selection
+                    itemName = arrMenuContent[i][MENU_NAME]; // Get the item name
+                    strOldPrice = arrMenuContent[i][MENU_PRICE]; // Get the old price as a string
+                    parseMoney(strOldPrice, oldPrice); // Convert the old price to cents
+                    cout << "\n/// Current price for " << itemName << ": $" << oldPrice;
+                    cout << "\n=> Please enter the new price for " << itemName << ": $";
+                    strNewPrice = readToken(); // Get the new price from the user
+
+                    // Validate that the new price is valid (an amount, not equal to the old price or non-positive)
+                    while (!parseMoney(strNewPrice, newPrice) || newPrice == oldPrice || newPrice <= Money{0}) {
+                        if (!parseMoney(strNewPrice, newPrice)) {
+                            cout << "\n/// New price must be an amount with at most two decimals, e.g. 12.50!\n";
+                            cout << "=> Please enter the new price for " << itemName << ": $";
+                            strNewPrice = readToken();
+                        } else if (newPrice == oldPrice) {
+                            cout << "\n/// New price cannot be equal to the old price!\n";
+                            cout << "=> Please enter the new price for " << itemName << ": $";
+                            strNewPrice = readToken();
+                        } else {
+                            cout << "\n/// New price cannot be less than or equal to zero!\n";
+                            cout << "=> Please enter the new price for " << itemName << ": $";
+                            strNewPrice = readToken();
+                        }
+                    }
+
+                    // Store the new price as a string (with two decimals) in the menu content
+                    strNewPrice = newPrice.str();
+                    arrMenuContent[i][MENU_PRICE] = strNewPrice; // Update the price in the array
+                    addEvent(priceEvents, EVENT_PRICE_CHANGED, 0, index, 0, newPrice.cents);
+                    updatedRow = i;
+                    break;
+                }
+            }
+
+            // Update the file with the modified menu data, and show the new price in every kiosk at once
+            if (writeMenu(arrMenuContent, totalNumItems)) {
+                syncSharedCatalog(true);
+                queueEvents(priceEvents);
+
+                cout << "\n/// Displaying updated menu...\n";
+                displayMenu(); // Display the updated menu to the manager
+            } else {
+                // The menu file still has the old price, so keep it in the array too
+                arrMenuContent[updatedRow][MENU_PRICE] = strOldPrice;
+                cout << "\n/// Sorry, the new price of " << itemName << " could not be saved to the menu file ("
+                     << strerror(errno) << "). The price is still $" << oldPrice << ".\n";
+            }
+            priceEvents.clear();
+
+            // Ask the manager if they want to continue updating prices for other items
+            cout << "\n=> Do you wish to continue updating prices? [Y/N] ";
+            choice = readChoice();
+
+            // Validate the user's choice for continuation
+            while (choice != 'Y' && choice != 'y' && choice != 'N' && choice != 'n') {
+                cout << "\n/// Sorry, that is not a valid selection. Please try again!";
+                cout << "\n=> Do you wish to continue updating prices? [Y/N] ";
+                choice = readChoice();
+            }
+        }
+    }
+
+    // Release the dynamically allocated memory for the menu array
+    for (int i = 0; i < totalNumItems; i++)
+        delete[] arrMenuContent[i];
+    delete[] arrMenuContent;
+
+    // Ask the manager whether they want to continue using the program
+    continueProgram(); // Proceed with the next action in the program
+}
+
+// Function to display restaurant statistics: top dish, total sales, and customer count
+void viewStats() {
+    // Only managers whose role allows it may see the restaurant's figures
+    if (!requirePermission(PERMISSION_VIEW_STATS, "view stats")) {
+        continueProgram();
+        return;
+    }
+
+    // Calculate the statistics of the current branch
+    BranchStats stats = computeBranchStats(currentBranchId);
+
+    cout << "\n**************************** VIEW STATS ****************************\n";
+
+    cout << "\n/// You have selected the option to: View Stats\n";
+
+    // If no data exists in the top dish file, show a message and exit
+    if (stats.numOfDishOrders == 0) {
+        cout << "\n/// Stats not available. \n/// Reason: No orders have been made yet.\n"
+             << "/// Please wait for a customer to order first, then try again!\n";
+    } else {
+        // If the menu is empty, prompt the user to create a menu first
+        if (stats.totalNumItems == 0) {
+            cout << "/// Menu not found! Please create the menu first and try again.\n";
+            cout << "/// Redirecting to Create/Update Menu...";
+            createOrUpdateMenu();
+        } else if (!stats.topDishName.empty()) {
+            // Display information about the most popular dish
+            cout << "\n1. MOST POPULAR DISH OF NINJAFOOD: \n";
+            cout << "===> " << left << setw(20) << stats.topDishName
+                 << "$" << setw(5) << stats.topDishPrice
+                 << "\t\tTotal orders: " << stats.maxQuantity
+                 << "\tTotal profit: " << "$" << setw(5) << stats.topDishPrice * stats.maxQuantity << "\n";
+        }
+
+        // Display the statistics: total orders, total sales, and number of customers
+        cout << "\n2. TOTAL ORDERS TODAY: " << stats.totalOrders;
+        cout << "\n3. TOTAL SALES TODAY: $" << stats.totalSales;
+        cout << "\n4. TOTAL NUMBER OF CUSTOMERS TODAY: " << stats.numOfCustomers << "\n";
+
+        // Display the repeat customer statistics from the customer profiles
+        if (stats.numOfProfiles > 0) {
+            cout << "\n5. REPEAT CUSTOMERS: " << stats.numOfRepeatCustomers << " of " << stats.numOfProfiles
+                 << " customers (" << stats.numOfRepeatCustomers * 100 / stats.numOfProfiles << "%)";
+            cout << "\n6. AVERAGE SPEND PER CUSTOMER: $" << Money{stats.lifetimeSpend.cents / stats.numOfProfiles};
+            cout << "\n7. TOP CUSTOMER: " << stats.topCustomerName << " - $" << stats.topCustomerSpend
+                 << " over " << stats.topCustomerVisits << " order(s), favourite item #" << stats.topCustomerFavourite << "\n";
+        }
+    }
+
+    // Ask the user whether they want to continue using the program
+    continueProgram(); // Proceed with the next step in the program
+}
+
+// Function to calculate the key statistics (top dish, total sales, customer count) of one branch
+// Only reads the given branch's files, so several branches can be calculated at the same time
+BranchStats computeBranchStats(string branchId) {
+    BranchStats stats; // The statistics being calculated
+    StatsSnapshot snapshot; // Totals of the top dish and total sales logs
+
+    stats.branchId = branchId;
+    flushWrites(); // Include the orders this program has paid for but not written yet
+
+    // Start from the snapshot of the logs and add the lines written since (the snapshot is kept up to
+    // date in the background, so only a short part of each log is read however old the branch is)
+    int statsLock = lockStatsSnapshot(branchId, false);
+    loadStatsSnapshot(branchPath(branchId, "stats_snapshot.txt"), snapshot);
+    foldStatsLogs(branchId, snapshot);
+    unlockStatsSnapshot(statsLock);
+    stats.numOfDishOrders = snapshot.numOfDishOrders;
+
+    // Find the most popular dish by looking for the dish with the highest order quantity
+    for (int dish : snapshot.dishOrder) {
+        if (snapshot.dishQuantity[dish] > stats.maxQuantity) {
+            stats.maxQuantity = snapshot.dishQuantity[dish]; // Update maximum quantity
+            stats.topDishIndex = dish; // Set the index of the most popular dish
+        }
+    }
+
+    // Look up the name and price of the most popular dish in the branch's menu
+    shared_ptr<BranchCatalog> catalog = loadBranchCatalog(branchId);
+    stats.totalNumItems = catalog->totalNumItems;
+    int row = findMenuRow(catalog->arrMenuContent, catalog->totalNumItems, stats.topDishIndex);
+    if (row != -1) {
+        stats.topDishName = catalog->arrMenuContent[row][MENU_NAME];
+        parseMoney(catalog->arrMenuContent[row][MENU_PRICE], stats.topDishPrice);
+    }
+
+    // Take the total sales and customer count from the snapshot
+    stats.totalOrders = snapshot.totalOrders;
+    stats.totalSales = snapshot.totalSales;
+    stats.numOfCustomers = snapshot.numOfCustomers;
+
+    // Summarise the customer profiles (read in one go; no order history is scanned)
+    vector<CustomerProfile> profiles;
+    readCustomerProfiles(branchPath(branchId, "customer_profiles.dat"), profiles);
+    const CustomerProfile* topCustomer = nullptr;
+    for (const CustomerProfile& profile : profiles) {
+        ++stats.numOfProfiles;
+        stats.numOfRepeatCustomers += profile.visitCount > 1;
+        stats.lifetimeSpend += Money{profile.lifetimeSpend};
+        if (topCustomer == nullptr || profile.lifetimeSpend > topCustomer->lifetimeSpend)
+            topCustomer = &profile;
+    }
+    if (topCustomer != nullptr) {
+        stats.topCustomerName = readCustomerName(branchPath(branchId, "customer_names.dat"), *topCustomer);
+        stats.topCustomerSpend = Money{topCustomer->lifetimeSpend};
+        stats.topCustomerVisits = topCustomer->visitCount;
+        stats.topCustomerFavourite = topCustomer->favouriteItem;
+    }
+
+    return stats; // Return the statistics of the branch
+}
+
+// Function to read the stats snapshot of a branch; returns false (leaving it empty) if there is none
+bool loadStatsSnapshot(string path, StatsSnapshot& snapshot) {
+    ifstream file(path);
+    string name; // Name of the value on the current line
+    long long totalSalesCents = 0; // Total sales, as written in the file
+
+    snapshot = StatsSnapshot();
+    if (!file)
+        return false;
+
+    while (file >> name) {
+        if (name == "topdish")
+            file >> snapshot.topdish.offset >> snapshot.numOfDishOrders >> snapshot.topdish.file >> snapshot.topdish.nextFile;
+        else if (name == "sales") {
+            file >> snapshot.sales.offset >> snapshot.totalOrders >> totalSalesCents >> snapshot.numOfCustomers
+                 >> snapshot.sales.file >> snapshot.sales.nextFile;
+            snapshot.totalSales = Money{totalSalesCents};
+        }
+        else if (name == "dish") {
+            int menuIndex = 0;
+            int quantity = 0;
+            file >> menuIndex >> quantity;
+            snapshot.dishOrder.push_back(menuIndex);
+            snapshot.dishQuantity[menuIndex] = quantity;
+        }
+    }
+
+    // A damaged snapshot is ignored, and the logs are read from the start again
+    if (file.bad() || !file.eof()) {
+        snapshot = StatsSnapshot();
+        return false;
+    }
+    return true;
+}
+
+// Function to write the stats snapshot of a branch
+// The snapshot is written to a file of its own and then renamed over the old one, so a reader
+// always sees either the old or the new snapshot in full. Returns false if it could not be written
+bool saveStatsSnapshot(string path, const StatsSnapshot& snapshot) {
+    ostringstream out; // The snapshot being written
+
+    out << "topdish " << snapshot.topdish.offset << " " << snapshot.numOfDishOrders << " "
+        << snapshot.topdish.file << " " << snapshot.topdish.nextFile << "\n";
+    out << "sales " << snapshot.sales.offset << " " << snapshot.totalOrders << " "
+        << (long long)snapshot.totalSales.cents << " " << snapshot.numOfCustomers << " "
+        << snapshot.sales.file << " " << snapshot.sales.nextFile << "\n";
+    for (int dish : snapshot.dishOrder)
+        out << "dish " << dish << " " << snapshot.dishQuantity.at(dish) << "\n";
+    return replaceFile(path, out.str());
+}
+
+// Function to take the lock of a branch's stats snapshot, shared by the readers of the snapshot and its logs and
+// held alone by the compaction job, which saves the snapshot and starts the logs again. It locks out the other
+// threads of this process and the other kiosk processes. Returns the descriptor to pass to unlockStatsSnapshot
+// (-1 if there is no lock, where file locks are not available)
+int lockStatsSnapshot(string branchId, bool exclusive) {
+#ifndef _WIN32
+    int descriptor = open(branchPath(branchId, "stats_snapshot.lock").c_str(), O_RDWR | O_CREAT, 0644);
+    if (descriptor >= 0)
+        flock(descriptor, exclusive ? LOCK_EX : LOCK_SH);
+    return descriptor;
+#else
+    return -1;
+#endif
+}
+
+// Function to release the lock of a branch's stats snapshot
+void unlockStatsSnapshot(int descriptor) {
+#ifndef _WIN32
+    if (descriptor >= 0)
+        close(descriptor); // Closing the lock file releases the lock
+#endif
+}
+
+// Function to read the complete lines added to a log file since the given position, moving the position past them
+// A line still being written (without its newline yet) is left for next time. A log started again since (the
+// position's next file) is read from its start. If the file is now shorter than the offset, or another file has
+// been put in its place, it has been replaced, and the offset is set to ~0 so the caller starts again
+string readLogTail(string path, LogPosition& position) {
+    uint64_t fileNumber = logFileNumber(path); // The log now at the path
+    ifstream file(path, ios::binary);
+    string tail; // The lines added since the position
+
+    if (position.file != 0 && fileNumber != 0 && fileNumber != position.file) {
+        if (fileNumber != position.nextFile) {
+            position.offset = ~(uint64_t)0;
+            return tail;
+        }
+        position = LogPosition(); // Every line of the old log is in the snapshot
+    }
+    if (fileNumber != 0)
+        position.file = fileNumber;
+
+    file.seekg(0, ios::end);
+    uint64_t size = file ? (uint64_t)file.tellg() : 0;
+    if (size < position.offset) {
+        position.offset = ~(uint64_t)0;
+        return tail;
+    }
+
+    tail.resize(size - position.offset);
+    file.seekg(position.offset);
+    file.read(&tail[0], tail.size());
+    tail.resize(tail.rfind('\n') == string::npos ? 0 : tail.rfind('\n') + 1);
+    position.offset += tail.size();
+    return tail;
+}
+
+// Function to find the file number (inode) of a log, which tells it apart from a file put in its place
+// Returns 0 if the log does not exist, or where file numbers are not available
+uint64_t logFileNumber(string path) {
+#ifndef _WIN32
+    struct stat info;
+    if (stat(path.c_str(), &info) == 0)
+        return (uint64_t)info.st_ino;
+#endif
+    return 0;
+}
+
+// Function to add the lines written to the top dish and total sales logs of a branch since the snapshot was taken
+// Writers only ever append to the logs, so this never waits for them or changes what they write
+// The caller holds the snapshot's lock (see lockStatsSnapshot), so the logs are not started again meanwhile
+// Returns whether the snapshot changed
+bool foldStatsLogs(string branchId, StatsSnapshot& snapshot) {
+    LogPosition topdishPosition = snapshot.topdish;
+    string topdish = readLogTail(branchPath(branchId, "topdish.txt"), topdishPosition);
+    LogPosition salesPosition = snapshot.sales;
+    string sales = readLogTail(branchPath(branchId, "total_sales.txt"), salesPosition);
+
+    // Start again from an empty snapshot if a log has been replaced by a shorter one
+    if (topdishPosition.offset == ~(uint64_t)0 || salesPosition.offset == ~(uint64_t)0) {
+        snapshot = StatsSnapshot();
+        foldStatsLogs(branchId, snapshot);
+        return true;
+    }
+
+    // Add up the quantity ordered of each dish (top dish structure: menuIndex, quantity)
+    istringstream topdishLines(topdish);
+    string line; // One line of a log
+    while (getline(topdishLines, line)) {
+        int menuIndex = 0;
+        int quantity = 0;
+        if (sscanf(line.c_str(), "%d,%d", &menuIndex, &quantity) != 2)
+            continue;
+        if (snapshot.dishQuantity.find(menuIndex) == snapshot.dishQuantity.end())
+            snapshot.dishOrder.push_back(menuIndex); // Remember the order in which dishes first appear
+        snapshot.dishQuantity[menuIndex] += quantity;
+        ++snapshot.numOfDishOrders;
+    }
+
+    // Add each sales record to the total sales and customer count
+    istringstream salesLines(sales);
+    while (getline(salesLines, line)) {
+        Money amount;
+        ++snapshot.totalOrders; // Count the number of sales records
+        if (parseMoney(line, amount)) {
+            snapshot.totalSales += amount;
+            ++snapshot.numOfCustomers;
+        }
+    }
+
+    bool changed = !topdish.empty() || !sales.empty() || topdishPosition.file != snapshot.topdish.file
+                || salesPosition.file != snapshot.sales.file;
+    snapshot.topdish = topdishPosition;
+    snapshot.sales = salesPosition;
+    return changed;
+}
+
+// Function to start a stats log of a branch again, empty, once the snapshot has folded all of it (the caller holds
+// the snapshot's lock alone). The log is locked, so no line is added while the rest of it is folded and the snapshot
+// is saved with the file number of the empty log that takes its place; the empty log is only renamed over the old
+// one once the snapshot is on the disk. Until then the old log stays, folded up to its offset
+// Returns false if the log was not started again
+bool rotateStatsLog(string branchId, string logName, StatsSnapshot& snapshot) {
+#ifndef _WIN32
+    string path = branchPath(branchId, logName); // The log
+    int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0)
+        return false;
+    flock(descriptor, LOCK_EX); // Waits for the lines being added, and holds off new ones (see appendFile)
+
+    random_device random; // Makes the empty log's name unique to this writer
+    string emptyPath = path + ".tmp" + to_string(random());
+    int emptyLog = open(emptyPath.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+    struct stat info;
+    bool rotated = emptyLog >= 0 && fstat(emptyLog, &info) == 0; // Whether the log was started again
+    if (rotated) {
+        foldStatsLogs(branchId, snapshot); // Fold the last lines added (no more can be added now)
+        LogPosition& position = logName == "topdish.txt" ? snapshot.topdish : snapshot.sales;
+        position.nextFile = (uint64_t)info.st_ino;
+        rotated = saveStatsSnapshot(branchPath(branchId, "stats_snapshot.txt"), snapshot)
+               && rename(emptyPath.c_str(), path.c_str()) == 0;
+    }
+    if (emptyLog >= 0)
+        close(emptyLog);
+    if (!rotated)
+        unlink(emptyPath.c_str());
+
+    flock(descriptor, LOCK_UN);
+    close(descriptor);
+    return rotated;
+#else
+    return false; // Without file locks a line could be added to the old log after it was folded
+#endif
+}
+
+// Function to bring the stats snapshot of a branch up to date with its logs
+// A log that has grown past STATS_LOG_ROTATE_BYTES is then started again, so the logs stay short however
+// old the branch is (the lines already folded are only needed through the snapshot)
+void compactBranchStats(string branchId) {
+    StatsSnapshot snapshot;
+    string path = branchPath(branchId, "stats_snapshot.txt");
+    int statsLock = lockStatsSnapshot(branchId, true);
+    bool found = loadStatsSnapshot(path, snapshot);
+    bool saved = true; // Whether the snapshot on the disk holds everything folded
+    if (foldStatsLogs(branchId, snapshot) || !found)
+        saved = saveStatsSnapshot(path, snapshot);
+
+    if (saved && snapshot.topdish.offset >= STATS_LOG_ROTATE_BYTES)
+        rotateStatsLog(branchId, "topdish.txt", snapshot);
+    if (saved && snapshot.sales.offset >= STATS_LOG_ROTATE_BYTES)
+        rotateStatsLog(branchId, "total_sales.txt", snapshot);
+    unlockStatsSnapshot(statsLock);
+}
+
+// Function to start the background job that keeps the stats snapshots of every branch up to date
+void startCompaction() {
+    startBackgroundThread(runCompaction);
+}
+
+// Function run by the compaction thread: every COMPACTION_INTERVAL_SECONDS, fold the logs of every branch
+// into their snapshots (several copies of the program may do this at once, as each snapshot is replaced whole)
+void runCompaction() {
+    while (!backgroundStopping) {
+        for (const string& branchId : readBranchIds())
+            compactBranchStats(branchId);
+
+        unique_lock<mutex> lock(backgroundLock);
+        backgroundWake.wait_for(lock, chrono::seconds(COMPACTION_INTERVAL_SECONDS), []() { return backgroundStopping.load(); });
+    }
+}
+
+// Function to start a background thread; the first one arranges for them all to be stopped when the program exits
+// (exit handlers run before the global data the threads use is destroyed)
+void startBackgroundThread(void (*job)()) {
+    if (backgroundThreads.empty())
+        atexit(stopBackgroundThreads);
+    backgroundThreads.emplace_back(job);
+}
+
+// Function to stop the background threads and wait for them to finish what they are doing
+void stopBackgroundThreads() {
+    {
+        lock_guard<mutex> lock(backgroundLock);
+        backgroundStopping = true;
+    }
+    backgroundWake.notify_all();
+    kitchenQueue.notEmpty.notify_all(); // Wake the kitchen if it is waiting for tickets
+    {
+        lock_guard<mutex> lock(persistence.lock); // The persistence thread is now waiting, or will see the flag
+    }
+    persistence.notEmpty.notify_all(); // Wake the persistence thread to write what is left and stop
+    {
+        lock_guard<mutex> lock(settlements.lock); // Likewise for the settlement threads
+    }
+    settlements.notEmpty.notify_all(); // Wake the settlement threads to settle what is left and stop
+
+    for (thread& backgroundThread : backgroundThreads)
+        backgroundThread.join();
+    backgroundThreads.clear();
+}
+
+// Function to display the statistics of every branch side by side, with group totals
+// Each branch's statistics are calculated in parallel since they only read that branch's files
+void viewGroupStats() {
+    vector<string> branchIds = readBranchIds(); // Every registered branch, including the main branch
+    vector<future<BranchStats>> pending; // Statistics still being calculated
+    int totalOrders = 0; // Number of paid orders across the group
+    Money totalSales; // Total sales across the group
+    int numOfCustomers = 0; // Number of customers across the group
+
+    // Only managers whose role allows it may see the restaurant's figures
+    if (!requirePermission(PERMISSION_VIEW_STATS, "view group stats")) {
+        continueProgram();
+        return;
+    }
+
+    cout << "\n************************** VIEW GROUP STATS **************************\n";
+    cout << "\n/// You have selected the option to: View Group Stats\n";
+
+    // Start calculating the statistics of every branch at the same time
+    for (const string& branchId : branchIds)
+        pending.push_back(async(launch::async, computeBranchStats, branchId));
+
+    cout << "\nBRANCH\t\t     MOST POPULAR DISH\t\tORDERS\t   SALES\tCUSTOMERS";
+    cout << "\n-------------------------------------------------------------------------------\n";
+
+    // Collect the statistics of each branch (in registration order) and add them to the group totals
+    for (size_t i = 0; i < pending.size(); i++) {
+        BranchStats stats = pending[i].get();
+        string branchName = stats.branchId.empty() ? "(main)" : stats.branchId;
+        string topDish = stats.topDishName.empty() ? "-" : stats.topDishName;
+
+        cout << left << setw(20) << branchName << " " << setw(25) << topDish
+             << "\t" << setw(6) << stats.totalOrders
+             << "\t   $" << setw(10) << stats.totalSales
+             << "\t" << stats.numOfCustomers << "\n";
+
+        totalOrders += stats.totalOrders;
+        totalSales += stats.totalSales;
+        numOfCustomers += stats.numOfCustomers;
+    }
+
+    cout << "-------------------------------------------------------------------------------\n";
+    cout << "\n1. NUMBER OF BRANCHES: " << branchIds.size();
+    cout << "\n2. TOTAL ORDERS ACROSS ALL BRANCHES: " << totalOrders;
+    cout << "\n3. TOTAL SALES ACROSS ALL BRANCHES: $" << totalSales;
+    cout << "\n4. TOTAL NUMBER OF CUSTOMERS ACROSS ALL BRANCHES: " << numOfCustomers << "\n";
+
+    // Ask the user whether they want to continue using the program
+    continueProgram(); // Proceed with the next step in the program
+}
+
+// Function to display the menu of the restaurant, showing items, prices, preparation time, and stock
+// Large menus are shown one page at a time; use browseMenu() to move between pages or search
+int displayMenu() {
+    // Get the menu of the current branch (reusing the copy in memory if the menu file has not changed)
+    shared_ptr<BranchCatalog> catalog = loadBranchCatalog(currentBranchId);
+    int totalNumItems = catalog->totalNumItems; // To store the total number of items in the menu
+
+    // If the menu is empty, return 0
+    if (totalNumItems == 0) {
+        return 0;
+    } else {
+        // Collect every menu row so the first page can be displayed
+        vector<int> rows(totalNumItems);
+        for (int i = 0; i < totalNumItems; i++)
+            rows[i] = i;
+
+        displayMenuHeader(totalNumItems); // Show the number of items and the table heading
+        displayMenuPage(catalog->arrMenuContent, catalog->model, rows, 0); // Show only the first page of the menu
+    }
+
+    return totalNumItems; // Return the total number of items
+}
+
+// Function to display the heading of the menu table
+void displayMenuHeader(int totalNumItems) {
+    cout << "\n/// There are currently " << totalNumItems << " item(s) on the menu.\n"; // Show the number of items on the menu
+    cout << "\n============================================================================\n";
+    cout << "=================================== MENU ===================================\n";
+    cout << "============================================================================\n\n";
+    cout << "NO.  ITEM NAME\t\t      ITEM PRICE\tPREPARATION TIME\t STOCK";
+    cout << "\n-----------------------------------------------------------------------------\n";
+}
+
+// Function to display one item of the menu in a tabular format
+// Menu structure: index, itemName, itemPrice, preparationTime, stock[, category, modifiers, combo components]
+// Items with a category, options or combo components get an extra line describing them
+void displayMenuRow(string** arrMenuContent, const MenuModel& model, int row) {
+    string* menuRow = arrMenuContent[row]; // The details of this item
+    int index = stoi(menuRow[MENU_INDEX]); // Convert the string index to integer
+    string itemName = menuRow[MENU_NAME]; // Get the item name
+    Money itemPrice; // Price of the item
+    parseMoney(menuRow[MENU_PRICE], itemPrice); // Convert the item price to cents
+    readSharedItem(index, itemPrice, itemName); // The live price and name, when the kiosks share a catalog
+    int preparationTime = stoi(menuRow[MENU_PREP_TIME]); // Convert preparation time to integer
+    int stock = availableStock(arrMenuContent, model, row); // Combos show the stock of their component items
+
+    cout << index << ")   " << left << setw(25) << itemName
+         << "\t$" << itemPrice;
+    cout << "\t\t" << preparationTime << " minutes";
+    cout << "\t\t" << stock << "\n";
+
+    // Describe the category, options and combo components of the item, if it has any
+    string details;
+    if (model.itemCategory[row] != 0)
+        details += "Category: " + model.categories[model.itemCategory[row]];
+
+    for (uint32_t k = model.modifierStart[row]; k < model.modifierStart[row + 1]; k++) {
+        stringstream option;
+        option << model.modifiers[k].name
+               << (model.modifiers[k].priceDelta < Money{0} ? " (-$" : " (+$") << abs(model.modifiers[k].priceDelta) << ")";
+        details += (k == model.modifierStart[row] ? (details.empty() ? "Options: " : " | Options: ") : ", ") + option.str();
+    }
+
+    for (uint32_t k = model.componentStart[row]; k < model.componentStart[row + 1]; k++) {
+        string component = to_string(model.components[k].quantity) + " x " + arrMenuContent[model.components[k].row][MENU_NAME];
+        details += (k == model.componentStart[row] ? (details.empty() ? "Combo of: " : " | Combo of: ") : " + ") + component;
+    }
+
+    if (!details.empty())
+        cout << "     " << details << "\n";
+}
+
+// Function to display one page (MENU_PAGE_SIZE items) out of a list of menu rows
+void displayMenuPage(string** arrMenuContent, const MenuModel& model, const vector<int>& rows, int page) {
+    int totalRows = rows.size(); // Number of rows that can be paged through
+    int totalPages = (totalRows + MENU_PAGE_SIZE - 1) / MENU_PAGE_SIZE; // Number of pages needed to show every row
+    int first = page * MENU_PAGE_SIZE; // Position of the first row on this page
+    int last = min(first + MENU_PAGE_SIZE, totalRows); // Position after the last row on this page
+
+    // Loop through the rows belonging to this page and display each item
+    for (int i = first; i < last; i++)
+        displayMenuRow(arrMenuContent, model, rows[i]);
+
+    // Only mention paging when there is more than one page
+    if (totalPages > 1) {
+        cout << "-----------------------------------------------------------------------------\n";
+        cout << "/// Showing item(s) " << first + 1 << " - " << last << " of " << totalRows
+             << " (page " << page + 1 << " of " << totalPages << ")\n";
+    }
+}
+
+// Function to build the search index over the menu item names
+// Every item name is lowercased and split into overlapping 3-character sequences (trigrams),
+// and each trigram records the menu rows it appears in, so a search only verifies a few candidates
+void buildMenuSearchIndex(string** arrMenuContent, int totalNumItems, MenuSearchIndex& searchIndex) {
+    unordered_map<uint32_t, vector<int>> rowsOfTrigram; // Packed 3-character sequence -> menu rows containing it
+
+    searchIndex.totalNumItems = totalNumItems;
+    searchIndex.lowerNames.assign(totalNumItems, "");
+
+    for (int i = 0; i < totalNumItems; i++) {
+        string lowerName = arrMenuContent[i][MENU_NAME]; // Copy the item name before lowercasing it
+        for (char& c : lowerName)
+            c = tolower((unsigned char)c);
+        searchIndex.lowerNames[i] = lowerName;
+
+        // Record this row against every trigram of its name (rows are added in ascending order)
+        for (int j = 0; j + 3 <= (int)lowerName.length(); j++) {
+            uint32_t trigram = ((uint32_t)(unsigned char)lowerName[j] << 16)
+                             | ((uint32_t)(unsigned char)lowerName[j + 1] << 8)
+                             | (uint32_t)(unsigned char)lowerName[j + 2];
+            vector<int>& trigramRows = rowsOfTrigram[trigram];
+            if (trigramRows.empty() || trigramRows.back() != i)
+                trigramRows.push_back(i); // Avoid duplicates when a trigram repeats within one name
+        }
+    }
+
+    // Lay the trigrams out as the table, in ascending order
+    searchIndex.trigramStorage.clear();
+    for (const auto& entry : rowsOfTrigram)
+        searchIndex.trigramStorage.push_back(entry.first);
+    sort(searchIndex.trigramStorage.begin(), searchIndex.trigramStorage.end());
+    searchIndex.trigramStartStorage.assign(1, 0);
+    searchIndex.trigramRowStorage.clear();
+    for (uint32_t trigram : searchIndex.trigramStorage) {
+        const vector<int>& rows = rowsOfTrigram[trigram];
+        searchIndex.trigramRowStorage.insert(searchIndex.trigramRowStorage.end(), rows.begin(), rows.end());
+        searchIndex.trigramStartStorage.push_back((uint32_t)searchIndex.trigramRowStorage.size());
+    }
+    searchIndex.numOfTrigrams = searchIndex.trigramStorage.size();
+    searchIndex.trigrams = searchIndex.trigramStorage.data();
+    searchIndex.trigramStart = searchIndex.trigramStartStorage.data();
+    searchIndex.trigramRows = searchIndex.trigramRowStorage.data();
+}
+
+// Function to search the menu item names for a (case-insensitive) substring
+// Returns the matching menu rows, with names starting with the query listed first
+vector<int> searchMenu(const MenuSearchIndex& searchIndex, string query) {
+    vector<int> matches; // Menu rows whose item name contains the query
+
+    for (char& c : query)
+        c = tolower((unsigned char)c);
+
+    if (query.empty())
+        return matches;
+
+    if (query.length() < 3) {
+        // Too short to have a trigram, so check every (already lowercased) name directly
+        for (int i = 0; i < searchIndex.totalNumItems; i++) {
+            if (searchIndex.lowerNames[i].find(query) != string::npos)
+                matches.push_back(i);
+        }
+    } else {
+        // Use the rarest trigram of the query as the candidate list
+        const int* candidates = nullptr; // First candidate row
+        const int* candidatesEnd = nullptr; // End of the candidate rows
+        const uint32_t* trigramsEnd = searchIndex.trigrams + searchIndex.numOfTrigrams;
+        for (int j = 0; j + 3 <= (int)query.length(); j++) {
+            uint32_t trigram = ((uint32_t)(unsigned char)query[j] << 16)
+                             | ((uint32_t)(unsigned char)query[j + 1] << 8)
+                             | (uint32_t)(unsigned char)query[j + 2];
+            const uint32_t* found = lower_bound(searchIndex.trigrams, trigramsEnd, trigram);
+
+            // If any trigram never appears in the menu, nothing can match
+            if (found == trigramsEnd || *found != trigram)
+                return matches;
+
+            size_t t = found - searchIndex.trigrams;
+            const int* rows = searchIndex.trigramRows + searchIndex.trigramStart[t];
+            const int* rowsEnd = searchIndex.trigramRows + searchIndex.trigramStart[t + 1];
+            if (candidates == nullptr || rowsEnd - rows < candidatesEnd - candidates) {
+                candidates = rows;
+                candidatesEnd = rowsEnd;
+            }
+        }
+
+        // Verify each candidate actually contains the whole query
+        for (const int* row = candidates; row != candidatesEnd; ++row) {
+            if (searchIndex.lowerNames[*row].find(query) != string::npos)
+                matches.push_back(*row);
+        }
+    }
+
+    // List the names that start with the query (prefix matches) before the other matches
+    stable_partition(matches.begin(), matches.end(), [&](int row) {
+        return searchIndex.lowerNames[row].compare(0, query.length(), query) == 0;
+    });
+
+    return matches;
+}
+
+// Function to let the user page through or search the menu until an item is selected
+// Returns the index number of the selected menu item, which is always one found in the menu
+int browseMenu(string** arrMenuContent, int totalNumItems, const MenuModel& model, const MenuSearchIndex& searchIndex, string prompt) {
+    string choice; // The user's input: an item number or a browsing command
+    string query; // The text to search the item names for
+    int page = 0; // The page currently being displayed
+    int selectedIndex = 0; // The index number of the item chosen by the user
+
+    // Start by browsing the whole menu
+    vector<int> rows(totalNumItems);
+    for (int i = 0; i < totalNumItems; i++)
+        rows[i] = i;
+    int totalPages = (totalNumItems + MENU_PAGE_SIZE - 1) / MENU_PAGE_SIZE;
+
+    while (selectedIndex == 0) {
+        cout << "\n=> " << prompt << " (1 - " << totalNumItems << ")";
+        if (totalPages > 1)
+            cout << ",\n   or [N] Next page, [P] Previous page, [S] Search, [A] All items";
+        else
+            cout << ",\n   or [S] Search, [A] All items";
+        cout << ": ";
+        choice = readToken();
+
+        // An item number was entered: check that an item of the menu has it
+        // (index numbers need not be contiguous, so the number must be looked up)
+        if (isdigit((unsigned char)choice[0])) {
+            int menuChoice = 0;
+            if (!parseInt(choice, menuChoice) || findMenuRow(arrMenuContent, totalNumItems, menuChoice) == -1)
+                cout << "/// Sorry, that is not a valid selection. Please try again!\n";
+            else
+                selectedIndex = menuChoice;
+        }
+        // Move to the next or previous page of the current list
+        else if ((choice[0] == 'N' || choice[0] == 'n') && choice.length() == 1) {
+            if (page + 1 < totalPages) {
+                ++page;
+                displayMenuPage(arrMenuContent, model, rows, page);
+            } else {
+                cout << "/// You are already on the last page.\n";
+            }
+        }
+        else if ((choice[0] == 'P' || choice[0] == 'p') && choice.length() == 1) {
+            if (page > 0) {
+                --page;
+                displayMenuPage(arrMenuContent, model, rows, page);
+            } else {
+                cout << "/// You are already on the first page.\n";
+            }
+        }
+        // Search the item names and browse the matching items instead
+        else if ((choice[0] == 'S' || choice[0] == 's') && choice.length() == 1) {
+            cout << "=> Enter (part of) the item name to search for: ";
+            query = readLine();
+
+            vector<int> matches = searchMenu(searchIndex, query);
+            if (matches.empty()) {
+                cout << "/// No items match \"" << query << "\". Showing the current list again.\n";
+                displayMenuPage(arrMenuContent, model, rows, page);
+            } else {
+                rows = matches;
+                page = 0;
+                totalPages = (rows.size() + MENU_PAGE_SIZE - 1) / MENU_PAGE_SIZE;
+                cout << "\n/// " << rows.size() << " item(s) match \"" << query << "\":\n";
+                displayMenuPage(arrMenuContent, model, rows, page);
+            }
+        }
+        // Go back to browsing the whole menu
+        else if ((choice[0] == 'A' || choice[0] == 'a') && choice.length() == 1) {
+            rows.resize(totalNumItems);
+            for (int i = 0; i < totalNumItems; i++)
+                rows[i] = i;
+            page = 0;
+            totalPages = (totalNumItems + MENU_PAGE_SIZE - 1) / MENU_PAGE_SIZE;
+            displayMenuHeader(totalNumItems);
+            displayMenuPage(arrMenuContent, model, rows, page);
+        }
+        else {
+            cout << "/// Sorry, that is not a valid selection. Please try again!\n";
+        }
+    }
+
+    return selectedIndex; // Return the index number of the selected item
+}
+
+// Function to accept an order line and verify stock availability, reserving the stock if valid
+// The stock is only deducted once the order is paid (see commitOrderStock)
+// Order line structure: menuIndex, quantity, modifierMask (the options chosen, one bit per modifier)
+int acceptOrder(int** arrOrder, int x, int orderId, const PriceSnapshot& prices) {
+    int invalidItemIndex = 0; // To track the index of invalid items
+
+    // Get the current menu, with its model so combos can be checked against their component items
+    shared_ptr<BranchCatalog> catalog = loadBranchCatalog(currentBranchId);
+
+    // Find the ordered item in the menu
+    int row = findMenuRow(catalog->arrMenuContent, catalog->totalNumItems, arrOrder[x][0]);
+
+    // Check that the item exists and enough stock is available, reserving it for this cart if so
+    if (row == -1 || !reserveStock(orderId, catalog->arrMenuContent, catalog->model, row, arrOrder[x][1])) {
+        invalidItemIndex = arrOrder[x][0]; // Store the invalid item's menu index
+        arrOrder[x][0] = 0; // Set menu index to 0 to indicate invalid item
+        arrOrder[x][1] = 0; // Set quantity to 0
+    } else {
+        // Announce the accepted order line in the event stream
+        vector<EventRecord> events;
+        Money price = orderLinePrice(prices, catalog->arrMenuContent, catalog->model, row, arrOrder[x][2]);
+        addEvent(events, EVENT_ORDER_ACCEPTED, orderId, arrOrder[x][0], arrOrder[x][1], price.cents);
+        queueEvents(events);
+    }
+
+    return invalidItemIndex; // Return the index of invalid items (if any)
+}
+
+// Function to start a stock reservation for a new cart; returns the cart's order ID
+int createReservation() {
+    lock_guard<mutex> lock(stockReservations.lock);
+    return ++stockReservations.lastOrderId;
+}
+
+// Function to add up the stock an order line uses, by menu row of the stocked items
+// A combo uses its component items rather than stock of its own
+void addStockNeeds(const MenuModel& model, int row, int quantity, unordered_map<int, int>& needs) {
+    uint32_t first = model.componentStart[row]; // First combo component of the item
+    uint32_t last = model.componentStart[row + 1]; // End of the item's combo components
+
+    if (first == last)
+        needs[row] += quantity;
+    for (uint32_t k = first; k < last; k++)
+        needs[model.components[k].row] += quantity * model.components[k].quantity;
+}
+
+// Function to reserve the stock of an order line for a cart
+// Every item the line uses is checked first and only then are they all reserved together, so either
+// the whole order line is reserved or nothing is. Reserving also restarts the cart's expiry time
+// Returns false (and changes nothing) if there is not enough unreserved stock
+bool reserveStock(int orderId, string** arrMenuContent, const MenuModel& model, int row, int quantity) {
+    unordered_map<int, int> needs; // Stock the order line uses, by menu row
+    addStockNeeds(model, row, quantity, needs);
+
+    time_t now = time(0);
+    lock_guard<mutex> lock(stockReservations.lock);
+    advanceReservations(stockReservations, now);
+
+    for (const auto& need : needs) {
+        int stock = itemStock(arrMenuContent, need.first) - stockReservations.reservedStock[stoi(arrMenuContent[need.first][MENU_INDEX])];
+        if (need.second > stock)
+            return false; // Not enough stock for the whole order line
+    }
+
+    // Reservations are kept by menu index, which (unlike the row) stays the same when the menu is reloaded
+    StockReservation& reservation = stockReservations.reservations[orderId];
+    for (const auto& need : needs) {
+        int menuIndex = stoi(arrMenuContent[need.first][MENU_INDEX]);
+        reservation.quantities[menuIndex] += need.second;
+        stockReservations.reservedStock[menuIndex] += need.second;
+    }
+
+    // Schedule the cart to expire; a slot entry left from an earlier expiry time is ignored when it comes round
+    reservation.expiresAt = now + RESERVATION_TTL_SECONDS;
+    stockReservations.wheel[reservation.expiresAt % RESERVATION_WHEEL_SLOTS].push_back(orderId);
+    return true;
+}
+
+// Function to give back the stock reserved by a cart (when the cart is abandoned or ordered again)
+void releaseReservation(int orderId) {
+    lock_guard<mutex> lock(stockReservations.lock);
+    dropReservation(stockReservations, orderId);
+}
+
+// Function to remove a cart's reservation from the reservation table (the caller must hold its lock)
+void dropReservation(ReservationTable& table, int orderId) {
+    auto found = table.reservations.find(orderId);
+    if (found == table.reservations.end())
+        return;
+
+    for (const auto& reserved : found->second.quantities) {
+        int& total = table.reservedStock[reserved.first];
+        total -= reserved.second;
+        if (total <= 0)
+            table.reservedStock.erase(reserved.first);
+    }
+    table.reservations.erase(found);
+}
+
+// Function to release the reservations that have expired, by turning the timer wheel up to the given time
+// (the caller must hold the table's lock). Each second's slot is visited once; a cart listed there is
+// released only if it has not been changed since, which would have moved its expiry time to a later slot
+void advanceReservations(ReservationTable& table, time_t now) {
+    if (table.wheelTime == 0 || now < table.wheelTime) {
+        table.wheelTime = now; // First use (or the clock went back): start the wheel from now
+        return;
+    }
+    if (now - table.wheelTime > RESERVATION_WHEEL_SLOTS)
+        table.wheelTime = now - RESERVATION_WHEEL_SLOTS; // Visit every slot once at most
+
+    while (table.wheelTime < now) {
+        ++table.wheelTime;
+        vector<int>& slot = table.wheel[table.wheelTime % RESERVATION_WHEEL_SLOTS];
+        for (int orderId : slot) {
+            auto found = table.reservations.find(orderId);
+            if (found != table.reservations.end() && found->second.expiresAt <= now)
+                dropReservation(table, orderId);
+        }
+        slot.clear();
+    }
+}
+
+// Function to find the quantity of a stocked item reserved by unpaid carts
+int reservedQuantity(int menuIndex) {
+    lock_guard<mutex> lock(stockReservations.lock);
+    advanceReservations(stockReservations, time(0));
+
+    auto found = stockReservations.reservedStock.find(menuIndex);
+    return found == stockReservations.reservedStock.end() ? 0 : found->second;
+}
+
+// Function to deduct the stock of an order being paid for, replacing the cart's reservation
+// The order is checked against the stock that is not reserved by other carts (its own reservation may have
+// expired), and either the whole order is deducted or nothing is. Paid lines are added to the top dish file
+// With a shared catalog the stock is deducted from its live counts, which every kiosk sees at once, and writing it
+// to the menu file is left to the persistence thread: the orders paid at any kiosk of the branch within a batch
+// (see PERSISTENCE_BATCH_MS) reach the file in one write, which the other kiosks then find already done
+// Without one, the menu file is the only record of the stock, so it is read, changed and written back under the
+// menu file's lock (see lockMenuFile) and kiosks paying at the same time never write over each other's stock.
+// The reservation table is only locked while the order is checked and deducted. Until the menu file has been
+// written, the stock used stays reserved under COMMITTING_ORDER_ID, so new carts cannot reserve it from the
+// menu in memory, which still holds the stock from before the order
+// Returns 0 on success, the menu index of an item that is no longer available, or STOCK_NOT_SAVED if the
+// stock could not be written to the menu file (nothing is deducted then)
+int commitOrderStock(int orderId, const vector<int>& menuIndices, const vector<int>& quantities) {
+    int totalNumItems = 0; // Total number of items in the menu
+    int unavailableItem = 0; // Menu index of an item without enough stock (or STOCK_NOT_SAVED)
+    unordered_map<int, int> needs; // Stock the order uses, by menu row
+    unordered_map<int, int> usedStock; // Stock the order used, by menu index
+    bool shared = useSharedCatalog(); // Whether the stock is deducted from the shared catalog
+    shared_ptr<BranchCatalog> catalog = shared ? loadBranchCatalog(currentBranchId) : nullptr;
+
+    // Read the current stock, with the menu model so combos use their component items
+    int menuLock = shared ? -1 : lockMenuFile(); // Held until the stock is written back
+    string** arrMenuContent = shared ? catalog->arrMenuContent : readMenu(totalNumItems);
+    MenuModel fileModel; // Model of the menu read from the file
+    if (shared)
+        totalNumItems = catalog->totalNumItems;
+    else
+        buildMenuModel(arrMenuContent, totalNumItems, fileModel);
+    const MenuModel& model = shared ? catalog->model : fileModel;
+
+    unique_lock<mutex> lock(stockReservations.lock);
+    advanceReservations(stockReservations, time(0));
+    dropReservation(stockReservations, orderId); // The paid order takes its stock for good instead
+
+    for (size_t i = 0; i < menuIndices.size() && unavailableItem == 0; i++) {
+        int row = findMenuRow(arrMenuContent, totalNumItems, menuIndices[i]);
+        if (row == -1)
+            unavailableItem = menuIndices[i]; // The item has been taken off the menu
+        else
+            addStockNeeds(model, row, quantities[i], needs);
+    }
+
+    if (!shared) {
+        for (const auto& need : needs) {
+            int menuIndex = stoi(arrMenuContent[need.first][MENU_INDEX]);
+            auto reserved = stockReservations.reservedStock.find(menuIndex);
+            int stock = stoi(arrMenuContent[need.first][MENU_STOCK]) - (reserved == stockReservations.reservedStock.end() ? 0 : reserved->second);
+            if (unavailableItem == 0 && need.second > stock)
+                unavailableItem = menuIndex;
+        }
+    } else if (unavailableItem == 0) {
+        // Deduct the whole order from the live counts at once
+        unordered_map<int, int> indexNeeds; // Stock the order uses, by menu index
+        for (const auto& need : needs)
+            indexNeeds[stoi(arrMenuContent[need.first][MENU_INDEX])] += need.second;
+        unavailableItem = takeSharedStock(indexNeeds, stockReservations.reservedStock);
+    }
+
+    if (unavailableItem == 0) {
+        for (const auto& need : needs) {
+            if (!shared)
+                arrMenuContent[need.first][MENU_STOCK] = to_string(stoi(arrMenuContent[need.first][MENU_STOCK]) - need.second);
+            usedStock[stoi(arrMenuContent[need.first][MENU_INDEX])] += need.second;
+        }
+    }
+
+    // Keep the stock used reserved until it is in the menu file (the live counts of a shared catalog already
+    // hold it). The reservation is not put on the timer wheel, so it never expires
+    if (!shared && !usedStock.empty()) {
+        StockReservation& reservation = stockReservations.reservations[COMMITTING_ORDER_ID];
+        for (const auto& used : usedStock) {
+            reservation.quantities[used.first] += used.second;
+            stockReservations.reservedStock[used.first] += used.second;
+        }
+    }
+    lock.unlock();
+
+    // Write the updated stock values to the menu file (the live ones, with a shared catalog, in the background)
+    // Without a shared catalog, the menu file is the only record of the stock, so if it cannot be written the
+    // order is turned down
+    bool saved = true; // Whether the stock was written (or queued to be written)
+    if (shared && !usedStock.empty())
+        queueSharedStock();
+    else if (!shared && !usedStock.empty())
+        saved = writeMenuFile(arrMenuContent, totalNumItems, false);
+    if (!shared)
+        unlockMenuFile(menuLock);
+    if (!saved)
+        cerr << "/// Could not write the stock to " << dataPath("menu.txt") << ": " << strerror(errno) << "\n";
+    if (!shared && !usedStock.empty()) {
+        // The menu file now holds the stock that is left (or, if it could not be written, the stock is given back)
+        lock.lock();
+        dropReservation(stockReservations, COMMITTING_ORDER_ID);
+        lock.unlock();
+    }
+    if (!saved) {
+        unavailableItem = STOCK_NOT_SAVED;
+        usedStock.clear();
+    }
+
+    if (!usedStock.empty()) {
+        // Update the consumption rates of the stocked items the order used
+        recordStockConsumption(usedStock, time(0));
+
+        // Append the menu index and quantity of each paid line to the top dish file
+        string topdishLines; // Top dish lines of the order
+        for (size_t i = 0; i < menuIndices.size(); i++)
+            topdishLines += to_string(menuIndices[i]) + "," + to_string(quantities[i]) + "\n";
+        queueAppend(dataPath("topdish.txt"), topdishLines);
+
+        // Announce the stock used, and the stock left, of each item in the event stream
+        vector<EventRecord> events;
+        for (const auto& used : usedStock) {
+            int row = findMenuRow(arrMenuContent, totalNumItems, used.first);
+            int stockLeft = shared ? itemStock(arrMenuContent, row) : stoi(arrMenuContent[row][MENU_STOCK]);
+            addEvent(events, EVENT_STOCK_CHANGED, 0, used.first, used.second, stockLeft);
+        }
+        queueEvents(events);
+    }
+
+    // Clean up dynamically allocated memory for the menu content (a shared menu is released with the catalog)
+    if (!shared) {
+        for (int i = 0; i < totalNumItems; i++)
+            delete[] arrMenuContent[i];
+        delete[] arrMenuContent;
+    }
+    return unavailableItem;
+}
+
+// Function to read the consumption rates of the current branch from its forecast file
+// Forecast structure: menuIndex, perHour, updatedAt
+// Without a forecast file, the rates are worked out once from the order history (through its columnar
+// snapshot, as the top dish file does not record when items were ordered) and saved
+void loadStockForecast(StockForecast& forecast) {
+    ifstream file(dataPath("stock_forecast.txt"));
+    string line; // One item's consumption rate
+
+    forecast.rates.clear();
+    forecast.loaded = true;
+
+    if (file) {
+        while (getline(file, line)) {
+            int menuIndex = 0;
+            ConsumptionRate rate;
+            long long updatedAt = 0;
+            if (sscanf(line.c_str(), "%d,%lf,%lld", &menuIndex, &rate.perHour, &updatedAt) == 3) {
+                rate.updatedAt = (time_t)updatedAt;
+                forecast.rates[menuIndex] = rate;
+            }
+        }
+        return;
+    }
+
+    OrderColumns columns;
+    loadOrderSnapshot(dataPath("order_history.col"), columns);
+    uint64_t convertedBefore = columns.sourceSize;
+    refreshOrderSnapshot(columns);
+    if (columns.sourceSize != convertedBefore)
+        saveOrderSnapshot(dataPath("order_history.col"), columns);
+
+    size_t numOfRows = columns.menuIndices.size();
+    vector<int64_t> timestamps(numOfRows);
+    decodeTimestamps(columns.timestampDeltas.data(), numOfRows, columns.baseTimestamp, timestamps.data());
+
+    // Combos in the history used their component items, so look each line up on the current menu
+    shared_ptr<BranchCatalog> catalog = loadBranchCatalog(currentBranchId);
+    unordered_map<int, int> rowOfIndex; // Menu row of each menu index
+    for (int i = 0; i < catalog->totalNumItems; i++)
+        rowOfIndex[stoi(catalog->arrMenuContent[i][MENU_INDEX])] = i;
+
+    unordered_map<int, int> needs; // Stock one order line used, by menu row
+    for (size_t i = 0; i < numOfRows; i++) {
+        auto found = rowOfIndex.find(columns.menuIndices[i]);
+        if (found == rowOfIndex.end())
+            continue; // The item is no longer on the menu
+        needs.clear();
+        addStockNeeds(catalog->model, found->second, columns.quantities[i], needs);
+        for (const auto& need : needs)
+            addConsumption(forecast.rates[stoi(catalog->arrMenuContent[need.first][MENU_INDEX])], need.second, (time_t)timestamps[i]);
+    }
+
+    saveStockForecast(forecast);
+}
+
+// Function to write the consumption rates of the current branch to its forecast file
+// (through the persistence thread, which replaces the old file only once the new one is complete)
+void saveStockForecast(const StockForecast& forecast) {
+    ostringstream file;
+
+    file << setprecision(9);
+    for (const auto& entry : forecast.rates)
+        file << entry.first << "," << entry.second.perHour << "," << (long long)entry.second.updatedAt << "\n";
+    queueReplace(dataPath("stock_forecast.txt"), file.str());
+}
+
+// Function to add a quantity used at the given time to an exponentially weighted consumption rate
+// The rate decays by e^(-hours / CONSUMPTION_WINDOW_HOURS) as time passes, and each use adds
+// quantity / CONSUMPTION_WINDOW_HOURS, so a steady flow of orders settles at its quantity per hour.
+// A use older than the last update (history lines written out of order) is decayed before it is added
+void addConsumption(ConsumptionRate& rate, int quantity, time_t usedAt) {
+    if (usedAt >= rate.updatedAt) {
+        rate.perHour = currentRate(rate, usedAt) + quantity / CONSUMPTION_WINDOW_HOURS;
+        rate.updatedAt = usedAt;
+    }
+    else
+        rate.perHour += quantity / CONSUMPTION_WINDOW_HOURS * exp(-(rate.updatedAt - usedAt) / 3600.0 / CONSUMPTION_WINDOW_HOURS);
+}
+
+// Function to find a consumption rate as of the given time (it decays while nothing is ordered)
+double currentRate(const ConsumptionRate& rate, time_t now) {
+    if (now <= rate.updatedAt)
+        return rate.perHour;
+    return rate.perHour * exp(-(now - rate.updatedAt) / 3600.0 / CONSUMPTION_WINDOW_HOURS);
+}
+
+// Function to update the consumption rates with the stock used by a paid order (by menu index)
+void recordStockConsumption(const unordered_map<int, int>& usedStock, time_t usedAt) {
+    lock_guard<mutex> lock(stockForecast.lock);
+    if (!stockForecast.loaded)
+        loadStockForecast(stockForecast);
+
+    for (const auto& used : usedStock)
+        addConsumption(stockForecast.rates[used.first], used.second, usedAt);
+    saveStockForecast(stockForecast);
+}
+
+// Function to calculate the total payment for an order from the priced lines of its cart
+Money calcTotalPaymentsPerOrder(const vector<CartLine>& cartLines) {
+    Money totalPayment; // To store the total payment for the order
+
+    // Process each item in the cart and calculate the total payment
+    for (const CartLine& line : cartLines)
+        totalPayment += line.unitPrice * line.quantity; // Calculate the total payment for this item
+
+    return totalPayment; // Return the total payment for this order
+}
+
+// Function to calculate the estimated delivery time, including preparation time and travel time
+int calcEstDeliveryTime(const vector<ReceiptLine>& cart, string& deliveryArea, int& totalPrepTime) {
+    int deliveryTravelTime = 0; // To store the delivery travel time based on the area
+    int deliveryTime = 0; // Total delivery time in minutes (prep time + travel time)
+
+    // Process each item in the cart to calculate the total preparation time
+    for (const ReceiptLine& line : cart) {
+        // Accumulate total preparation time (considering the quantity ordered)
+        totalPrepTime += line.quantity * line.preparationTime;
+    }
+
+    // Ask the user to input their delivery area choice, until one of the listed areas is entered
+    string prompt = "\n=> Please enter your delivery area (1 - " + to_string(NUM_OF_DELIVERY_AREAS) + "): ";
+    string choices; // The area numbers the user can enter
+    for (int area = 0; area < NUM_OF_DELIVERY_AREAS; area++) {
+        choices += (char)('1' + area);
+        prompt += "\n[" + to_string(area + 1) + "] " + DELIVERY_AREAS[area].name;
+    }
+    deliveryArea = string(1, promptChoice(prompt + "\n", choices));
+
+    // Look up the delivery travel time of the selected area
+    deliveryTravelTime = DELIVERY_AREAS[deliveryArea[0] - '1'].travelTime;
+
+    // Calculate the total delivery time (preparation time + travel time)
+    deliveryTime = totalPrepTime + deliveryTravelTime;
+
+    return deliveryTime; // Return the calculated total delivery time
+}
+
+// Function to check if a menu item already exists based on its name
+bool itemAlreadyExists(string itemName) {
+    int totalNumItems = 0; // Total number of items in the menu
+    bool exists = false; // Whether an item with this name was found
+
+    // Read the menu (this also handles the optional category, modifier and combo columns)
+    string** arrMenuContent = readMenu(totalNumItems);
+
+    // Process each item in the menu
+    for (int i = 0; i < totalNumItems; i++) {
+        if (arrMenuContent[i][MENU_NAME] == itemName) { // If the item name matches the input name
+            exists = true; // The item already exists
+            break;
+        }
+    }
+
+    // Clean up dynamically allocated memory for the menu content
+    for (int i = 0; i < totalNumItems; i++)
+        delete[] arrMenuContent[i];
+    delete[] arrMenuContent;
+
+    return exists; // Return whether the item name was found
+}
+
+// Function to ask the user if they want to continue using the program
+void continueProgram() {
+    char choice = 'Y'; // Variable to store user's choice
+
+    // Prompt the user to decide if they wish to continue
+    cout << "\n=> Do you wish to continue using this program? [Y/N] ";
+    choice = readChoice();
+
+    // Validate the user's input to ensure it's either 'Y' or 'N'
+    while (choice != 'Y' && choice != 'y' && choice != 'N' && choice != 'n') {
+        cout << "\n/// Sorry, that is not a valid selection. Please try again!";
+        cout << "\n=> Do you wish to continue using this program? [Y/N] ";
+        choice = readChoice();
+    }
+
+    // If the user chooses 'Y' or 'y', continue with the manager actions
+    if (choice == 'Y' || choice == 'y')
+        getManagerAction(); // Call the function to get the manager's next action
+    else {
+        cout << "\n/// Redirecting to logout...\n"; // Logout message
+        logout(); // Call the logout function
+    }
+}
+
+// Function to allow customers to order food online
+void orderOnline(UserDetails& ud) {
+    int index = 0; // Index to iterate through the menu items
+    string itemName; // Name of the food item
+    string strItemPrice; // Temporary string for item price
+    string strPreparationTime; // Temporary string for preparation time
+    string strStock; // Temporary string to store stock info
+    int menuChoice = 0; // Customer's menu choice (index)
+    int quantity = 0; // Quantity of the ordered item
+    Money totalPrice; // Total price of the order
+    char choice = 'Y'; // Choice to continue ordering
+    int invalidItemIndex = 0; // Index of invalid item (insufficient stock)
+    int totalNumItems = 0; // Total number of items in the menu
+    string line; // Temporary variable to read unnecessary data from file
+    bool itemAlreadyExists = false; // Flag to check if item has been ordered previously
+
+    time_t now = time(0); // Get current system time (date and time)
+    char* datetime = ctime(&now); // Convert current time to string
+
+    // Start the receipt afresh (a previous unpaid cart, e.g. when re-ordering, is replaced)
+    ud.orderedAt = datetime;
+    ud.cart.clear();
+
+    cout << "\n**************************** ORDER PAGE ****************************\n";
+
+    // Get the menu of the current branch, along with its search index and model (options and combos)
+    shared_ptr<BranchCatalog> catalog = loadBranchCatalog(currentBranchId);
+    string** arrMenuContent = catalog->arrMenuContent;
+    totalNumItems = catalog->totalNumItems;
+    const MenuModel& model = catalog->model;
+    const MenuSearchIndex& searchIndex = catalog->searchIndex;
+
+    // Check if menu is empty
+    if (totalNumItems == 0) {
+        cout << "\n/// Sorry, menu does not exist. Please contact a RESTAURANT MANAGER for help to CREATE MENU.";
+        logout(); // If no menu exists, log out the user
+    } else {
+        cout << "\n/// You are now ordering online as customer.\n";
+
+        // Start a new cart; the stock of a previous unpaid cart (e.g. when re-ordering) is given back
+        // The cart is priced at the menu's prices as they are now, whatever price updates come while ordering
+        if (ud.orderId != 0)
+            releaseReservation(ud.orderId);
+        ud.orderId = createReservation();
+        ud.pinnedPrices = catalog->prices;
+
+        // Display the menu for the customer to choose from
+        displayMenu();
+
+        // Dynamically allocate 2D array to store the customer's order
+        int capacity = totalNumItems; // Number of order lines allocated so far
+        int** arrMenuChoices = new int*[capacity];
+        for (int i = 0; i < capacity; i++) {
+            arrMenuChoices[i] = new int[3]; // Each entry stores menu index, quantity and the chosen options
+        }
+
+        int x = 0; // Index to track the number of items ordered
+        while (choice == 'Y' || choice == 'y') {
+            // Prompt the customer to select a menu item
+            // (the customer may page through or search the menu before choosing)
+            menuChoice = browseMenu(arrMenuContent, totalNumItems, model, searchIndex, "Please enter the index number of your choice of food");
+
+            // Prompt the customer to enter the quantity
+            cout << "=> Please enter the quantity: ";
+
+            // Ensure the quantity is a positive whole number
+            while (!readInt(quantity) || quantity < 1) {
+                cout << "/// Sorry, the quantity must be a whole number of at least 1. Please try again!\n";
+                cout << "\n=> Please enter the quantity: ";
+            }
+
+            // Let the customer choose the options (size, add-ons) of the item, if it has any
+            int row = findMenuRow(arrMenuContent, totalNumItems, menuChoice);
+            int modifierMask = chooseModifiers(arrMenuContent, model, row);
+
+            // The same item can be ordered with different options, so grow the order if it is full
+            if (x == capacity) {
+                int** arrGrown = new int*[capacity * 2];
+                for (int i = 0; i < capacity * 2; i++)
+                    arrGrown[i] = i < capacity ? arrMenuChoices[i] : new int[3];
+                delete[] arrMenuChoices;
+                arrMenuChoices = arrGrown;
+                capacity *= 2;
+            }
+
+            // Place the new order line after the accepted ones so its stock can be checked
+            arrMenuChoices[x][0] = menuChoice; // Store the selected menu item index
+            arrMenuChoices[x][1] = quantity; // Store the quantity ordered
+            arrMenuChoices[x][2] = modifierMask; // Store the chosen options
+
+            cout << "\n/// Processing order...\n";
+
+            // Check whether the item is valid (e.g., sufficient stock)
+            invalidItemIndex = acceptOrder(arrMenuChoices, x, ud.orderId, *ud.pinnedPrices);
+
+            // If the item is invalid (insufficient stock), notify the customer
+            if (invalidItemIndex != 0) {
+                for (int i = 0; i < totalNumItems; i++) {
+                    index = stoi(arrMenuContent[i][MENU_INDEX]);
+                    if (index == invalidItemIndex) {
+                        itemName = arrMenuContent[i][MENU_NAME]; // Retrieve the item name
+                    }
+                }
+
+                cout << "/// Apologies! Order of " << itemName << " is rejected due to insufficient stock.\n";
+            } else {
+                // Check if the customer has already ordered this item with the same options
+                itemAlreadyExists = false;
+                for (int k = 0; k < x; k++) {
+                    if (menuChoice == arrMenuChoices[k][0] && modifierMask == arrMenuChoices[k][2]) {
+                        // If the item was previously ordered, add the new quantity to the existing quantity
+                        arrMenuChoices[k][1] += quantity;
+                        itemAlreadyExists = true;
+                        cout << "\n/// This item has been ordered before. Updating quantity...\n";
+                        break;
+                    }
+                }
+
+                // If the item was not previously ordered, keep it as a new line of the order
+                if (itemAlreadyExists == false)
+                    ++x; // Increment the order count
+            }
+
+            // Ask the customer if they want to continue ordering
+            cout << "\n=> Do you wish to continue ordering? [Y/N] ";
+            choice = readChoice();
+
+            // Validate the choice to continue or stop ordering
+            while (choice != 'Y' && choice != 'y' && choice != 'N' && choice != 'n') {
+                cout << "\n/// Sorry, that is not a valid selection. Please try again!";
+                cout << "\n=> Do you wish to continue ordering? [Y/N] "; // Ask again for valid input
+                choice = readChoice();
+            }
+        }
+
+        // Keep the order in the customer's cart, which the payment page reads
+        // The cart lives in this kiosk's memory only: kiosks of a branch share its data folder, so a receipt
+        // file there would be written over by whichever kiosk ordered last
+        for (int k = 0; k < x; k++) {
+            if (arrMenuChoices[k][0] == 0) continue; // Skip empty entries
+
+            // The item name and price include the options chosen by the customer
+            int row = findMenuRow(arrMenuContent, totalNumItems, arrMenuChoices[k][0]);
+            if (row != -1) {
+                ReceiptLine receiptLine; // The order line as shown on the receipt
+                receiptLine.menuIndex = arrMenuChoices[k][0];
+                receiptLine.modifierMask = arrMenuChoices[k][2];
+                receiptLine.itemName = orderLineName(arrMenuContent, model, row, arrMenuChoices[k][2]);
+                receiptLine.itemPrice = orderLinePrice(*ud.pinnedPrices, arrMenuContent, model, row, arrMenuChoices[k][2]);
+                receiptLine.preparationTime = stoi(arrMenuContent[row][MENU_PREP_TIME]);
+                receiptLine.quantity = arrMenuChoices[k][1];
+                ud.cart.push_back(receiptLine);
+            }
+        }
+
+        // Clean up dynamically allocated memory
+        for (int i = 0; i < capacity; i++)
+            delete[] arrMenuChoices[i];
+        delete[] arrMenuChoices;
+
+        // Ask the customer if they want to proceed to payment or reorder
+        char proceedChoice = promptChoice("\n/// Would you like to proceed to make payment?\n"
+                                          "[1] Make payment\n"
+                                          "[2] Re-order\n", "12");
+
+        // Handle the proceed choice: either redirect to payment or reorder
+        if (proceedChoice == '1') {
+            cout << "\n/// Redirecting to Make Payment...\n";
+            makePayments(ud); // Call the makePayments function
+        } else {
+            cout << "\n/// Redirecting to Order Online again...\n";
+            orderOnline(ud); // Recurse to allow another order
+        }
+    }
+}
+
+// Function to let the customer choose the options of a menu item
+// The customer picks exactly one size (if the item has sizes) and any number of add-ons
+// Returns the chosen options as a mask with one bit per modifier of the item
+int chooseModifiers(string** arrMenuContent, const MenuModel& model, int row) {
+    int modifierMask = 0; // The options chosen so far
+    uint32_t first = model.modifierStart[row]; // First modifier of the item
+    uint32_t last = model.modifierStart[row + 1]; // End of the item's modifiers
+    vector<int> sizes; // Positions (within the item's modifiers) of the size options
+    char choice = 'N'; // Whether the customer wants an add-on
+
+    for (uint32_t k = first; k < last; k++) {
+        if (model.modifiers[k].kind == 'S')
+            sizes.push_back(k - first);
+    }
+
+    // Ask for the size if the item comes in different sizes
+    if (!sizes.empty()) {
+        int sizeChoice = 0;
+        cout << "\n=> Please choose the size of " << arrMenuContent[row][MENU_NAME] << ":\n";
+        for (size_t i = 0; i < sizes.size(); i++) {
+            const MenuModifier& size = model.modifiers[first + sizes[i]];
+            cout << "[" << i + 1 << "] " << size.name << " (" << (size.priceDelta < Money{0} ? "-$" : "+$")
+                 << abs(size.priceDelta) << ")\n";
+        }
+
+        // Validate the size choice
+        while (!readInt(sizeChoice) || sizeChoice < 1 || sizeChoice > (int)sizes.size()) {
+            cout << "/// Sorry, that is not a valid selection. Please try again!\n";
+            cout << "=> Please choose the size (1 - " << sizes.size() << "): ";
+        }
+        modifierMask |= 1 << sizes[sizeChoice - 1];
+    }
+
+    // Offer each add-on in turn
+    for (uint32_t k = first; k < last; k++) {
+        if (model.modifiers[k].kind != 'A')
+            continue;
+
+        cout << "=> Add " << model.modifiers[k].name << " (" << (model.modifiers[k].priceDelta < Money{0} ? "-$" : "+$")
+             << abs(model.modifiers[k].priceDelta) << ")? [Y/N] ";
+        choice = readChoice();
+
+        // Validate the add-on choice
+        while (choice != 'Y' && choice != 'y' && choice != 'N' && choice != 'n') {
+            cout << "\n/// Sorry, that is not a valid selection. Please try again!";
+            cout << "\n=> Add " << model.modifiers[k].name << "? [Y/N] ";
+            choice = readChoice();
+        }
+        if (choice == 'Y' || choice == 'y')
+            modifierMask |= 1 << (k - first);
+    }
+
+    return modifierMask; // Return the chosen options
+}
+
+// Function to process the payment for the customer's order
+void makePayments(UserDetails& ud) {
+    // If no items have been ordered, prompt the user to make an order
+    if (ud.cart.empty()) {
+        cout << "\n/// You have not made any orders yet!.\n";
+        cout << "/// Redirecting to Order Online...\n";
+        orderOnline(ud); // If no orders are made, redirect to the ordering page
+    } else {
+        int previousOrders = countPreviousOrders(ud); // Number of orders the customer made before (0 for a newcomer)
+
+        // Get the menu and promotions of the current branch
+        shared_ptr<BranchCatalog> catalog = loadBranchCatalog(currentBranchId);
+
+        int numbering = 0; // Number of the order line on the receipt
+        Money totalPayment; // Total payment due
+        int totalPrepTime = 0; // Total preparation time for all ordered items
+        int deliveryTime = 0; // Estimated delivery time
+        string deliveryAreaNum; // The number representing the delivery area
+        string deliveryArea; // The name of the delivery area
+
+        // Ordered items, kept to price the order and to record it in the order history once it is paid
+        vector<int> orderedMenuIndices;
+        vector<string> orderedItemNames;
+        vector<int> orderedQuantities;
+        vector<CartLine> cartLines;
+        vector<string> ticketItems; // Items as they are shown on the kitchen ticket
+
+        // Calculate the estimated delivery time based on the delivery area number
+        deliveryTime = calcEstDeliveryTime(ud.cart, deliveryAreaNum, totalPrepTime);
+        deliveryArea = deliveryAreaName(deliveryAreaNum[0]);
+
+        // Display the payment page header
+        cout << "\n*************************** PAYMENT PAGE ***************************\n";
+        cout << "\n/// You are now Making Payment.\n";
+
+        // Display receipt header
+        cout << "\n=================================================================\n";
+        cout << "============================ RECEIPT ============================\n";
+        cout << "=================================================================\n\n";
+        cout << "NO.  ITEM NAME\t\t      ITEM PRICE\tQUANTITY\tPREPARATION TIME";
+        cout << "\n---------------------------------------------------------------------------------\n";
+
+        // The cart's reservation holds the stock of the order while it is paid for
+        int orderId = ud.orderId; // The cart being paid for
+        shared_ptr<const PriceSnapshot> pinnedPrices = ud.pinnedPrices; // Prices the order was priced at
+        string datetime = ud.orderedAt; // Date and time of the order
+        vector<ReceiptLine> cart; // The lines of the order
+        cart.swap(ud.cart);
+        ud.orderId = 0;
+        ud.pinnedPrices = nullptr;
+
+        // Price the order at the prices it was pinned to, then go through each line to display order details
+        cartLines = priceReceiptLines(cart, *pinnedPrices, *catalog);
+        for (size_t i = 0; i < cart.size(); i++) {
+            // Display the item details in a formatted manner
+            cout << ++numbering << ") " << left << setw(25) << cart[i].itemName;
+            cout << "\t$" << cartLines[i].unitPrice;
+            cout << "\t\t" << cart[i].quantity;
+            cout << "\t\t" << cart[i].preparationTime << " minutes\n";
+
+            // Keep the item for the order history
+            orderedMenuIndices.push_back(cart[i].menuIndex);
+            orderedItemNames.push_back(cart[i].itemName);
+            orderedQuantities.push_back(cart[i].quantity);
+            ticketItems.push_back(to_string(cart[i].quantity) + " x " + cart[i].itemName);
+        }
+
+        // Calculate the total payment based on the ordered items
+        totalPayment = calcTotalPaymentsPerOrder(cartLines);
+
+        // Apply the promotions of the branch (item deals, happy hours, newcomer and loyalty discounts)
+        PricedCart pricedCart = priceCart(catalog->promotions, catalog->model, cartLines, previousOrders, time(0));
+        if (previousOrders > 0)
+            cout << "\nThanks for dining with us again, " << ud.customerName << "! :) \n";
+        if (pinnedPrices->version != catalog->prices->version)
+            cout << "\n/// Prices have changed since you started your order. You pay the prices you ordered at.\n";
+        for (size_t rule = 0; rule < pricedCart.ruleSavings.size(); rule++) {
+            if (pricedCart.ruleSavings[rule] > Money{0}) {
+                cout << "\nCongratulations! You are entitled to " << catalog->promotions.ruleNames[rule] << " :)\n";
+                cout << "You save: $" << pricedCart.ruleSavings[rule] << "\n";
+            }
+        }
+        totalPayment = pricedCart.total; // Deduct the discounts from the total payment
+
+        // Display final order details, including total payment, preparation time, and delivery information
+        cout << "\n==================== ORDER DETAILS ====================\n";
+        cout << setw(30) << "\nTOTAL PAYMENT: " << "$" << totalPayment;
+        cout << setw(30) << "\nFOOD PREPARATION TIME: " << totalPrepTime << " minutes";
+        cout << setw(30) << "\nDELIVERY AREA: " << deliveryArea;
+        cout << setw(30) << "\nTOTAL DELIVERY TIME: " << deliveryTime << " minutes. \nThank you for your patience!\t";
+        cout << setw(30) << "\n\nDATE & TIME OF ORDER: " << datetime;
+        cout << "\n=================================================================\n";
+
+        // Take the payment, with one tender or split across several
+        Money amountPaid; // Part of the payment settled
+        bool paid = takePayments(orderId, totalPayment, amountPaid);
+
+        // Deduct the stock of the order now that it is paid for (this uses up the cart's reservation)
+        int unavailableItem = 0; // Menu index of an item no longer available (or STOCK_NOT_SAVED)
+        if (paid)
+            unavailableItem = commitOrderStock(orderId, orderedMenuIndices, orderedQuantities);
+        else
+            releaseReservation(orderId);
+
+        // An order that does not go ahead is cancelled; anything already paid is left for the staff to refund
+        if (!paid || unavailableItem != 0) {
+            if (unavailableItem == STOCK_NOT_SAVED)
+                cout << "\n/// Sorry, your order could not be saved.\n";
+            else if (unavailableItem != 0)
+                cout << "\n/// Sorry, item #" << unavailableItem << " is no longer available in the quantity you ordered.\n"
+                     << "/// (Items in a cart are only kept for " << RESERVATION_TTL_SECONDS / 60 << " minutes.)\n";
+            cout << "\n/// Your order has been cancelled and will not be sent to the kitchen.\n";
+            if (amountPaid > Money{0}) {
+                cout << "/// Please ask a member of staff for a refund of the $" << amountPaid << " you have paid.\n";
+                vector<EventRecord> events;
+                addEvent(events, EVENT_ORDER_CANCELLED, orderId, 0, 0, amountPaid.cents);
+                queueEvents(events);
+            }
+            cout << "/// Redirecting to Order Online...\n";
+            orderOnline(ud);
+            return;
+        }
+
+        // Append the amount charged (after the discounts) to the total sales file, so the sales match the payments
+        queueAppend(dataPath("total_sales.txt"), totalPayment.str() + "\n");
+
+        // Update the customer's profile (visits, spend, favourite item)
+        recordCustomerOrder(ud, time(0), totalPayment, orderedMenuIndices, orderedQuantities);
+
+        // Record the paid order in the order history used by the sales reports
+        recordOrderHistory(time(0), deliveryAreaNum[0], previousOrders == 0,
+                           orderedMenuIndices, orderedItemNames, orderedQuantities, pricedCart.lineRevenue);
+
+        // Announce the payment in the event stream
+        vector<EventRecord> events;
+        addEvent(events, EVENT_PAYMENT_COMPLETED, orderId, 0, (int)orderedMenuIndices.size(), totalPayment.cents);
+        queueEvents(events);
+
+        // Thank the customer for their order once its records have reached their files
+        flushWrites();
+        cout << "\n/// Thank you for choosing NinjaFood! Enjoy your meal and see you again!\n";
+
+        // Send the order to the kitchen
+        submitKitchenTicket(ud, deliveryArea, ticketItems, totalPrepTime);
+        logout(); // Log the user out after payment
+    }
+}
+
+// Function to take the payment of an order, with one tender or split across several (e.g. part in cash and the
+// rest by card). The customer waits for the outcome of each payment (a payment to a slow gateway is settled by the
+// settlement threads, and other front ends carry on meanwhile); a declined or failed payment may be made again
+// with another tender, or the order cancelled. The payments are keyed by the order ID, so no payment of an order can be taken twice
+// Returns whether the whole amount was paid; amountPaid is set to the part of it settled
+bool takePayments(int orderId, Money amountDue, Money& amountPaid) {
+    Money remaining = amountDue; // Amount still to be paid
+    int paymentNo = 0; // Number of payments taken for the order so far
+    string strAmount; // Amount to pay with the chosen tender, as entered
+    Money amount; // Amount to pay with the chosen tender
+
+    // List the tenders, numbered from 1
+    string tenderPrompt = "\n=> Please choose how to pay:\n";
+    string tenderChoices; // The numbers of the tenders
+    for (int tender = 0; tender < NUM_OF_TENDERS; tender++) {
+        tenderPrompt += "[" + to_string(tender + 1) + "] " + TENDERS[tender].name + "\n";
+        tenderChoices += (char)('1' + tender);
+    }
+
+    while (remaining > Money{0}) {
+        cout << "\n/// AMOUNT DUE: $" << remaining << "\n";
+        Payment payment;
+        payment.tender = promptChoice(tenderPrompt, tenderChoices) - '1';
+        const TenderSpec& spec = TENDERS[payment.tender];
+
+        // Ask for the amount; paying less than is due leaves the rest to be paid with another tender
+        cout << "=> Please enter the amount to pay by " << spec.name << ": $";
+        strAmount = readToken();
+        while (!parseMoney(strAmount, amount) || amount <= Money{0} || (!spec.givesChange && amount > remaining)) {
+            if (!parseMoney(strAmount, amount) || amount <= Money{0})
+                cout << "/// The amount must be more than zero, with at most two decimals. Please try again.\n";
+            else
+                cout << "/// Sorry, a " << spec.name << " payment cannot be more than the amount due. Please try again.\n";
+            cout << "\n=> Please enter the amount to pay by " << spec.name << ": $";
+            strAmount = readToken();
+        }
+
+        // Ask for the account the payment comes from, if the tender has one
+        if (spec.reference != TenderReference::None) {
+            cout << "=> " << spec.referencePrompt << ": ";
+            payment.reference = readToken();
+            while (!validTenderReference(spec.reference, payment.reference)) {
+                cout << "/// Sorry, that is not valid. Please check it and try again.\n";
+                cout << "\n=> " << spec.referencePrompt << ": ";
+                payment.reference = readToken();
+            }
+        }
+
+        // Display the amount paid, and give change for cash handed over beyond what is due
+        cout << "\n/// PAID AMOUNT (" << spec.name << "): $" << amount;
+        if (amount > remaining) {
+            cout << "\n/// Dispensing change...";
+            cout << "\n/// CHANGE: $" << amount - remaining;
+            amount = remaining;
+        }
+        if (spec.throughGateway)
+            cout << "\n/// Your " << spec.name << " payment is being processed. Please wait...";
+        cout << "\n";
+
+        payment.key = paymentKey(orderId, ++paymentNo);
+        payment.amount = amount;
+        payment.paidAt = time(0);
+        payment.awaited = true;
+
+        PaymentState state = PaymentState::Failed; // Outcome of the payment
+        if (submitPayment(payment))
+            takeSettlement(payment.key, state, true);
+        if (state == PaymentState::Settled) {
+            remaining -= amount;
+            amountPaid += amount;
+            continue;
+        }
+
+        // Let the customer pay the rest another way, or cancel the order
+        cout << "\n/// Sorry, your " << spec.name << " payment was "
+             << (state == PaymentState::Declined ? "declined." : "not completed. Please try again later.") << "\n";
+        if (promptChoice("\n=> Please choose:\n[1] Pay another way\n[2] Cancel the order\n", "12") == '2')
+            return false;
+    }
+    return true;
+}
+
+// Function to check the account a customer names when paying: a card number must have 12 to 19 digits and pass
+// the Luhn check (which catches a mistyped digit), and an e-wallet is named by a phone number of 10 or 11 digits
+bool validTenderReference(TenderReference reference, const string& text) {
+    bool digitsOnly = !text.empty() && text.find_first_not_of("0123456789") == string::npos;
+    switch (reference) {
+        case TenderReference::CardNumber: {
+            if (!digitsOnly || text.length() < 12 || text.length() > 19)
+                return false;
+            int sum = 0; // Luhn sum: every second digit from the right is doubled
+            for (size_t i = 0; i < text.length(); i++) {
+                int digit = text[text.length() - 1 - i] - '0';
+                if (i % 2 == 1)
+                    digit = digit * 2 > 9 ? digit * 2 - 9 : digit * 2;
+                sum += digit;
+            }
+            return sum % 10 == 0;
+        }
+        case TenderReference::PhoneNumber:
+            return digitsOnly && text.length() >= 10 && text.length() <= 11;
+        default:
+            return true;
+    }
+}
+
+// Function to return the idempotency key of a payment: the kiosk process, the order and the number of the
+// payment within the order (from 1), e.g. "4711-12-2" for the second payment of order 12
+string paymentKey(int orderId, int paymentNo) {
+    long kiosk = 0; // Process ID of the kiosk
+#ifndef _WIN32
+    kiosk = getpid();
+#endif
+    return to_string(kiosk) + "-" + to_string(orderId) + "-" + to_string(paymentNo);
+}
+
+// Function to hand a payment over to the settlement threads, or to settle it straight away if they are not running
+// A payment that settles at once (cash, or a gateway that replies without delay) is settled straight away too,
+// as handing it over would only make the front end wait for a settlement thread to be scheduled
+// Returns false, doing nothing, if a payment with the same idempotency key was handed over before
+bool submitPayment(const Payment& payment) {
+    bool immediate = !TENDERS[payment.tender].throughGateway || gatewayLatencyMs() == 0; // Whether it settles at once
+    unique_lock<mutex> lock(settlements.lock);
+    if (!settlements.keys.insert(payment.key).second)
+        return false;
+    if (!settlements.started || immediate) {
+        lock.unlock();
+        recordPayment(payment, settlePayment(payment));
+        return true;
+    }
+
+    settlements.payments.push_back(payment);
+    lock.unlock();
+    settlements.notEmpty.notify_one();
+    return true;
+}
+
+// Function to start the settlement threads, which settle the payments in the background
+// (every payment taken is settled before the program exits, as the threads stop only once none are left)
+void startSettlement() {
+    {
+        lock_guard<mutex> lock(settlements.lock);
+        settlements.started = true;
+    }
+    for (int i = 0; i < SETTLEMENT_THREADS; i++)
+        startBackgroundThread(runSettlement);
+}
+
+// Function run by each settlement thread: settles the payments one at a time, oldest first, until the program
+// exits and none are left. The threads wait for the gateway's replies side by side
+void runSettlement() {
+    while (true) {
+        Payment payment; // The payment being settled
+        {
+            unique_lock<mutex> lock(settlements.lock);
+            settlements.notEmpty.wait(lock, []() { return !settlements.payments.empty() || backgroundStopping; });
+            if (settlements.payments.empty())
+                return;
+            payment = move(settlements.payments.front());
+            settlements.payments.pop_front();
+            ++settlements.settling;
+        }
+
+        recordPayment(payment, settlePayment(payment));
+
+        lock_guard<mutex> lock(settlements.lock);
+        if (--settlements.settling == 0 && settlements.payments.empty())
+            settlements.drained.notify_all();
+    }
+}
+
+// Function to wait until every payment handed over so far has been settled and recorded
+void flushSettlements() {
+    unique_lock<mutex> lock(settlements.lock);
+    if (!settlements.started)
+        return;
+    settlements.drained.wait(lock, []() { return settlements.payments.empty() && settlements.settling == 0; });
+}
+
+// Function to take the outcome of an awaited payment (see Payment) once it has been settled, waiting for it if
+// wait is set. Returns false if the payment has not been settled yet (only when not waiting)
+bool takeSettlement(const string& key, PaymentState& state, bool wait) {
+    unique_lock<mutex> lock(settlements.lock);
+    if (wait)
+        settlements.settled.wait(lock, [&]() { return settlements.outcomes.count(key) > 0; });
+
+    auto found = settlements.outcomes.find(key);
+    if (found == settlements.outcomes.end())
+        return false;
+    state = found->second;
+    settlements.outcomes.erase(found);
+    return true;
+}
+
+// Function to settle one payment: cash is settled as it is, and card and e-wallet payments are charged through the
+// payment gateway. When a reply is lost the charge is sent again with the same idempotency key (so it is never made
+// twice), up to SETTLEMENT_ATTEMPTS times; a payment the gateway never answers is left for the manager to follow up
+PaymentState settlePayment(const Payment& payment) {
+    if (!TENDERS[payment.tender].throughGateway)
+        return PaymentState::Settled;
+
+    PaymentState outcome = PaymentState::Failed; // What the gateway replied
+    for (int attempt = 0; attempt < SETTLEMENT_ATTEMPTS; attempt++) {
+        if (gatewayCharge(payment, outcome))
+            return outcome;
+    }
+    return PaymentState::Failed;
+}
+
+// Function to send a charge to the local stand-in for the payment gateway and wait for its reply
+// GATEWAY_DECLINED_CARD is declined, and every other charge goes through. Returns false if the reply was lost
+// (the kiosk then does not know the outcome, although the charge was made)
+bool gatewayCharge(const Payment& payment, PaymentState& outcome) {
+    // The round trip to the gateway (other charges are sent meanwhile)
+    this_thread::sleep_for(chrono::milliseconds(gatewayLatencyMs()));
+
+    lock_guard<mutex> lock(paymentGateway.lock);
+    auto found = paymentGateway.charges.find(payment.key);
+    if (found == paymentGateway.charges.end()) {
+        PaymentState state = payment.reference == GATEWAY_DECLINED_CARD ? PaymentState::Declined : PaymentState::Settled;
+        found = paymentGateway.charges.emplace(payment.key, state).first;
+        if (state == PaymentState::Settled)
+            paymentGateway.chargedCents += payment.amount.cents;
+    }
+    if ((int)(paymentGateway.generator() % 100) < paymentGateway.lostPercent) {
+        ++paymentGateway.numOfLostReplies;
+        return false;
+    }
+    outcome = found->second;
+    return true;
+}
+
+// Function to return the time each reply of the payment gateway takes (milliseconds), reading the gateway's
+// settings from the environment the first time it is called
+int gatewayLatencyMs() {
+    lock_guard<mutex> lock(paymentGateway.lock);
+    if (!paymentGateway.configured) {
+        const char* latency = getenv("NINJAFOOD_GATEWAY_LATENCY_MS");
+        const char* lost = getenv("NINJAFOOD_GATEWAY_LOST_PERCENT");
+        paymentGateway.latencyMs = latency != nullptr ? max(atoi(latency), 0) : 0;
+        paymentGateway.lostPercent = lost != nullptr ? min(max(atoi(lost), 0), 100) : 0;
+        paymentGateway.configured = true;
+    }
+    return paymentGateway.latencyMs;
+}
+
+// Function to add a settled payment to the payment ledger of the current branch (through the persistence thread),
+// and to pass its outcome on to the front end if it is waiting for it
+// Payment ledger structure: paidAt, key, tender, account (all but its last 4 digits hidden), amount, outcome
+void recordPayment(const Payment& payment, PaymentState state) {
+    string account = payment.reference; // The account paid from, as written to the ledger
+    if (account.length() > 4)
+        account = string(account.length() - 4, '*') + account.substr(account.length() - 4);
+
+    queueAppend(dataPath("payments.txt"), to_string((long long)payment.paidAt) + "," + payment.key + ","
+                + TENDERS[payment.tender].name + "," + account + "," + payment.amount.str() + ","
+                + paymentStateName(state) + "\n");
+
+    lock_guard<mutex> lock(settlements.lock);
+    ++settlements.numOfPayments[(int)state];
+    if (payment.awaited) {
+        settlements.outcomes[payment.key] = state;
+        settlements.settled.notify_all();
+    }
+}
+
+// Function to return the name of a payment outcome, as written to the payment ledger
+string paymentStateName(PaymentState state) {
+    switch (state) {
+        case PaymentState::Settled: return "SETTLED";
+        case PaymentState::Declined: return "DECLINED";
+        default: return "FAILED";
+    }
+}
+
+// Function to collect the customer's details and count how many orders they made before (0 for a newcomer)
+// The count comes from the customer's profile, looked up by phone number
+int countPreviousOrders(UserDetails& ud) {
+    string phoneNumber;
+
+    // Display introductory message to collect customer details
+    cout << "\n********************** CUSTOMER DETAILS PAGE **********************\n";
+    cout << "\n/// We require your details to ensure we deliver the correct order to the right person and address!\n";
+
+    // Clear the input buffer before collecting data
+
+    // Prompt the customer to enter their name
+    cout << "\n=> Please enter your details to proceed.\n"
+         << "\n=> Name: ";
+    ud.customerName = readLine(); // Read the customer's name
+
+    // Prompt the customer to enter their phone number
+    cout << "\n=> Phone number (eg 0123456789): ";
+    phoneNumber = readLine(); // Read the phone number
+
+    // Validate phone number (it should be 10 to 11 digits)
+    while (phoneNumber.length() < 10 || phoneNumber.length() > 11 || phoneNumber.find_first_not_of("0123456789") != string::npos) {
+        cout << "\nInvalid phone number! Please try again.\n";
+        cout << "=> Phone number (eg 0123456789): ";
+        phoneNumber = readLine(); // Prompt the user again for a valid phone number
+    }
+
+    ud.phoneNumber = phoneNumber;
+
+    // Return the number of earlier orders from the customer's profile (0 means the customer is a newcomer)
+    // (the profile is created or updated once the order is paid)
+    return customerVisitCount(phoneNumber);
+}
+
+// Function to return the number of paid orders of a customer, as the profile file has it now (another kiosk of
+// the branch may have recorded an order of theirs since this kiosk last read it); 0 for a customer without a profile
+uint32_t customerVisitCount(string phoneNumber) {
+    loadCustomerProfiles(customerProfiles);
+    lockCustomerProfiles(customerProfiles); // Keeps the profile from being read half written
+    int position = refreshCustomerProfile(customerProfiles, customerPhoneKey(phoneNumber));
+    unlockCustomerProfiles(customerProfiles);
+    return position == -1 ? 0 : customerProfiles.profiles[position].visitCount;
+}
+
+// Function to pack a phone number (10 or 11 digits) into a number, keeping leading zeros distinct
+// by storing the number of digits in the top bits
+uint64_t customerPhoneKey(string phoneNumber) {
+    uint64_t key = 0;
+    for (char digit : phoneNumber)
+        key = key * 10 + (digit - '0');
+    return key | (uint64_t)phoneNumber.length() << 56;
+}
+
+// Function to read the customer profiles of the current branch into memory (only once per run)
+// Profile file structure: an 8-byte header followed by one 48-byte CustomerProfile record per customer
+// Name heap structure: the names of all customers back to back, found by each profile's offset and length
+// A branch without profiles gets them from its old customer records (one name,phone line per order)
+// The file is read under its lock, so a kiosk never sees another one's import half done. The profile file and its
+// lock file are then kept open, as every paid order reads and writes a profile
+void loadCustomerProfiles(CustomerProfileStore& store) {
+    if (store.loaded)
+        return;
+    store.loaded = true;
+
+    string profilePath = dataPath("customer_profiles.dat"); // The profile file
+    string namePath = dataPath("customer_names.dat"); // The name heap file
+#ifndef _WIN32
+    store.lockDescriptor = open(dataPath("customer_profiles.lock").c_str(), O_RDWR | O_CREAT, 0644);
+#endif
+    lockCustomerProfiles(store); // Held until the profiles are read (or imported)
+
+    if (readCustomerProfiles(profilePath, store.profiles)) {
+        store.profileOfPhone.reserve(store.profiles.size());
+        for (uint32_t i = 0; i < store.profiles.size(); i++)
+            store.profileOfPhone[store.profiles[i].phoneKey] = i;
+    } else {
+        // Start a new profile file, importing the old customer records if there are any
+        ofstream(profilePath, ios::binary).write("NFPROF\0\1", 8);
+        ofstream(namePath, ios::binary | ios::trunc);
+        uint32_t nameHeapSize = 0; // Size of the name heap file
+
+        ifstream records(dataPath("customer_record.txt"));
+        string name; // Customer name of a record
+        string phoneNumber; // Phone number of a record
+        ofstream nameHeap(namePath, ios::binary | ios::app);
+        while (getline(records, name, ',') && getline(records, phoneNumber)) {
+            if (phoneNumber.length() < 10 || phoneNumber.length() > 11 || phoneNumber.find_first_not_of("0123456789") != string::npos)
+                continue;
+
+            uint64_t key = customerPhoneKey(phoneNumber);
+            auto found = store.profileOfPhone.find(key);
+            if (found == store.profileOfPhone.end()) {
+                CustomerProfile profile = {};
+                profile.phoneKey = key;
+                profile.nameOffset = nameHeapSize;
+                profile.nameLength = name.length();
+                nameHeap.write(name.data(), name.length());
+                nameHeapSize += name.length();
+                found = store.profileOfPhone.emplace(key, store.profiles.size()).first;
+                store.profiles.push_back(profile);
+            }
+            ++store.profiles[found->second].visitCount; // Each record was one order (its amount was not recorded)
+        }
+        nameHeap.close();
+
+        ofstream profileFile(profilePath, ios::binary | ios::app);
+        profileFile.write((const char*)store.profiles.data(), store.profiles.size() * sizeof(CustomerProfile));
+    }
+
+    store.file.open(profilePath, ios::in | ios::out | ios::binary);
+    unlockCustomerProfiles(store);
+}
+
+// Function to take the file lock of the customer profiles of the current branch, which is held while a profile is
+// read and written back (and while the name heap is added to), so kiosks paying at the same time never write over
+// each other's profiles (where file locks are not available, only one kiosk should run per branch)
+void lockCustomerProfiles(CustomerProfileStore& store) {
+#ifndef _WIN32
+    if (store.lockDescriptor >= 0)
+        flock(store.lockDescriptor, LOCK_EX);
+#endif
+}
+
+// Function to release the file lock of the customer profiles
+void unlockCustomerProfiles(CustomerProfileStore& store) {
+#ifndef _WIN32
+    if (store.lockDescriptor >= 0)
+        flock(store.lockDescriptor, LOCK_UN);
+#endif
+}
+
+// Function to bring the loaded customer profiles up to date with the profile file (the caller holds its lock):
+// the profiles other kiosks have added since are read, and the profile of the given phone number is read again
+// Returns the position of that profile, or -1 if the customer has no profile yet
+int refreshCustomerProfile(CustomerProfileStore& store, uint64_t phoneKey) {
+    fstream& file = store.file; // The profile file (each seek drops what was buffered from it)
+    file.clear();
+    file.seekg(0, ios::end);
+    streamoff fileSize = file.tellg(); // Size of the profile file (-1 if it could not be opened)
+    size_t numOfProfiles = fileSize < 8 ? 0 : (fileSize - 8) / sizeof(CustomerProfile); // Whole records in the file
+
+    // Read the profiles added since (a record cut short by a crash is ignored)
+    size_t numOfKnown = store.profiles.size(); // Profiles already in memory
+    if (numOfProfiles > numOfKnown) {
+        store.profiles.resize(numOfProfiles);
+        file.seekg(8 + (streamoff)numOfKnown * sizeof(CustomerProfile));
+        if (file.read((char*)&store.profiles[numOfKnown], (numOfProfiles - numOfKnown) * sizeof(CustomerProfile))) {
+            for (size_t i = numOfKnown; i < numOfProfiles; i++)
+                store.profileOfPhone[store.profiles[i].phoneKey] = i;
+        } else {
+            store.profiles.resize(numOfKnown);
+            file.clear();
+        }
+    }
+
+    auto found = store.profileOfPhone.find(phoneKey);
+    if (found == store.profileOfPhone.end())
+        return -1;
+
+    // Read the customer's profile again, with the orders other kiosks have recorded since
+    if (found->second < numOfKnown && found->second < numOfProfiles) {
+        CustomerProfile profile; // The profile as the file has it
+        file.seekg(8 + (streamoff)found->second * sizeof(CustomerProfile));
+        if (file.read((char*)&profile, sizeof(CustomerProfile)) && profile.phoneKey == phoneKey)
+            store.profiles[found->second] = profile;
+        file.clear();
+    }
+    return found->second;
+}
+
+// Function to read every record of a profile file; returns false if the file does not exist or is not a profile file
+bool readCustomerProfiles(string path, vector<CustomerProfile>& profiles) {
+    char header[8] = {}; // File type marker, "NFPROF" followed by the format version
+    ifstream file(path, ios::binary);
+    file.read(header, sizeof(header));
+    if (!file || memcmp(header, "NFPROF\0\1", sizeof(header)) != 0)
+        return false;
+
+    // Read all records in one go (a record cut short by a crash is ignored)
+    error_code error;
+    uintmax_t numOfProfiles = (filesystem::file_size(path, error) - sizeof(header)) / sizeof(CustomerProfile);
+    profiles.resize(error ? 0 : numOfProfiles);
+    file.read((char*)profiles.data(), profiles.size() * sizeof(CustomerProfile));
+    return true;
+}
+
+// Function to write one profile back to its place in the profile file, without rewriting the rest
+// (the caller holds the file's lock; the profile reaches the file before it is released)
+void writeCustomerProfile(CustomerProfileStore& store, uint32_t position) {
+    store.file.clear();
+    store.file.seekp(8 + (streamoff)position * sizeof(CustomerProfile));
+    store.file.write((const char*)&store.profiles[position], sizeof(CustomerProfile));
+    store.file.flush();
+}
+
+// Function to read a customer's name from a name heap file
+string readCustomerName(string path, const CustomerProfile& profile) {
+    string name(profile.nameLength, '\0');
+    ifstream file(path, ios::binary);
+    file.seekg(profile.nameOffset);
+    file.read(&name[0], name.length());
+    return file ? name : "";
+}
+
+// Function to update the customer's profile once their order is paid: visit count, lifetime spend,
+// last order time and favourite item. A new customer gets a new profile at the end of the profile file
+// The profile is read again and written back under the profile file's lock, so the orders other kiosks record
+// for the same customer at the same time are all counted, and a new profile or name goes where the file ends
+// The favourite item is tracked with a running count: items of the order add to the count of the
+// current favourite or take away from it, and an item that brings the count below zero takes over
+void recordCustomerOrder(UserDetails& ud, time_t paidAt, Money amountPaid, const vector<int>& menuIndices, const vector<int>& quantities) {
+    loadCustomerProfiles(customerProfiles);
+    lockCustomerProfiles(customerProfiles); // Held until the profile is written back
+
+    uint64_t key = customerPhoneKey(ud.phoneNumber);
+    int position = refreshCustomerProfile(customerProfiles, key); // Position of the profile in the profile file
+    if (position == -1) {
+        position = customerProfiles.profiles.size();
+        customerProfiles.profileOfPhone[key] = position;
+        customerProfiles.profiles.push_back(CustomerProfile());
+        customerProfiles.profiles.back().phoneKey = key;
+    }
+    CustomerProfile& profile = customerProfiles.profiles[position];
+
+    // Store the name at the end of the name heap if it is new or has changed
+    string namePath = dataPath("customer_names.dat"); // The name heap file
+    if (profile.nameLength != ud.customerName.length() || readCustomerName(namePath, profile) != ud.customerName) {
+        error_code error; // Set (instead of throwing) when the name heap does not exist
+        uintmax_t nameHeapSize = filesystem::file_size(namePath, error);
+        ofstream nameHeap(namePath, ios::binary | ios::app);
+        nameHeap.write(ud.customerName.data(), ud.customerName.length());
+        profile.nameOffset = error ? 0 : nameHeapSize;
+        profile.nameLength = ud.customerName.length();
+    }
+
+    ++profile.visitCount;
+    profile.lifetimeSpend += amountPaid.cents;
+    profile.lastOrderTime = paidAt;
+
+    for (size_t i = 0; i < menuIndices.size(); i++) {
+        if (menuIndices[i] == profile.favouriteItem) {
+            profile.favouriteWeight += quantities[i];
+        } else if (profile.favouriteWeight < quantities[i]) {
+            profile.favouriteWeight = quantities[i] - profile.favouriteWeight;
+            profile.favouriteItem = menuIndices[i];
+        } else {
+            profile.favouriteWeight -= quantities[i];
+        }
+    }
+
+    writeCustomerProfile(customerProfiles, position);
+    unlockCustomerProfiles(customerProfiles);
+}
+
+// Function to return the name of a delivery area from its number (from '1'; any other number gives the last area)
+string deliveryAreaName(char deliveryAreaNum) {
+    int area = deliveryAreaNum - '1';
+    if (area < 0 || area >= NUM_OF_DELIVERY_AREAS)
+        area = NUM_OF_DELIVERY_AREAS - 1;
+    return DELIVERY_AREAS[area].name;
+}
+
+// Function to append a paid order to the order history of the current branch, one line per ordered item
+// Order history structure: paidAt, deliveryArea, customerType (N = newcomer, R = returning), menuIndex, quantity, lineRevenue, itemName
+// The line revenue is the amount actually paid for the item, i.e. after its share of every discount
+void recordOrderHistory(time_t paidAt, char deliveryAreaNum, bool newcomer, const vector<int>& menuIndices,
+                        const vector<string>& itemNames, const vector<int>& quantities, const vector<Money>& lineRevenue) {
+    ostringstream historyLines; // The lines to append to the order history
+
+    for (size_t i = 0; i < menuIndices.size(); i++) {
+        historyLines << (long long)paidAt << "," << deliveryAreaNum << "," << (newcomer ? 'N' : 'R') << ","
+                     << menuIndices[i] << "," << quantities[i] << ","
+                     << lineRevenue[i] << "," << itemNames[i] << "\n";
+    }
+
+    queueAppend(dataPath("order_history.txt"), historyLines.str());
+}
+
+// Function to compile the promotions file of a branch into a promotion plan for its menu
+// Promotions structure (one rule per line): kind, name, then the settings of that kind of rule
+//      NEWCOMER,name,percent                  LOYALTY,name,minOrders,percent
+//      HAPPYHOUR,name,HH:MM,HH:MM,percent[,category]
+//      ITEM,name,itemNo,percent               CATEGORY,name,category,percent
+//      BUYXGETY,name,itemNo,buy,free
+// Rules that are not valid (or refer to items or categories not on the menu) are skipped
+// Without a promotions file, the plan only holds the standard 10% newcomer discount
+void compilePromotions(string path, string** arrMenuContent, int totalNumItems, const MenuModel& model, PromotionPlan& plan) {
+    string line; // One rule of the promotions file
+    vector<string> fields; // The comma separated settings of the rule
+
+    plan = PromotionPlan();
+    plan.rowPercent.assign(totalNumItems, 0);
+    plan.rowPercentRule.assign(totalNumItems, 0);
+    plan.rowBuyQuantity.assign(totalNumItems, 0);
+    plan.rowFreeQuantity.assign(totalNumItems, 0);
+    plan.rowDealRule.assign(totalNumItems, 0);
+
+    ifstream file(path);
+    if (!file) {
+        plan.ruleNames.push_back("10% Newcomer Discount");
+        plan.newcomerPercent = 10;
+        return;
+    }
+
+    while (getline(file, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        fields.clear();
+        stringstream ruleText(line);
+        string field;
+        while (getline(ruleText, field, ','))
+            fields.push_back(field);
+        if (fields.size() < 3 || plan.ruleNames.size() >= UINT16_MAX)
+            continue;
+
+        string kind = fields[0];
+        transform(kind.begin(), kind.end(), kind.begin(), ::toupper);
+        uint16_t rule = plan.ruleNames.size(); // Number the rule would get
+        bool valid = false; // Whether the rule was understood and added to the plan
+
+        // Read a whole number setting, rejecting anything that is not entirely digits
+        auto number = [&](size_t i, int low, int high, int& value) {
+            if (i >= fields.size() || fields[i].empty() || fields[i].length() > 9
+                || fields[i].find_first_not_of("0123456789") != string::npos)
+                return false;
+            value = stoi(fields[i]);
+            return value >= low && value <= high;
+        };
+        int percent = 0, visits = 0, menuIndex = 0, buyQuantity = 0, freeQuantity = 0, start = 0, end = 0;
+
+        if (kind == "NEWCOMER" && number(2, 1, 100, percent)) {
+            if (percent > plan.newcomerPercent) {
+                plan.newcomerPercent = percent;
+                plan.newcomerRule = rule;
+            }
+            valid = true;
+        } else if (kind == "LOYALTY" && number(2, 1, INT32_MAX, visits) && number(3, 1, 100, percent)) {
+            plan.loyaltyTiers.push_back({visits, (uint8_t)percent, rule});
+            valid = true;
+        } else if (kind == "HAPPYHOUR" && fields.size() >= 5 && parseTimeOfDay(fields[2], start)
+                   && parseTimeOfDay(fields[3], end) && number(4, 1, 100, percent)) {
+            int category = -1; // Every item, unless a category is given
+            if (fields.size() >= 6 && !fields[5].empty()) {
+                auto found = find(model.categories.begin() + 1, model.categories.end(), fields[5]);
+                category = found == model.categories.end() ? -2 : (int)(found - model.categories.begin());
+            }
+            if (category != -2) {
+                plan.happyHours.push_back({start, end, category, (uint8_t)percent, rule});
+                valid = true;
+            }
+        } else if (kind == "ITEM" && number(2, 1, INT32_MAX, menuIndex) && number(3, 1, 100, percent)) {
+            int row = findMenuRow(arrMenuContent, totalNumItems, menuIndex);
+            if (row != -1) {
+                if (percent > plan.rowPercent[row]) {
+                    plan.rowPercent[row] = percent;
+                    plan.rowPercentRule[row] = rule;
+                }
+                valid = true;
+            }
+        } else if (kind == "CATEGORY" && number(3, 1, 100, percent)) {
+            // Resolve the category to its rows now, so checkout never compares category names
+            for (int row = 0; row < totalNumItems; row++) {
+                if (model.itemCategory[row] != 0 && model.categories[model.itemCategory[row]] == fields[2]) {
+                    if (percent > plan.rowPercent[row]) {
+                        plan.rowPercent[row] = percent;
+                        plan.rowPercentRule[row] = rule;
+                    }
+                    valid = true;
+                }
+            }
+        } else if (kind == "BUYXGETY" && number(2, 1, INT32_MAX, menuIndex) && number(3, 1, 1000, buyQuantity) && number(4, 1, 1000, freeQuantity)) {
+            int row = findMenuRow(arrMenuContent, totalNumItems, menuIndex);
+            if (row != -1) {
+                // Keep the more generous deal (the larger share of free units) if an item has several
+                bool better = plan.rowBuyQuantity[row] == 0
+                              || freeQuantity * (plan.rowBuyQuantity[row] + plan.rowFreeQuantity[row]) > plan.rowFreeQuantity[row] * (buyQuantity + freeQuantity);
+                if (better) {
+                    plan.rowBuyQuantity[row] = buyQuantity;
+                    plan.rowFreeQuantity[row] = freeQuantity;
+                    plan.rowDealRule[row] = rule;
+                }
+                valid = true;
+            }
+        }
+
+        if (valid)
+            plan.ruleNames.push_back(fields[1]);
+    }
+
+    // Check the highest loyalty tier first, so the first tier reached is the best one
+    sort(plan.loyaltyTiers.begin(), plan.loyaltyTiers.end(),
+         [](const LoyaltyTier& a, const LoyaltyTier& b) { return a.minVisits > b.minVisits; });
+}
+
+// Function to parse a time of day such as "14:30" into minutes after midnight
+bool parseTimeOfDay(string text, int& minutes) {
+    if (text.length() != 5 || text[2] != ':' || !isdigit((unsigned char)text[0]) || !isdigit((unsigned char)text[1])
+        || !isdigit((unsigned char)text[3]) || !isdigit((unsigned char)text[4]))
+        return false;
+
+    int hour = stoi(text.substr(0, 2));
+    int minute = stoi(text.substr(3, 2));
+    if (hour > 23 || minute > 59)
+        return false;
+
+    minutes = hour * 60 + minute;
+    return true;
+}
+
+// Function to apply a promotion plan to a cart
+// Each line gets the best of its item, category, happy-hour and buy-X-get-Y discounts, then the best of the
+// newcomer and loyalty discounts is taken off the rest of the order and shared out over the lines
+// in proportion to their price (the last line takes what is left, so the lines add up exactly)
+PricedCart priceCart(const PromotionPlan& plan, const MenuModel& model, const vector<CartLine>& lines, int previousOrders, time_t now) {
+    PricedCart cart; // The priced cart
+    vector<Money> lineDiscount(lines.size()); // Item discount of each line
+    Money itemDiscount; // Total of the item discounts
+
+    cart.ruleSavings.assign(plan.ruleNames.size(), Money{0});
+    cart.lineRevenue.resize(lines.size());
+
+    // Work out the happy-hour percentage of each category once for the time of the order
+    tm orderTime;
+    localtime_r(&now, &orderTime);
+    int minute = orderTime.tm_hour * 60 + orderTime.tm_min; // Minutes after midnight
+    vector<uint8_t> hourPercent(model.categories.size(), 0); // Happy-hour percentage of each category
+    vector<uint16_t> hourRule(model.categories.size(), 0); // Rule giving each category's percentage
+
+    for (const HappyHourWindow& window : plan.happyHours) {
+        bool open = window.startMinute <= window.endMinute
+                    ? minute >= window.startMinute && minute < window.endMinute
+                    : minute >= window.startMinute || minute < window.endMinute; // Runs past midnight
+        if (!open)
+            continue;
+        for (size_t category = 0; category < hourPercent.size(); category++) {
+            if ((window.category == -1 || window.category == (int)category) && window.percent > hourPercent[category]) {
+                hourPercent[category] = window.percent;
+                hourRule[category] = window.rule;
+            }
+        }
+    }
+
+    // Item discounts: one pass over the lines using the precomputed tables
+    for (size_t i = 0; i < lines.size(); i++) {
+        const CartLine& line = lines[i];
+        Money lineTotal = line.unitPrice * line.quantity; // Price of the line before any discount
+        cart.subtotal += lineTotal;
+        if (line.row < 0 || line.row >= (int)plan.rowPercent.size())
+            continue; // The item is no longer on the menu
+
+        int percent = plan.rowPercent[line.row];
+        uint16_t rule = plan.rowPercentRule[line.row];
+        int category = model.itemCategory[line.row];
+        if (hourPercent[category] > percent) {
+            percent = hourPercent[category];
+            rule = hourRule[category];
+        }
+        Money discount = percentOf(lineTotal, percent);
+
+        int buy = plan.rowBuyQuantity[line.row];
+        if (buy != 0) {
+            int freeUnits = line.quantity / (buy + plan.rowFreeQuantity[line.row]) * plan.rowFreeQuantity[line.row];
+            if (line.unitPrice * freeUnits > discount) {
+                discount = line.unitPrice * freeUnits;
+                rule = plan.rowDealRule[line.row];
+            }
+        }
+
+        if (discount > Money{0}) {
+            lineDiscount[i] = discount;
+            itemDiscount += discount;
+            cart.ruleSavings[rule] += discount;
+        }
+    }
+
+    // Order discount: a newcomer discount for a first order, otherwise the highest loyalty tier reached
+    int orderPercent = 0;
+    uint16_t orderRule = 0;
+    if (previousOrders == 0) {
+        orderPercent = plan.newcomerPercent;
+        orderRule = plan.newcomerRule;
+    } else {
+        for (const LoyaltyTier& tier : plan.loyaltyTiers) {
+            if (previousOrders >= tier.minVisits) {
+                orderPercent = tier.percent;
+                orderRule = tier.rule;
+                break;
+            }
+        }
+    }
+    Money afterItemDiscounts = cart.subtotal - itemDiscount; // Price of the cart after the item discounts
+    Money orderDiscount = percentOf(afterItemDiscounts, orderPercent);
+    if (orderDiscount > Money{0})
+        cart.ruleSavings[orderRule] += orderDiscount;
+
+    // Share the order discount out over the lines
+    Money orderDiscountLeft = orderDiscount; // Part of the order discount not yet shared out
+    for (size_t i = 0; i < lines.size(); i++) {
+        Money lineNet = lines[i].unitPrice * lines[i].quantity - lineDiscount[i];
+        Money share = orderDiscountLeft; // The last line takes the rest
+        if (i + 1 < lines.size())
+            share = afterItemDiscounts.cents == 0 ? Money{0}
+                                                  : Money{orderDiscount.cents * lineNet.cents / afterItemDiscounts.cents};
+        orderDiscountLeft -= share;
+        cart.lineRevenue[i] = lineNet - share;
+    }
+
+    cart.discount = itemDiscount + orderDiscount;
+    cart.total = cart.subtotal - cart.discount;
+    return cart;
+}
+
+// Function to start the kitchen of the current branch: reads its unfinished tickets and starts the
+// kitchen thread (it keeps running in the background until the program exits)
+void startKitchen() {
+    {
+        lock_guard<mutex> lock(kitchenBoard.lock);
+        loadKitchenBoard(kitchenBoard);
+    }
+    startBackgroundThread(runKitchen);
+}
+
+// Function run by the kitchen thread, the only consumer of the ticket queue
+// Tickets are picked up in batches and start cooking straight away; a ticket is ready once its
+// preparation time has passed, and then waits on the kitchen display until the manager dispatches it
+// The board is only read again from the shared file when there is something to change on it
+void runKitchen() {
+    vector<KitchenTicket> batch; // Tickets picked up from the queue
+
+    while (!backgroundStopping) {
+        popKitchenTickets(kitchenQueue, batch, chrono::seconds(1));
+        time_t now = time(0);
+        bool changed = !batch.empty(); // Whether the kitchen display needs to be saved
+
+        lock_guard<mutex> lock(kitchenBoard.lock);
+        for (const KitchenTicket& ticket : kitchenBoard.tickets)
+            changed = changed || (ticket.state == TicketState::Cooking && ticket.readyAt <= now);
+        if (!changed)
+            continue;
+        changed = !batch.empty();
+
+        int boardFile = lockKitchenBoard(kitchenBoard);
+        for (KitchenTicket& ticket : batch) {
+            ticket.state = TicketState::Cooking;
+            ticket.readyAt = now + ticket.preparationTime * 60;
+            kitchenBoard.tickets.push_back(move(ticket));
+        }
+        batch.clear();
+
+        for (KitchenTicket& ticket : kitchenBoard.tickets) {
+            if (ticket.state == TicketState::Cooking && ticket.readyAt <= now) {
+                ticket.state = TicketState::Ready;
+                changed = true;
+            }
+        }
+
+        if (changed)
+            saveKitchenBoard(kitchenBoard);
+        unlockKitchenBoard(boardFile);
+    }
+}
+
+// Function to add a ticket to the end of the queue (called by the ordering front ends)
+// Waits for up to the given time while the queue is full; returns false if there was still no room
+bool pushKitchenTicket(TicketQueue& queue, const KitchenTicket& ticket, chrono::milliseconds wait) {
+    unique_lock<mutex> lock(queue.lock);
+    if (!queue.notFull.wait_for(lock, wait, [&]() { return queue.count < queue.slots.size(); }))
+        return false;
+
+    queue.slots[(queue.head + queue.count) % queue.slots.size()] = ticket;
+    ++queue.count;
+    lock.unlock();
+    queue.notEmpty.notify_one();
+    return true;
+}
+
+// Function to take up to KITCHEN_BATCH_SIZE tickets from the front of the queue (called by the kitchen)
+// Waits for up to the given time for a ticket to arrive; returns the number of tickets taken
+size_t popKitchenTickets(TicketQueue& queue, vector<KitchenTicket>& batch, chrono::milliseconds wait) {
+    unique_lock<mutex> lock(queue.lock);
+    queue.notEmpty.wait_for(lock, wait, [&]() { return queue.count > 0 || backgroundStopping; });
+
+    size_t taken = 0;
+    while (queue.count > 0 && taken < (size_t)KITCHEN_BATCH_SIZE) {
+        batch.push_back(move(queue.slots[queue.head]));
+        queue.head = (queue.head + 1) % queue.slots.size();
+        --queue.count;
+        ++taken;
+    }
+    lock.unlock();
+    if (taken > 0)
+        queue.notFull.notify_all();
+    return taken;
+}
+
+// Function to send a paid order to the kitchen as a new ticket
+// If the kitchen is too busy to take the ticket, the customer is told and the ticket is sent once there is room
+void submitKitchenTicket(UserDetails& ud, string deliveryArea, const vector<string>& items, int preparationTime) {
+    KitchenTicket ticket;
+    ticket.customerName = ud.customerName;
+    ticket.deliveryArea = deliveryArea;
+    ticket.items = items;
+    ticket.preparationTime = preparationTime;
+    ticket.queuedAt = time(0);
+    {
+        // Take the next number of the branch (the other kiosks take theirs from the same file)
+        lock_guard<mutex> lock(kitchenBoard.lock);
+        int boardFile = lockKitchenBoard(kitchenBoard);
+        ticket.ticketNo = ++kitchenBoard.lastTicketNo;
+        saveKitchenBoard(kitchenBoard);
+        unlockKitchenBoard(boardFile);
+    }
+
+    while (!pushKitchenTicket(kitchenQueue, ticket, chrono::seconds(2)))
+        cout << "\n/// The kitchen is very busy right now. Please wait while your order is passed on...";
+
+    cout << "\n/// Your order has been sent to the kitchen. Your ticket number is #" << ticket.ticketNo << ".\n";
+}
+
+// Function to read the unfinished tickets of the current branch (the caller must hold the board's lock), so they
+// survive a restart and the tickets of the other kiosks of the branch are shown too
+// (dispatched tickets are kept in the file until it is next written, but are not read back)
+// Kitchen tickets structure: the last ticket number on the first line, then one ticket per line:
+//      ticketNo, state, queuedAt, readyAt, preparationTime, customerName, deliveryArea, items (separated by |)
+// A ',', '|' or backslash within a name or an item is written with a backslash before it (see escapeTicketField)
+void loadKitchenBoard(KitchenBoard& board) {
+    string line; // One line of the kitchen tickets file
+    ifstream file(dataPath("kitchen_tickets.txt"));
+
+    board.tickets.clear();
+    board.lastTicketNo = 0;
+    if (!getline(file, line))
+        return;
+    board.lastTicketNo = atoi(line.c_str());
+
+    while (getline(file, line)) {
+        KitchenTicket ticket;
+        vector<string> values = splitTicketLine(line, 7);
+        if (values.size() < 7 || atoi(values[1].c_str()) >= (int)TicketState::Dispatched)
+            continue; // Skip a damaged line, and tickets dispatched before the restart
+
+        ticket.ticketNo = atoi(values[0].c_str());
+        ticket.state = (TicketState)min(atoi(values[1].c_str()), (int)TicketState::Dispatched);
+        ticket.queuedAt = atoll(values[2].c_str());
+        ticket.readyAt = atoll(values[3].c_str());
+        ticket.preparationTime = atoi(values[4].c_str());
+        ticket.customerName = values[5];
+        ticket.deliveryArea = values[6];
+        ticket.items.assign(values.begin() + 7, values.end());
+        board.tickets.push_back(ticket);
+    }
+}
+
+// Function to write the tickets of the kitchen display (the caller must hold the board's lock, and its file lock)
+// The file is written in full and then renamed over the old one, so it is never left half written
+void saveKitchenBoard(const KitchenBoard& board) {
+    string path = dataPath("kitchen_tickets.txt"); // The kitchen tickets file
+    ostringstream out; // The new version of the file
+
+    out << board.lastTicketNo << "\n";
+    for (const KitchenTicket& ticket : board.tickets) {
+        out << ticket.ticketNo << "," << (int)ticket.state << "," << (long long)ticket.queuedAt << ","
+            << (long long)ticket.readyAt << "," << ticket.preparationTime << ","
+            << escapeTicketField(ticket.customerName) << "," << escapeTicketField(ticket.deliveryArea) << ",";
+        for (size_t i = 0; i < ticket.items.size(); i++)
+            out << (i == 0 ? "" : "|") << escapeTicketField(ticket.items[i]);
+        out << "\n";
+    }
+    if (!replaceFile(path, out.str()))
+        cerr << "/// Could not write " << path << ": " << strerror(errno) << "\n";
+}
+
+// Function to take the file lock of the kitchen tickets of the current branch and read the tickets again (the
+// caller must hold the board's lock). Every kiosk process of the branch keeps its tickets in the same file, so
+// it is read again before each change: ticket numbers are never given out twice, and no kiosk writes over the
+// tickets of another. Returns the descriptor to pass to unlockKitchenBoard (-1 where file locks are not available)
+int lockKitchenBoard(KitchenBoard& board) {
+    int descriptor = -1; // The lock file
+#ifndef _WIN32
+    descriptor = open(dataPath("kitchen_tickets.lock").c_str(), O_RDWR | O_CREAT, 0644);
+    if (descriptor >= 0)
+        flock(descriptor, LOCK_EX);
+#endif
+    loadKitchenBoard(board);
+    return descriptor;
+}
+
+// Function to release the file lock of the kitchen tickets
+void unlockKitchenBoard(int descriptor) {
+#ifndef _WIN32
+    if (descriptor >= 0)
+        close(descriptor); // Closing the lock file releases the lock
+#endif
+}
+
+// Function to write a name or item in the kitchen tickets file, with a backslash before each ',', '|' and backslash in it
+// (a customer may well put a comma in their name). A ticket is one line, so line breaks become spaces
+string escapeTicketField(const string& text) {
+    string escaped; // The field as written
+    for (char c : text) {
+        if (c == ',' || c == '|' || c == '\\')
+            escaped += '\\';
+        escaped += c == '\n' || c == '\r' ? ' ' : c;
+    }
+    return escaped;
+}
+
+// Function to split a line of the kitchen tickets file: the first numOfFields fields are separated by ',' and
+// the items after them by '|'. A character after a backslash is part of the field (see escapeTicketField)
+// Returns the fields followed by the items
+vector<string> splitTicketLine(const string& line, size_t numOfFields) {
+    vector<string> values; // The fields and items of the line
+    string value; // The field or item being read
+
+    for (size_t i = 0; i < line.length(); i++) {
+        char delimiter = values.size() < numOfFields ? ',' : '|'; // What ends the current value
+        if (line[i] == '\\' && i + 1 < line.length())
+            value += line[++i];
+        else if (line[i] == delimiter) {
+            values.push_back(value);
+            value.clear();
+        }
+        else if (line[i] != '\r')
+            value += line[i];
+    }
+    if (values.size() < numOfFields || !value.empty())
+        values.push_back(value); // The last value (a ticket may have no items)
+    return values;
+}
+
+// Function to start the persistence thread, which writes the files of the order path in the background
+// (they are all written before the program exits, as the thread is stopped only once it has nothing left)
+void startPersistence() {
+    {
+        lock_guard<mutex> lock(persistence.lock);
+        persistence.started = true;
+    }
+    startBackgroundThread(runPersistence);
+}
+
+// Function run by the persistence thread: once a write is queued, lets the writes of the next PERSISTENCE_BATCH_MS
+// milliseconds join it (unless a flush is waiting), then takes them all at once and does them, until the program
+// exits and nothing is left to write. While a batch is being written, new writes queue up for the next
+void runPersistence() {
+    vector<PendingWrite> batch; // Writes taken from the queue
+
+    while (true) {
+        {
+            unique_lock<mutex> lock(persistence.lock);
+            persistence.writing = false;
+            if (persistence.writes.empty())
+                persistence.drained.notify_all();
+            persistence.notEmpty.wait(lock, []() { return !persistence.writes.empty() || backgroundStopping; });
+            if (persistence.writes.empty())
+                return;
+            persistence.notEmpty.wait_for(lock, chrono::milliseconds(PERSISTENCE_BATCH_MS),
+                                          []() { return persistence.flushing > 0 || backgroundStopping; });
+            batch.swap(persistence.writes);
+            persistence.writing = true;
+        }
+
+        for (const PendingWrite& write : batch)
+            writeFile(write);
+        batch.clear();
+    }
+}
+
+// Function to queue text to be added to the end of a file
+// If the file already has a write waiting, the text joins it, so the file is opened once for both
+// The text is only in memory until the persistence thread has written it (see flushWrites)
+void queueAppend(string path, string data) {
+    unique_lock<mutex> lock(persistence.lock);
+    if (!persistence.started) {
+        lock.unlock();
+        writeFile({path, data, false});
+        return;
+    }
+
+    for (PendingWrite& write : persistence.writes) {
+        if (write.path == path) {
+            write.data += data;
+            return;
+        }
+    }
+    persistence.writes.push_back({path, data, false});
+    bool first = persistence.writes.size() == 1; // Whether the persistence thread is waiting for a write
+    lock.unlock();
+    if (first)
+        persistence.notEmpty.notify_one();
+}
+
+// Function to queue a new version of a whole file; a version still waiting to be written is dropped
+void queueReplace(string path, string data) {
+    unique_lock<mutex> lock(persistence.lock);
+    if (!persistence.started) {
+        lock.unlock();
+        writeFile({path, data, true});
+        return;
+    }
+
+    for (PendingWrite& write : persistence.writes) {
+        if (write.path == path) {
+            write.data = move(data);
+            write.replace = true;
+            return;
+        }
+    }
+    persistence.writes.push_back({path, data, true});
+    bool first = persistence.writes.size() == 1; // Whether the persistence thread is waiting for a write
+    lock.unlock();
+    if (first)
+        persistence.notEmpty.notify_one();
+}
+
+// Function to queue a write of the live stock of the shared catalog to the menu file. The stock is read when the
+// write is done, so one write waiting is enough for every order paid before it
+void queueSharedStock() {
+    PendingWrite stockWrite; // The write of the live stock
+    stockWrite.path = dataPath("menu.txt");
+    stockWrite.sharedStock = true;
+
+    unique_lock<mutex> lock(persistence.lock);
+    if (!persistence.started) {
+        lock.unlock();
+        writeFile(stockWrite);
+        return;
+    }
+
+    for (const PendingWrite& write : persistence.writes) {
+        if (write.path == stockWrite.path)
+            return;
+    }
+    persistence.writes.push_back(stockWrite);
+    bool first = persistence.writes.size() == 1; // Whether the persistence thread is waiting for a write
+    lock.unlock();
+    if (first)
+        persistence.notEmpty.notify_one();
+}
+
+// Function to wait until every queued write has reached its file, cutting short the wait for more writes to join
+// the batch. Called before the files are read, and before an order is confirmed to the customer (so a crash after
+// the confirmation cannot lose the order's records)
+void flushWrites() {
+    unique_lock<mutex> lock(persistence.lock);
+    ++persistence.flushing;
+    persistence.notEmpty.notify_one();
+    persistence.drained.wait(lock, []() { return persistence.writes.empty() && !persistence.writing; });
+    --persistence.flushing;
+}
+
+// Function to do one file write: text is added to the end of the file, or a new version is written
+// in full and then renamed over the old one, so the file is never left half written (the live stock of the
+// shared catalog is written to the menu file the same way)
+// Nobody waits for the write, so a write that fails is reported on the error output
+void writeFile(const PendingWrite& write) {
+    bool written = false; // Whether the write reached the file
+    if (write.sharedStock) {
+        written = saveSharedStock();
+    } else if (write.events) {
+        written = appendEvents(write.path, write.data);
+    } else if (!write.replace) {
+        written = appendFile(write.path, write.data);
+    } else {
+        written = replaceFile(write.path, write.data);
+    }
+
+    if (!written)
+        cerr << "/// Could not write " << write.path << ": " << strerror(errno) << "\n";
+}
+
+// Function to add text to the end of a file. The file is locked (along with the other writers) while the text is
+// added, so the compaction job can start a stats log again without losing a line: a writer that waited for it
+// to finish adds its text to the new log instead (see rotateStatsLog). Returns false if not all of it was written
+bool appendFile(string path, const string& data) {
+    bool written = true; // Whether all the text was written
+#ifndef _WIN32
+    int descriptor = -1; // The file, as open when the lock was taken
+    for (;;) {
+        descriptor = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (descriptor < 0)
+            return false;
+        flock(descriptor, LOCK_SH);
+        struct stat opened;
+        struct stat current;
+        if (fstat(descriptor, &opened) != 0 || stat(path.c_str(), &current) != 0 || opened.st_ino == current.st_ino)
+            break;
+        close(descriptor); // The log was started again while waiting for the lock
+    }
+    for (size_t done = 0; written && done < data.size();) {
+        ssize_t count = ::write(descriptor, data.data() + done, data.size() - done);
+        written = count > 0;
+        done += written ? count : 0;
+    }
+    flock(descriptor, LOCK_UN);
+    close(descriptor);
+#else
+    ofstream file(path, ios::app);
+    file << data;
+    file.close();
+    written = !file.fail();
+#endif
+    return written;
+}
+
+// Function to write a new version of a whole file: the data goes to a temporary file of its own, which is
+// flushed to the disk and then renamed over the old file, so a reader (or a power cut) never finds it half
+// written. Each writer has its own temporary file, so kiosks replacing the same file never write into each other's
+// Returns false (leaving the old file as it was) if the new version could not be written
+bool replaceFile(string path, const string& data) {
+    random_device random; // Makes the temporary file name unique to this writer
+    string tmpPath = path + ".tmp" + to_string(random());
+    bool written = true; // Whether the whole new version reached the disk
+#ifndef _WIN32
+    int descriptor = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (descriptor < 0)
+        return false;
+    for (size_t done = 0; written && done < data.size();) {
+        ssize_t count = ::write(descriptor, data.data() + done, data.size() - done);
+        written = count > 0;
+        done += written ? count : 0;
+    }
+    written = written && fsync(descriptor) == 0;
+    written = close(descriptor) == 0 && written;
+#else
+    ofstream file(tmpPath, ios::binary | ios::trunc);
+    file.write(data.data(), data.size());
+    file.close();
+    written = !file.fail();
+#endif
+
+    error_code error;
+    if (written)
+        filesystem::rename(tmpPath, path, error);
+    if (!written || error) {
+        int reason = error ? error.value() : errno; // Kept for the caller's message, as the removal may change errno
+        filesystem::remove(tmpPath, error);
+        errno = reason;
+        return false;
+    }
+    return true;
+}
+
+// Function to add an event to a batch of events (its sequence number is given when it is written)
+void addEvent(vector<EventRecord>& events, EventType type, int orderId, int menuIndex, int quantity, int64_t value) {
+    EventRecord event;
+    event.time = time(0);
+    event.value = value;
+#ifndef _WIN32
+    event.kiosk = (uint32_t)getpid();
+#endif
+    event.orderId = (uint32_t)orderId;
+    event.menuIndex = menuIndex;
+    event.quantity = quantity;
+    event.type = type;
+    events.push_back(event);
+}
+
+// Function to queue a batch of events to be added to the event stream of the current branch
+// Like other text added to a file, a batch joins any events of the branch still waiting to be written
+void queueEvents(const vector<EventRecord>& events) {
+    if (events.empty())
+        return;
+    string path = dataPath("events.log"); // The branch's event stream
+    string data((const char*)events.data(), events.size() * sizeof(EventRecord));
+
+    unique_lock<mutex> lock(persistence.lock);
+    if (!persistence.started) {
+        lock.unlock();
+        writeFile({path, data, false, true});
+        return;
+    }
+
+    for (PendingWrite& write : persistence.writes) {
+        if (write.path == path) {
+            write.data += data;
+            return;
+        }
+    }
+    persistence.writes.push_back({path, data, false, true});
+    bool first = persistence.writes.size() == 1; // Whether the persistence thread is waiting for a write
+    lock.unlock();
+    if (first)
+        persistence.notEmpty.notify_one();
+}
+
+// Function to add event records to the end of an event stream, giving them the next sequence numbers
+// Every kiosk process of the branch adds to the same stream, so the file is locked while the next number is
+// worked out from its size and the records are written: the numbers never repeat and never skip one.
+// A record left half written (e.g. by a power cut) is dropped first, so every record starts where it should
+// Returns false if the records could not all be written
+bool appendEvents(string path, string data) {
+    size_t numOfEvents = data.size() / sizeof(EventRecord); // Number of records to add
+    uint64_t size = 0; // Size of the stream before the records are added
+    bool written = true; // Whether every record was written
+#ifndef _WIN32
+    int descriptor = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (descriptor < 0)
+        return false;
+    flock(descriptor, LOCK_EX);
+    struct stat info;
+    if (fstat(descriptor, &info) == 0)
+        size = (uint64_t)info.st_size;
+    if (size % sizeof(EventRecord) != 0) {
+        size -= size % sizeof(EventRecord);
+        if (ftruncate(descriptor, (off_t)size) != 0)
+            size += sizeof(EventRecord); // Could not be dropped: start after it instead
+    }
+#else
+    error_code error; // Set (instead of throwing) when the stream does not exist yet
+    size = filesystem::file_size(path, error);
+    size = error ? 0 : size - size % sizeof(EventRecord);
+#endif
+
+    // Number the records from where the stream ends (the sequence number is the first field of a record)
+    for (size_t i = 0; i < numOfEvents; i++) {
+        uint64_t sequence = size / sizeof(EventRecord) + i + 1;
+        memcpy(&data[i * sizeof(EventRecord) + offsetof(EventRecord, sequence)], &sequence, sizeof(sequence));
+    }
+
+#ifndef _WIN32
+    for (size_t done = 0; written && done < numOfEvents * sizeof(EventRecord);) {
+        ssize_t count = write(descriptor, data.data() + done, numOfEvents * sizeof(EventRecord) - done);
+        written = count > 0;
+        done += written ? count : 0;
+    }
+    flock(descriptor, LOCK_UN);
+    close(descriptor);
+#else
+    ofstream file(path, ios::binary | ios::app);
+    file.write(data.data(), numOfEvents * sizeof(EventRecord));
+    file.close();
+    written = !file.fail();
+#endif
+    return written;
+}
+
+// Function to read the events of an event stream that come after the given sequence number
+// A subscriber passes the last sequence number it has seen, so only the new events are read
+// Returns the number of events read (added to the end of events)
+size_t readEvents(string path, uint64_t afterSequence, vector<EventRecord>& events) {
+    size_t numOfEvents = 0; // Number of events read
+    EventRecord event; // Each event read
+    ifstream file(path, ios::binary);
+
+    file.seekg(afterSequence * sizeof(EventRecord));
+    while (file.read((char*)&event, sizeof(event))) {
+        events.push_back(event);
+        ++numOfEvents;
+    }
+    return numOfEvents;
+}
+
+// Function to follow the event stream of a branch (the one in NINJAFOOD_BRANCH, or else the main branch),
+// printing every event after the given sequence number and then each new event as it is added, one per line.
+// This serves subscribers that read text; others read the records of events.log themselves
+void followEvents(uint64_t afterSequence) {
+    const char* presetBranch = getenv("NINJAFOOD_BRANCH");
+    currentBranchId = presetBranch != nullptr ? presetBranch : "";
+    string path = dataPath("events.log"); // The branch's event stream
+
+    while (true) {
+        vector<EventRecord> events; // The events added since the last check
+        readEvents(path, afterSequence, events);
+        for (const EventRecord& event : events) {
+            cout << describeEvent(event) << "\n";
+            afterSequence = event.sequence;
+        }
+        cout.flush();
+        if (events.empty())
+            this_thread::sleep_for(chrono::milliseconds(EVENT_POLL_MS));
+    }
+}
+
+// Function to describe an event in one line of text, e.g. "#12 2024-06-01 12:30:05 STOCK_CHANGED item=3 used=2 left=15"
+string describeEvent(const EventRecord& event) {
+    time_t eventTime = (time_t)event.time;
+    char timeText[20]; // The time of the event, as YYYY-MM-DD HH:MM:SS
+    strftime(timeText, sizeof(timeText), "%Y-%m-%d %H:%M:%S", localtime(&eventTime));
+    string text = "#" + to_string(event.sequence) + " " + timeText + " ";
+    string order = "kiosk=" + to_string(event.kiosk) + " order=" + to_string(event.orderId); // The cart of an order event
+
+    switch (event.type) {
+        case EVENT_PRICE_CHANGED:
+            return text + "PRICE_CHANGED item=" + to_string(event.menuIndex) + " price=" + formatCents(event.value);
+        case EVENT_STOCK_CHANGED:
+            return text + "STOCK_CHANGED item=" + to_string(event.menuIndex) + " used=" + to_string(event.quantity)
+                 + " left=" + to_string(event.value);
+        case EVENT_ITEM_ADDED:
+            return text + "ITEM_ADDED item=" + to_string(event.menuIndex) + " price=" + formatCents(event.value)
+                 + " stock=" + to_string(event.quantity);
+        case EVENT_ORDER_ACCEPTED:
+            return text + "ORDER_ACCEPTED " + order + " item=" + to_string(event.menuIndex) + " quantity="
+                 + to_string(event.quantity) + " price=" + formatCents(event.value);
+        case EVENT_PAYMENT_COMPLETED:
+            return text + "PAYMENT_COMPLETED " + order + " lines=" + to_string(event.quantity) + " paid=" + formatCents(event.value);
+        case EVENT_ORDER_CANCELLED:
+            return text + "ORDER_CANCELLED " + order + " refund=" + formatCents(event.value);
+        default:
+            return text + "UNKNOWN type=" + to_string(event.type);
+    }
+}
+
+// Function to return the name of a ticket stage
+string ticketStateName(TicketState state) {
+    switch (state) {
+        case TicketState::Queued: return "QUEUED";
+        case TicketState::Cooking: return "COOKING";
+        case TicketState::Ready: return "READY";
+        default: return "DISPATCHED";
+    }
+}
+
+// Function to show the kitchen display: tickets waiting, cooking and ready, with the option to
+// dispatch the orders that are ready for delivery
+void viewKitchenDisplay() {
+    string choice; // Ticket number to dispatch, or 0 to finish
+
+    cout << "\n************************** KITCHEN DISPLAY **************************\n";
+    cout << "\n/// You have selected the option to: View Kitchen Display\n";
+
+    while (true) {
+        size_t numOfQueued = 0; // Tickets not yet picked up by the kitchen
+        {
+            lock_guard<mutex> lock(kitchenQueue.lock);
+            numOfQueued = kitchenQueue.count;
+        }
+
+        vector<KitchenTicket> tickets; // Copy of the board, so the kitchen is not held up while displaying
+        {
+            lock_guard<mutex> lock(kitchenBoard.lock);
+            loadKitchenBoard(kitchenBoard); // With the tickets of the other kiosks of the branch
+            tickets = kitchenBoard.tickets;
+        }
+
+        time_t now = time(0);
+        cout << "\nTICKET\tSTATUS\t\tCUSTOMER\t\tAREA\t\t\tITEMS";
+        cout << "\n---------------------------------------------------------------------------------\n";
+        int numShown = 0; // Number of tickets on the display
+        for (const KitchenTicket& ticket : tickets) {
+            if (ticket.state == TicketState::Dispatched)
+                continue;
+            ++numShown;
+            string items;
+            for (size_t i = 0; i < ticket.items.size(); i++)
+                items += (i == 0 ? "" : ", ") + ticket.items[i];
+            cout << "#" << left << setw(6) << ticket.ticketNo << "\t" << setw(10) << ticketStateName(ticket.state);
+            if (ticket.state == TicketState::Cooking)
+                cout << "(" << max<long long>(0, (ticket.readyAt - now + 59) / 60) << " min)";
+            cout << "\t" << setw(20) << ticket.customerName << "\t" << setw(20) << ticket.deliveryArea << "\t" << items << "\n";
+        }
+        if (numShown == 0)
+            cout << "/// No tickets in the kitchen.\n";
+        cout << "\n/// " << numOfQueued << " ticket(s) waiting to be picked up by the kitchen.\n";
+
+        // Let the manager dispatch a ready order
+        cout << "\n=> Enter the number of a READY ticket to dispatch it (0 to go back): ";
+        choice = readToken();
+        if (choice == "0")
+            break;
+
+        bool dispatched = false; // Whether the chosen ticket was dispatched
+        {
+            lock_guard<mutex> lock(kitchenBoard.lock);
+            int boardFile = lockKitchenBoard(kitchenBoard);
+            for (size_t i = 0; i < kitchenBoard.tickets.size(); i++) {
+                if (to_string(kitchenBoard.tickets[i].ticketNo) == choice && kitchenBoard.tickets[i].state == TicketState::Ready) {
+                    kitchenBoard.tickets[i].state = TicketState::Dispatched; // A dispatched ticket leaves the display
+                    saveKitchenBoard(kitchenBoard);
+                    dispatched = true;
+                    break;
+                }
+            }
+            unlockKitchenBoard(boardFile);
+        }
+
+        if (dispatched)
+            cout << "\n/// Ticket #" << choice << " has been dispatched for delivery.\n";
+        else
+            cout << "\n/// There is no READY ticket #" << choice << ". Please try again!\n";
+    }
+
+    // Ask the user whether they want to continue using the program
+    continueProgram();
+}
+
+// Function to warn the manager about items that will run out before new stock can arrive
+void showLowStockAlerts() {
+    unordered_map<int, ConsumptionRate> rates; // Copy of the rates, so stock can be checked without holding the lock
+    {
+        lock_guard<mutex> lock(stockForecast.lock);
+        if (!stockForecast.loaded)
+            loadStockForecast(stockForecast);
+        rates = stockForecast.rates;
+    }
+
+    shared_ptr<BranchCatalog> catalog = loadBranchCatalog(currentBranchId);
+    time_t now = time(0);
+    for (int i = 0; i < catalog->totalNumItems; i++) {
+        if (catalog->model.componentStart[i] != catalog->model.componentStart[i + 1])
+            continue; // Combos have no stock of their own
+        auto found = rates.find(stoi(catalog->arrMenuContent[i][MENU_INDEX]));
+        double perHour = found == rates.end() ? 0 : currentRate(found->second, now);
+        int stock = availableStock(catalog->arrMenuContent, catalog->model, i);
+        if (perHour > 0 && stock <= ceil(perHour * RESTOCK_LEAD_HOURS))
+            cout << "/// LOW STOCK: " << catalog->arrMenuContent[i][MENU_NAME] << " has " << stock << " left (about "
+                 << fixed << setprecision(1) << stock / perHour << " hours at the current rate).\n";
+    }
+}
+
+// Function to display the stock forecast: how fast each stocked item is used up, how long its stock
+// will last, the stock level to reorder at and how much to restock
+void viewStockForecast() {
+    unordered_map<int, ConsumptionRate> rates; // Copy of the rates, so stock can be checked without holding the lock
+    {
+        lock_guard<mutex> lock(stockForecast.lock);
+        if (!stockForecast.loaded)
+            loadStockForecast(stockForecast);
+        rates = stockForecast.rates;
+    }
+
+    cout << "\n************************** STOCK FORECAST **************************\n";
+    cout << "\n/// You have selected the option to: View Stock Forecast\n";
+    cout << "/// Restocks are assumed to take " << RESTOCK_LEAD_HOURS << " hours to arrive and to cover "
+         << RESTOCK_COVER_HOURS << " hours.\n";
+
+    shared_ptr<BranchCatalog> catalog = loadBranchCatalog(currentBranchId);
+    time_t now = time(0);
+    int numLow = 0; // Number of items low on stock
+
+    cout << "\nITEM NO\tITEM NAME\t\tSTOCK\tUSED/HOUR\tHOURS LEFT\tREORDER AT\tRESTOCK";
+    cout << "\n-----------------------------------------------------------------------------------------------\n";
+    for (int i = 0; i < catalog->totalNumItems; i++) {
+        if (catalog->model.componentStart[i] != catalog->model.componentStart[i + 1])
+            continue; // Combos have no stock of their own
+        auto found = rates.find(stoi(catalog->arrMenuContent[i][MENU_INDEX]));
+        double perHour = found == rates.end() ? 0 : currentRate(found->second, now);
+        int stock = availableStock(catalog->arrMenuContent, catalog->model, i);
+        int reorderAt = (int)ceil(perHour * RESTOCK_LEAD_HOURS); // Stock used while a restock is on its way
+        int restock = max((int)ceil(perHour * (RESTOCK_LEAD_HOURS + RESTOCK_COVER_HOURS)) - stock, 0);
+        bool low = perHour > 0 && stock <= reorderAt;
+        numLow += low;
+
+        cout << left << setw(8) << catalog->arrMenuContent[i][MENU_INDEX] << "\t" << setw(20) << catalog->arrMenuContent[i][MENU_NAME]
+             << "\t" << setw(6) << stock << "\t" << fixed << setprecision(2) << setw(10) << perHour << "\t";
+        if (perHour > 0)
+            cout << setprecision(1) << setw(10) << stock / perHour;
+        else
+            cout << setw(10) << "-";
+        cout << "\t" << setw(10) << reorderAt << "\t" << restock << (low ? "\tLOW" : "") << "\n";
+    }
+
+    cout << "\n/// " << numLow << " item(s) will run out before new stock can arrive.\n";
+
+    // Ask the user whether they want to continue using the program
+    continueProgram();
+}
+
+// Function to generate an end-of-day or end-of-month sales report from the order history
+void viewSalesReport() {
+    time_t now = time(0); // The current date and time
+    tm periodStart = *localtime(&now); // Start of the report period (local time)
+    tm periodEnd; // End of the report period (local time)
+    string periodName; // Description of the report period
+    string reportFileName; // File the report is saved to
+
+    // Only managers whose role allows it may see the restaurant's figures
+    if (!requirePermission(PERMISSION_VIEW_STATS, "view sales reports")) {
+        continueProgram();
+        return;
+    }
+
+    cout << "\n************************** SALES REPORT **************************\n";
+    cout << "\n/// You have selected the option to: View Sales Report\n";
+
+    // INPUT VALIDATION - Ask until the input is either '1' or '2'
+    char choice = promptChoice("\n=> Please select the report period:\n"
+                               "[1] End of day (today)\n"
+                               "[2] End of month (this month)\n", "12");
+
+    // Work out the start and end of the period in local time
+    periodStart.tm_hour = 0;
+    periodStart.tm_min = 0;
+    periodStart.tm_sec = 0;
+    periodStart.tm_isdst = -1; // Let mktime work out daylight saving time
+    if (choice == '2')
+        periodStart.tm_mday = 1;
+    periodEnd = periodStart;
+    if (choice == '1') {
+        periodEnd.tm_mday += 1;
+        periodName = "END-OF-DAY";
+        reportFileName = "eod_report.txt";
+    } else {
+        periodEnd.tm_mon += 1;
+        periodName = "END-OF-MONTH";
+        reportFileName = "eom_report.txt";
+    }
+
+    // Bring the columnar snapshot of the order history up to date (only new order lines are converted)
+    chrono::steady_clock::time_point started = chrono::steady_clock::now();
+    OrderColumns columns;
+    loadOrderSnapshot(dataPath("order_history.col"), columns);
+    uint64_t convertedBefore = columns.sourceSize;
+    refreshOrderSnapshot(columns);
+    if (columns.sourceSize != convertedBefore)
+        saveOrderSnapshot(dataPath("order_history.col"), columns);
+    chrono::steady_clock::time_point loaded = chrono::steady_clock::now();
+
+    // Aggregate the order lines of the current branch for the period
+    SalesReport report = buildSalesReport(columns, mktime(&periodStart), mktime(&periodEnd));
+    chrono::duration<double, milli> loadTime = loaded - started;
+    chrono::duration<double, milli> scanTime = chrono::steady_clock::now() - loaded;
+
+    // Write the report to a text stream so it can be both displayed and saved
+    stringstream out;
+    out << "\n================= " << periodName << " SALES REPORT =================\n";
+    out << "\nORDER LINES: " << report.numOfOrderLines;
+    out << "\nTOTAL REVENUE: $" << formatCents(report.totalRevenue) << "\n";
+
+    // Revenue by item, highest first
+    vector<int> items;
+    for (size_t item = 0; item < report.itemRevenue.size(); item++) {
+        if (report.itemQuantity[item] != 0)
+            items.push_back(item);
+    }
+    sort(items.begin(), items.end(), [&](int a, int b) { return report.itemRevenue[a] > report.itemRevenue[b]; });
+    out << "\n1. REVENUE BY ITEM\n";
+    for (int item : items) {
+        out << "   " << left << setw(6) << item << setw(30) << report.itemNames[item]
+            << "Qty: " << setw(8) << report.itemQuantity[item] << "$" << formatCents(report.itemRevenue[item]) << "\n";
+    }
+
+    // Revenue by hour (only hours with sales)
+    out << "\n2. REVENUE BY HOUR\n";
+    for (int hour = 0; hour < 24; hour++) {
+        if (report.hourRevenue[hour] != 0)
+            out << "   " << right << setw(2) << setfill('0') << hour << ":00 - " << setw(2) << hour << ":59" << setfill(' ')
+                << "\t$" << formatCents(report.hourRevenue[hour]) << "\n";
+    }
+
+    // Revenue by delivery area
+    out << "\n3. REVENUE BY DELIVERY AREA\n";
+    for (int area = 1; area <= NUM_OF_DELIVERY_AREAS; area++)
+        out << "   " << left << setw(20) << deliveryAreaName('0' + area) << "$" << formatCents(report.areaRevenue[area]) << "\n";
+
+    // Revenue from newcomers and returning customers
+    out << "\n4. REVENUE BY CUSTOMER TYPE\n";
+    out << "   " << left << setw(20) << "Newcomers" << "$" << formatCents(report.newcomerRevenue) << "\n";
+    out << "   " << left << setw(20) << "Returning customers" << "$" << formatCents(report.returningRevenue) << "\n";
+    out << "\n=================================================================\n";
+
+    cout << out.str();
+    cout << "/// " << columns.menuIndices.size() << " order line(s) loaded in " << loadTime.count()
+         << " ms and scanned in " << scanTime.count() << " ms.\n";
+
+    // Save the report next to the branch's other data files
+    fstream reportFile;
+    reportFile.open(dataPath(reportFileName), ios::out);
+    reportFile << out.str();
+    reportFile.close();
+    cout << "/// Report saved to " << dataPath(reportFileName) << "\n";
+
+    // Ask the user whether they want to continue using the program
+    continueProgram(); // Proceed with the next step in the program
+}
+
+// Function to aggregate the order lines paid within [periodStart, periodEnd) using all CPU cores
+// The rows are split into equal ranges; each worker thread runs the column scans over its own range
+// into its own report (map), and the workers' reports are merged at the end (reduce)
+SalesReport buildSalesReport(const OrderColumns& columns, time_t periodStart, time_t periodEnd) {
+    SalesReport report; // The merged report
+    size_t numOfRows = columns.menuIndices.size(); // Number of order lines in the snapshot
+    int maxMenuIndex = 0; // Largest menu index, which sizes the per-item totals
+
+    for (size_t i = 0; i < numOfRows; i++)
+        maxMenuIndex = max(maxMenuIndex, columns.menuIndices[i]);
+    report.itemRevenue.assign(maxMenuIndex + 1, 0);
+    report.itemQuantity.assign(maxMenuIndex + 1, 0);
+
+    if (numOfRows == 0)
+        return report; // No orders have been paid yet
+
+    // Turn the timestamp differences back into payment times
+    vector<int64_t> timestamps(numOfRows);
+    decodeTimestamps(columns.timestampDeltas.data(), numOfRows, columns.baseTimestamp, timestamps.data());
+
+    // The hour of each payment uses the local time offset at the start of the period
+    tm periodStartTime;
+    localtime_r(&periodStart, &periodStartTime);
+    int64_t utcOffset = periodStartTime.tm_gmtoff;
+
+    // Split the rows between the workers
+    unsigned numOfWorkers = max(1u, thread::hardware_concurrency());
+    numOfWorkers = min<size_t>(numOfWorkers, (numOfRows + 65535) / 65536); // At least 64K rows per worker
+    vector<SalesReport> partialReports(numOfWorkers);
+    vector<thread> workers;
+
+    for (unsigned w = 0; w < numOfWorkers; w++) {
+        workers.emplace_back([&, w]() {
+            size_t first = numOfRows * w / numOfWorkers; // First row of this worker
+            size_t count = numOfRows * (w + 1) / numOfWorkers - first; // Number of rows of this worker
+            SalesReport& partial = partialReports[w];
+            partial.itemRevenue.assign(maxMenuIndex + 1, 0);
+            partial.itemQuantity.assign(maxMenuIndex + 1, 0);
+
+            // Mark the rows paid within the period
+            vector<uint8_t> mask(count);
+            buildPeriodMask(timestamps.data() + first, count, periodStart, periodEnd, mask.data());
+
+            // Totals
+            const int64_t* revenue = columns.revenueCents.data() + first;
+            partial.totalRevenue = sumMasked(revenue, mask.data(), count);
+            for (size_t i = 0; i < count; i++)
+                partial.numOfOrderLines += mask[i];
+
+            // Revenue and quantity by item
+            groupSumMasked(columns.menuIndices.data() + first, revenue, mask.data(), count, partial.itemRevenue.data());
+            vector<int64_t> quantities(columns.quantities.begin() + first, columns.quantities.begin() + first + count);
+            groupSumMasked(columns.menuIndices.data() + first, quantities.data(), mask.data(), count, partial.itemQuantity.data());
+
+            // Revenue by hour of the day
+            vector<uint8_t> hours(count);
+            for (size_t i = 0; i < count; i++)
+                hours[i] = (uint8_t)((((timestamps[first + i] + utcOffset) % 86400) + 86400) % 86400 / 3600);
+            groupSumMasked(hours.data(), revenue, mask.data(), count, partial.hourRevenue);
+
+            // Revenue by delivery area and by customer type
+            groupSumMasked(columns.areas.data() + first, revenue, mask.data(), count, partial.areaRevenue);
+            int64_t byCustomerType[2] = {};
+            groupSumMasked(columns.newcomers.data() + first, revenue, mask.data(), count, byCustomerType);
+            partial.returningRevenue = byCustomerType[0];
+            partial.newcomerRevenue = byCustomerType[1];
+        });
+    }
+    for (thread& worker : workers)
+        worker.join();
+
+    // Merge the workers' reports
+    for (const SalesReport& partial : partialReports)
+        mergeSalesReport(report, partial);
+
+    // Name each item after its first order line
+    for (size_t i = 0; i < numOfRows; i++) {
+        if (report.itemNames.find(columns.menuIndices[i]) == report.itemNames.end())
+            report.itemNames[columns.menuIndices[i]] = columns.names[columns.nameIds[i]];
+    }
+
+    return report;
+}
+
+// Function to turn the stored timestamp differences back into payment times (a running sum)
+void decodeTimestamps(const int32_t* deltas, size_t numOfRows, int64_t baseTimestamp, int64_t* timestamps) {
+    int64_t timestamp = baseTimestamp;
+    for (size_t i = 0; i < numOfRows; i++) {
+        timestamp += deltas[i];
+        timestamps[i] = timestamp;
+    }
+}
+
+// Function to mark (with 1) the rows whose payment time is within [periodStart, periodEnd)
+// Written without branches so the compiler can process several rows per instruction
+void buildPeriodMask(const int64_t* timestamps, size_t numOfRows, int64_t periodStart, int64_t periodEnd, uint8_t* mask) {
+    for (size_t i = 0; i < numOfRows; i++)
+        mask[i] = (uint8_t)((timestamps[i] >= periodStart) & (timestamps[i] < periodEnd));
+}
+
+// Function to add up the values of the marked rows
+// Unmarked rows are multiplied by 0 rather than skipped, so the loop has no branches and vectorizes
+int64_t sumMasked(const int64_t* values, const uint8_t* mask, size_t numOfRows) {
+    int64_t total = 0;
+    for (size_t i = 0; i < numOfRows; i++)
+        total += values[i] * mask[i];
+    return total;
+}
+
+// Function to add up the values of the marked rows separately for each key (a group-by)
+// The keys must be small non-negative numbers; sums must have room for the largest key
+template <typename Key>
+void groupSumMasked(const Key* keys, const int64_t* values, const uint8_t* mask, size_t numOfRows, int64_t* sums) {
+    for (size_t i = 0; i < numOfRows; i++)
+        sums[keys[i]] += values[i] * mask[i];
+}
+
+// Function to load the columnar snapshot of the order history
+// Snapshot structure: header, item name dictionary, then each column as one contiguous array
+// (numbers are stored in the machine's own byte order)
+// Returns false (leaving the columns empty) if there is no valid snapshot
+bool loadOrderSnapshot(string path, OrderColumns& columns) {
+    char magic[8] = {}; // File type marker, "NFCOL" followed by the format version
+    uint64_t numOfRows = 0; // Number of order lines in the snapshot
+    uint32_t numOfNames = 0; // Number of item names in the dictionary
+
+    ifstream file(path, ios::binary);
+    file.read(magic, sizeof(magic));
+    if (!file || memcmp(magic, "NFCOL\0\0\1", sizeof(magic)) != 0)
+        return false;
+
+    file.read((char*)&columns.baseTimestamp, sizeof(columns.baseTimestamp));
+    file.read((char*)&columns.sourceSize, sizeof(columns.sourceSize));
+    file.read((char*)&numOfRows, sizeof(numOfRows));
+    file.read((char*)&numOfNames, sizeof(numOfNames));
+
+    // Read the item name dictionary (each name is its length followed by its characters)
+    columns.names.resize(numOfNames);
+    for (uint32_t i = 0; i < numOfNames && file; i++) {
+        uint32_t length = 0;
+        file.read((char*)&length, sizeof(length));
+        columns.names[i].resize(length);
+        file.read(&columns.names[i][0], length);
+    }
+
+    // Read each column in one go
+    columns.timestampDeltas.resize(numOfRows);
+    columns.menuIndices.resize(numOfRows);
+    columns.nameIds.resize(numOfRows);
+    columns.quantities.resize(numOfRows);
+    columns.revenueCents.resize(numOfRows);
+    columns.areas.resize(numOfRows);
+    columns.newcomers.resize(numOfRows);
+    file.read((char*)columns.timestampDeltas.data(), numOfRows * sizeof(int32_t));
+    file.read((char*)columns.menuIndices.data(), numOfRows * sizeof(int32_t));
+    file.read((char*)columns.nameIds.data(), numOfRows * sizeof(uint32_t));
+    file.read((char*)columns.quantities.data(), numOfRows * sizeof(int32_t));
+    file.read((char*)columns.revenueCents.data(), numOfRows * sizeof(int64_t));
+    file.read((char*)columns.areas.data(), numOfRows);
+    file.read((char*)columns.newcomers.data(), numOfRows);
+
+    // A damaged snapshot is ignored and rebuilt from the order history
+    if (!file) {
+        columns = OrderColumns();
+        return false;
+    }
+    return true;
+}
+
+// Function to save the columnar snapshot of the order history
+// The snapshot is written to a temporary file first and then renamed, so readers never see half of it
+// (the previous snapshot is kept if this one could not be written)
+void saveOrderSnapshot(string path, const OrderColumns& columns) {
+    uint64_t numOfRows = columns.menuIndices.size(); // Number of order lines in the snapshot
+    uint32_t numOfNames = columns.names.size(); // Number of item names in the dictionary
+    string out; // The snapshot, built in memory and then written in one go
+
+    out.append("NFCOL\0\0\1", 8);
+    out.append((const char*)&columns.baseTimestamp, sizeof(columns.baseTimestamp));
+    out.append((const char*)&columns.sourceSize, sizeof(columns.sourceSize));
+    out.append((const char*)&numOfRows, sizeof(numOfRows));
+    out.append((const char*)&numOfNames, sizeof(numOfNames));
+
+    for (const string& name : columns.names) {
+        uint32_t length = name.length();
+        out.append((const char*)&length, sizeof(length));
+        out.append(name.data(), length);
+    }
+
+    out.append((const char*)columns.timestampDeltas.data(), numOfRows * sizeof(int32_t));
+    out.append((const char*)columns.menuIndices.data(), numOfRows * sizeof(int32_t));
+    out.append((const char*)columns.nameIds.data(), numOfRows * sizeof(uint32_t));
+    out.append((const char*)columns.quantities.data(), numOfRows * sizeof(int32_t));
+    out.append((const char*)columns.revenueCents.data(), numOfRows * sizeof(int64_t));
+    out.append((const char*)columns.areas.data(), numOfRows);
+    out.append((const char*)columns.newcomers.data(), numOfRows);
+
+    replaceFile(path, out);
+}
+
+// Function to add the order lines paid since the snapshot was saved to the columns
+// Only the part of the order history text after sourceSize is read, split into chunks at line
+// boundaries that are converted by several threads at once and then appended in order
+void refreshOrderSnapshot(OrderColumns& columns) {
+    string path = dataPath("order_history.txt"); // The order history text file
+    error_code error; // Set (instead of throwing) when the order history does not exist
+
+    flushWrites(); // Include the orders this program has paid for but not written yet
+    uintmax_t fileSize = filesystem::file_size(path, error);
+
+    if (error)
+        fileSize = 0;
+    if (fileSize < columns.sourceSize)
+        columns = OrderColumns(); // The order history was replaced, so convert it again from the start
+    if (fileSize == columns.sourceSize)
+        return; // Nothing new since the snapshot was saved
+
+    // Read the new part of the order history, up to its last complete line
+    string text(fileSize - columns.sourceSize, '\0');
+    ifstream file(path, ios::binary);
+    file.seekg(columns.sourceSize);
+    file.read(&text[0], text.size());
+    text.resize(file.gcount());
+    text.resize(text.rfind('\n') == string::npos ? 0 : text.rfind('\n') + 1);
+
+    // Split the text into chunks of about 4 MB that end at line boundaries
+    unsigned numOfWorkers = max(1u, thread::hardware_concurrency());
+    size_t chunkSize = max<size_t>(4 << 20, text.size() / numOfWorkers + 1);
+    vector<size_t> chunkStarts(1, 0); // Offset (within text) where each chunk starts
+    while (chunkStarts.back() + chunkSize < text.size()) {
+        size_t boundary = text.find('\n', chunkStarts.back() + chunkSize) + 1;
+        if (boundary == 0 || boundary >= text.size())
+            break;
+        chunkStarts.push_back(boundary);
+    }
+    chunkStarts.push_back(text.size());
+
+    // Convert every chunk into its own set of columns, several chunks at once
+    size_t numOfChunks = chunkStarts.size() - 1;
+    vector<OrderColumns> chunkColumns(numOfChunks);
+    vector<int64_t> chunkFirstTimestamps(numOfChunks, 0); // Payment time of each chunk's first line
+    atomic<size_t> nextChunk(0);
+    vector<thread> workers;
+
+    for (unsigned w = 0; w < min<size_t>(numOfWorkers, numOfChunks); w++) {
+        workers.emplace_back([&]() {
+            for (size_t c = nextChunk++; c < numOfChunks; c = nextChunk++) {
+                int64_t lastTimestamp = 0;
+                parseOrderHistoryChunk(text.substr(chunkStarts[c], chunkStarts[c + 1] - chunkStarts[c]), chunkColumns[c], lastTimestamp);
+                chunkFirstTimestamps[c] = chunkColumns[c].baseTimestamp;
+            }
+        });
+    }
+    for (thread& worker : workers)
+        worker.join();
+
+    // Append the chunks in order, joining their name dictionaries and timestamp differences
+    unordered_map<string, uint32_t> nameIds; // Dictionary number of each known item name
+    for (uint32_t i = 0; i < columns.names.size(); i++)
+        nameIds[columns.names[i]] = i;
+
+    int64_t lastTimestamp = columns.baseTimestamp; // Payment time of the last converted line
+    if (columns.menuIndices.empty())
+        columns.baseTimestamp = lastTimestamp = 0;
+    else
+        for (int32_t delta : columns.timestampDeltas)
+            lastTimestamp += delta;
+
+    for (size_t c = 0; c < numOfChunks; c++) {
+        OrderColumns& chunk = chunkColumns[c];
+        if (chunk.menuIndices.empty())
+            continue;
+
+        // The first line of the chunk is stored relative to the last line before it
+        if (columns.menuIndices.empty())
+            columns.baseTimestamp = lastTimestamp = chunkFirstTimestamps[c];
+        chunk.timestampDeltas[0] = (int32_t)(chunkFirstTimestamps[c] - lastTimestamp);
+        for (int32_t delta : chunk.timestampDeltas)
+            lastTimestamp += delta;
+
+        // Renumber the chunk's item names into the snapshot's dictionary
+        vector<uint32_t> remap(chunk.names.size());
+        for (uint32_t i = 0; i < chunk.names.size(); i++) {
+            auto found = nameIds.find(chunk.names[i]);
+            if (found == nameIds.end()) {
+                found = nameIds.emplace(chunk.names[i], columns.names.size()).first;
+                columns.names.push_back(chunk.names[i]);
+            }
+            remap[i] = found->second;
+        }
+        for (uint32_t& nameId : chunk.nameIds)
+            nameId = remap[nameId];
+
+        columns.timestampDeltas.insert(columns.timestampDeltas.end(), chunk.timestampDeltas.begin(), chunk.timestampDeltas.end());
+        columns.menuIndices.insert(columns.menuIndices.end(), chunk.menuIndices.begin(), chunk.menuIndices.end());
+        columns.nameIds.insert(columns.nameIds.end(), chunk.nameIds.begin(), chunk.nameIds.end());
+        columns.quantities.insert(columns.quantities.end(), chunk.quantities.begin(), chunk.quantities.end());
+        columns.revenueCents.insert(columns.revenueCents.end(), chunk.revenueCents.begin(), chunk.revenueCents.end());
+        columns.areas.insert(columns.areas.end(), chunk.areas.begin(), chunk.areas.end());
+        columns.newcomers.insert(columns.newcomers.end(), chunk.newcomers.begin(), chunk.newcomers.end());
+    }
+
+    columns.sourceSize += text.size();
+}
+
+// Function to convert one chunk of the order history text into columns
+// Order history structure: paidAt, deliveryArea, customerType, menuIndex, quantity, lineRevenue, itemName
+// The chunk's baseTimestamp is set to the payment time of its first line
+void parseOrderHistoryChunk(const string& chunk, OrderColumns& columns, int64_t& lastTimestamp) {
+    const char* position = chunk.c_str(); // Start of the line being parsed
+    const char* end = position + chunk.size(); // End of the chunk
+    unordered_map<string, uint32_t> nameIds; // Dictionary number of each item name in this chunk
+
+    while (position < end) {
+        const char* lineEnd = (const char*)memchr(position, '\n', end - position);
+        if (lineEnd == nullptr)
+            lineEnd = end;
+
+        // Parse the fixed columns of the line, skipping lines that are not complete
+        char* next = nullptr;
+        int64_t paidAt = strtoll(position, &next, 10);
+        if (next + 5 < lineEnd && *next == ',' && next[2] == ',' && next[4] == ',') {
+            uint8_t area = next[1] - '0';
+            uint8_t newcomer = next[3] == 'N';
+            int menuIndex = strtol(next + 5, &next, 10);
+            int quantity = strtol(next + 1, &next, 10);
+            int64_t lineRevenue = parseCents(next + 1, &next);
+
+            if (*next == ',' && next < lineEnd && menuIndex >= 0 && area <= NUM_OF_DELIVERY_AREAS) {
+                string name((const char*)next + 1, lineEnd);
+                auto found = nameIds.find(name);
+                if (found == nameIds.end()) {
+                    found = nameIds.emplace(name, columns.names.size()).first;
+                    columns.names.push_back(name);
+                }
+
+                if (columns.menuIndices.empty())
+                    columns.baseTimestamp = lastTimestamp = paidAt;
+                columns.timestampDeltas.push_back((int32_t)(paidAt - lastTimestamp));
+                lastTimestamp = paidAt;
+                columns.menuIndices.push_back(menuIndex);
+                columns.nameIds.push_back(found->second);
+                columns.quantities.push_back(quantity);
+                columns.revenueCents.push_back(lineRevenue);
+                columns.areas.push_back(area);
+                columns.newcomers.push_back(newcomer);
+            }
+        }
+
+        position = lineEnd + 1; // Move on to the next line
+    }
+}
+
+// Function to return an amount of money with two decimals, e.g. "12.50"
+string Money::str() const {
+    return formatCents(cents);
+}
+
+// Function to read the next line of input into line, refilling the buffer from standard input in blocks
+// Returns false once the input has run out and no characters are left
+bool readInputLine(InputReader& reader, string& line) {
+    line.clear();
+    while (true) {
+        if (reader.position == reader.length) {
+            if (reader.ended)
+                return !line.empty(); // A last line without a newline still counts
+            cout.flush(); // Make sure the prompt is shown before waiting for the user
+            reader.length = fread(reader.buffer.data(), 1, reader.buffer.size(), stdin);
+            reader.position = 0;
+            if (reader.length == 0) {
+                reader.ended = true;
+                continue;
+            }
+        }
+
+        // Take everything up to the next newline (or the end of the buffer) in one go
+        const char* start = reader.buffer.data() + reader.position;
+        const char* newline = (const char*)memchr(start, '\n', reader.length - reader.position);
+        if (newline == nullptr) {
+            line.append(start, reader.length - reader.position);
+            reader.position = reader.length;
+            continue;
+        }
+        line.append(start, newline - start);
+        reader.position += newline - start + 1;
+        if (!line.empty() && line.back() == '\r') // Lines typed on Windows end with "\r\n"
+            line.pop_back();
+        return true;
+    }
+}
+
+// Function to read the next line typed by the user
+// The program ends here if there is nothing left to read, since no prompt could ever be answered
+string readLine() {
+    string line;
+    if (!readInputLine(input, line)) {
+        cout << "\n/// End of input. Exiting...\n";
+        exit(0);
+    }
+    return line;
+}
+
+// Function to read the next non-blank line typed by the user, without its surrounding spaces
+string readToken() {
+    while (true) {
+        string line = readLine();
+        size_t first = line.find_first_not_of(" \t");
+        if (first != string::npos)
+            return line.substr(first, line.find_last_not_of(" \t") - first + 1);
+    }
+}
+
+// Function to read a one-character choice such as 'Y' or '1'
+// Returns '\0' if the user typed more than one character, so it never matches a valid choice
+char readChoice() {
+    string token = readToken();
+    return token.length() == 1 ? token[0] : '\0';
+}
+
+// Function to parse a whole number such as "12" or "-3"
+// Returns false (leaving value unchanged) unless the whole text is a number that fits in an int
+bool parseInt(const string& text, int& value) {
+    const char* first = text.data();
+    const char* last = first + text.length();
+    if (first != last && *first == '+') // from_chars does not accept a leading plus sign
+        ++first;
+    int parsed = 0;
+    from_chars_result result = from_chars(first, last, parsed);
+    if (result.ec != errc() || result.ptr != last || first == last)
+        return false;
+    value = parsed;
+    return true;
+}
+
+// Function to read a whole number typed by the user
+// Returns false if the line is not a whole number; the line is used up either way
+bool readInt(int& value) {
+    return parseInt(readToken(), value);
+}
+
+// Function to show a prompt and read a one-character answer until it is one of the given choices
+char promptChoice(string prompt, string choices) {
+    cout << prompt;
+    char choice = readChoice();
+    while (choice == '\0' || choices.find(choice) == string::npos) {
+        cout << "\n/// Invalid selection. Please try again!\n" << prompt;
+        choice = readChoice();
+    }
+    return choice;
+}
+
+// Function to write an amount of money with two decimals (so it can be used with cout and files)
+ostream& operator<<(ostream& out, Money amount) {
+    return out << amount.str();
+}
+
+// Function to return an amount of money without its sign
+Money abs(Money amount) {
+    return Money{amount.cents < 0 ? -amount.cents : amount.cents};
+}
+
+// Function to parse an amount of money such as "12.50", "12.5", "-0.80" or "12"
+// Returns false (leaving amount unchanged) if the text is not an amount with at most two decimals
+bool parseMoney(string text, Money& amount) {
+    size_t first = text.find_first_not_of(" \t\r"); // Ignore surrounding spaces
+    size_t last = text.find_last_not_of(" \t\r");
+    if (first == string::npos)
+        return false;
+    text = text.substr(first, last - first + 1);
+
+    // Check the format: optional sign, digits, then optionally a point and one or two digits
+    size_t position = (text[0] == '-' || text[0] == '+') ? 1 : 0;
+    size_t numOfDigits = 0;
+    while (position < text.length() && isdigit((unsigned char)text[position])) {
+        ++position;
+        ++numOfDigits;
+    }
+    if (position < text.length() && text[position] == '.') {
+        size_t numOfDecimals = 0;
+        while (++position < text.length() && isdigit((unsigned char)text[position]))
+            ++numOfDecimals;
+        if (numOfDecimals > 2)
+            return false;
+        numOfDigits += numOfDecimals;
+    }
+    if (position != text.length() || numOfDigits == 0 || numOfDigits > 15)
+        return false;
+
+    char* end = nullptr;
+    amount = Money{parseCents(text.c_str(), &end)};
+    return true;
+}
+
+// Function to work out a percentage of an amount, rounded to the nearest cent (halves round away from zero)
+Money percentOf(Money amount, int percent) {
+    int64_t hundredths = amount.cents * percent; // The result in hundredths of a cent
+    return Money{(hundredths + (hundredths < 0 ? -50 : 50)) / 100};
+}
+
+// Function to format an amount in cents as dollars and cents, e.g. 1250 -> "12.50"
+string formatCents(int64_t cents) {
+    string sign = cents < 0 ? "-" : "";
+    uint64_t amount = cents < 0 ? -(uint64_t)cents : cents;
+    string fraction = to_string(amount % 100);
+    return sign + to_string(amount / 100) + "." + (fraction.length() == 1 ? "0" : "") + fraction;
+}
+
+// Function to parse an amount such as "12.50", "12.5" or "12" into cents without rounding errors
+// Digits after the second decimal place are rounded half up; end is set to the first character not used
+int64_t parseCents(const char* text, char** end) {
+    const char* position = text;
+    bool negative = false;
+    int64_t cents = 0;
+
+    if (*position == '-' || *position == '+')
+        negative = *position++ == '-';
+    while (isdigit((unsigned char)*position))
+        cents = cents * 10 + (*position++ - '0');
+    cents *= 100;
+
+    if (*position == '.') {
+        ++position;
+        if (isdigit((unsigned char)*position))
+            cents += (*position++ - '0') * 10;
+        if (isdigit((unsigned char)*position))
+            cents += *position++ - '0';
+        if (isdigit((unsigned char)*position) && *position >= '5')
+            cents += 1;
+        while (isdigit((unsigned char)*position))
+            ++position;
+    }
+
+    *end = (char*)position;
+    return negative ? -cents : cents;
+}
+
+// Function to add the totals of one report to another
+void mergeSalesReport(SalesReport& into, const SalesReport& from) {
+    into.numOfOrderLines += from.numOfOrderLines;
+    into.totalRevenue += from.totalRevenue;
+    into.itemRevenue.resize(max(into.itemRevenue.size(), from.itemRevenue.size()), 0);
+    into.itemQuantity.resize(max(into.itemQuantity.size(), from.itemQuantity.size()), 0);
+    for (size_t item = 0; item < from.itemRevenue.size(); item++) {
+        into.itemRevenue[item] += from.itemRevenue[item];
+        into.itemQuantity[item] += from.itemQuantity[item];
+    }
+    for (const auto& item : from.itemNames)
+        into.itemNames.insert(item);
+    for (int hour = 0; hour < 24; hour++)
+        into.hourRevenue[hour] += from.hourRevenue[hour];
+    for (int area = 0; area <= NUM_OF_DELIVERY_AREAS; area++)
+        into.areaRevenue[area] += from.areaRevenue[area];
+    into.newcomerRevenue += from.newcomerRevenue;
+    into.returningRevenue += from.returningRevenue;
+}
+
+// Function to run a synthetic day of orders through the order and payment path, without any prompts,
+// and report the throughput, the rejection rate and how much each data file grew
+// The day runs in a scratch branch holding a copy of the menu and promotions of the branch named by
+// NINJAFOOD_BRANCH (or the main branch), so the real files are never touched. Orders arrive in the hours
+// of SIMULATION_HOURLY_WEIGHTS, pick their items by Zipf popularity, come from new or returning customers,
+// and are delivered to any of the delivery areas. Kitchen tickets are not sent, as nobody dispatches them
+void runSimulation(int numOfOrders) {
+    const char* presetBranch = getenv("NINJAFOOD_BRANCH");
+    string sourceBranchId = presetBranch != nullptr ? presetBranch : ""; // Branch whose menu is copied
+    const vector<string> trackedFiles = {"menu.txt", "topdish.txt", "total_sales.txt", "order_history.txt",
+                                         "customer_profiles.dat", "customer_names.dat", "events.log", "payments.txt"};
+
+    if (numOfOrders <= 0) {
+        cout << "\n/// NINJAFOOD_SIMULATE must be the number of orders to simulate.\n";
+        return;
+    }
+    if (!filesystem::exists(branchPath(sourceBranchId, "menu.txt"))) {
+        cout << "\n/// Sorry, menu does not exist. Please CREATE MENU before simulating orders.\n";
+        return;
+    }
+
+    // Start the scratch branch afresh from the source branch's menu and promotions
+    error_code error; // Set (instead of throwing) when a file to copy does not exist
+    filesystem::remove_all(branchPath(SIMULATION_BRANCH_ID, ""), error);
+    filesystem::create_directories(branchPath(SIMULATION_BRANCH_ID, ""));
+    filesystem::copy_file(branchPath(sourceBranchId, "menu.txt"), branchPath(SIMULATION_BRANCH_ID, "menu.txt"), error);
+    filesystem::copy_file(branchPath(sourceBranchId, "promotions.txt"), branchPath(SIMULATION_BRANCH_ID, "promotions.txt"), error);
+    flushWrites(); // The live stock of the branch left behind is written to its own menu file
+    currentBranchId = SIMULATION_BRANCH_ID;
+    branchSelected = true;
+    startPersistence();
+    startSettlement();
+    startSharedCatalog();
+
+    shared_ptr<BranchCatalog> catalog = loadBranchCatalog(currentBranchId);
+    if (catalog->totalNumItems == 0) {
+        cout << "\n/// Sorry, menu does not exist. Please CREATE MENU before simulating orders.\n";
+        return;
+    }
+
+    vector<uintmax_t> sizesBefore; // Size of each tracked file before the simulation
+    for (const string& fileName : trackedFiles)
+        sizesBefore.push_back(simulationFileSize(fileName));
+
+    mt19937 generator(SIMULATION_SEED);
+
+    // Rank the menu items by popularity in a random order, and give the n-th most popular item a weight of 1 / n^s
+    vector<int> rowOfRank(catalog->totalNumItems); // Menu row of each popularity rank
+    vector<double> rankWeights(catalog->totalNumItems); // Popularity of each rank
+    for (int rank = 0; rank < catalog->totalNumItems; rank++) {
+        rowOfRank[rank] = rank;
+        rankWeights[rank] = 1.0 / pow(rank + 1, SIMULATION_ZIPF_EXPONENT);
+    }
+    shuffle(rowOfRank.begin(), rowOfRank.end(), generator);
+    discrete_distribution<int> pickRank(rankWeights.begin(), rankWeights.end());
+    discrete_distribution<int> pickHour(begin(SIMULATION_HOURLY_WEIGHTS), end(SIMULATION_HOURLY_WEIGHTS));
+
+    // The orders arrive through today, in time order
+    time_t now = time(0);
+    tm midnight = *localtime(&now);
+    midnight.tm_hour = midnight.tm_min = midnight.tm_sec = 0;
+    time_t dayStart = mktime(&midnight);
+    vector<time_t> arrivals(numOfOrders); // When each order is placed
+    for (time_t& arrival : arrivals)
+        arrival = dayStart + pickHour(generator) * 3600 + generator() % 3600;
+    sort(arrivals.begin(), arrivals.end());
+
+    cout << "\n/// Simulating a day of " << numOfOrders << " orders on a copy of the "
+         << (sourceBranchId.empty() ? "main branch" : "branch " + sourceBranchId) << "...\n";
+
+    SimulationStats stats;
+    deque<SimulatedOrder> unsettled; // Orders whose payment is being settled, oldest first
+    vector<string> phoneNumbers; // Phone numbers of the customers seen so far
+    auto startedAt = chrono::steady_clock::now();
+
+    for (time_t arrival : arrivals) {
+        UserDetails ud;
+
+        // A returning customer is one of the customers seen so far; anybody else gets a new phone number
+        if (!phoneNumbers.empty() && (int)(generator() % 100) < SIMULATION_RETURNING_PERCENT) {
+            ud.phoneNumber = phoneNumbers[generator() % phoneNumbers.size()];
+        } else {
+            ud.phoneNumber = "01" + to_string(10000000 + phoneNumbers.size());
+            phoneNumbers.push_back(ud.phoneNumber);
+        }
+        ud.customerName = "Customer " + ud.phoneNumber.substr(2);
+
+        // Pick the order lines, with a size and any add-ons for items that have them
+        vector<SimulatedLine> lines(1 + generator() % SIMULATION_MAX_LINES);
+        for (SimulatedLine& line : lines) {
+            line.row = rowOfRank[pickRank(generator)];
+            line.quantity = 1 + generator() % SIMULATION_MAX_QUANTITY;
+            line.modifierMask = 0;
+
+            uint32_t first = catalog->model.modifierStart[line.row];
+            vector<int> sizes; // Positions (within the item's modifiers) of the size options
+            for (uint32_t k = first; k < catalog->model.modifierStart[line.row + 1]; k++) {
+                if (catalog->model.modifiers[k].kind == 'S')
+                    sizes.push_back(k - first);
+                else if ((int)(generator() % 100) < SIMULATION_ADDON_PERCENT)
+                    line.modifierMask |= 1 << (k - first);
+            }
+            if (!sizes.empty())
+                line.modifierMask |= 1 << sizes[generator() % sizes.size()];
+        }
+
+        ++stats.hourOrders[(arrival - dayStart) / 3600];
+        simulateOrder(ud, arrival, (char)('1' + generator() % NUM_OF_DELIVERY_AREAS), lines, unsettled, stats);
+        finishSimulatedOrders(unsettled, false, stats);
+    }
+
+    flushWrites(); // The files are only complete once the persistence thread has written everything
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startedAt).count();
+
+    // The payments are settled in the background; how long they take after the last order shows how far the
+    // payment gateway fell behind (see NINJAFOOD_GATEWAY_LATENCY_MS). The orders still waiting are then finished
+    finishSimulatedOrders(unsettled, true, stats);
+    flushSettlements();
+    flushWrites();
+    double settlementSeconds = chrono::duration<double>(chrono::steady_clock::now() - startedAt).count() - seconds;
+
+    // Display the results of the simulation
+    cout << "\n==================== SIMULATION RESULTS ====================\n";
+    cout << left << setw(34) << "ORDERS PLACED:" << stats.numOfOrders << "\n";
+    cout << setw(34) << "ORDERS PAID:" << stats.numOfPaidOrders << " (" << stats.numOfNewcomers << " from newcomers)\n";
+    cout << setw(34) << "ORDER LINES:" << stats.numOfLines << "\n";
+    cout << setw(34) << "LINES REJECTED (NO STOCK):" << stats.numOfRejectedLines << " ("
+         << fixed << setprecision(1) << 100.0 * stats.numOfRejectedLines / max(1, stats.numOfLines) << "%)\n";
+    cout << setw(34) << "ORDERS WITH EVERY LINE REJECTED:" << stats.numOfEmptyOrders << "\n";
+    cout << setw(34) << "ORDERS TURNED DOWN AT PAYMENT:" << stats.numOfFailedPayments << "\n";
+    cout << setw(34) << "ORDERS WITH PAYMENT NOT SETTLED:" << stats.numOfUnsettledOrders << "\n";
+    cout << setw(34) << "TOTAL REVENUE:" << "$" << stats.totalRevenue << "\n";
+    cout << setw(34) << "ELAPSED TIME:" << setprecision(3) << seconds << " s ("
+         << setprecision(0) << stats.numOfOrders / max(seconds, 1e-9) << " orders per second)\n";
+    cout << setw(34) << "PAYMENTS SETTLED:" << settlements.numOfPayments[(int)PaymentState::Settled] << " ("
+         << settlements.numOfPayments[(int)PaymentState::Declined] << " declined, "
+         << settlements.numOfPayments[(int)PaymentState::Failed] << " failed)\n";
+    cout << setw(34) << "CHARGED THROUGH THE GATEWAY:" << "$" << Money{paymentGateway.chargedCents} << " ("
+         << paymentGateway.numOfLostReplies << " replies lost and asked again)\n";
+    cout << setw(34) << "SETTLEMENT FINISHED:" << setprecision(3) << settlementSeconds << " s after the last order\n";
+
+    cout << "\nHOUR\tORDERS\n";
+    for (int hour = 0; hour < 24; hour++) {
+        if (stats.hourOrders[hour] > 0)
+            cout << setfill('0') << right << setw(2) << hour << ":00\t" << setfill(' ') << stats.hourOrders[hour] << "\n";
+    }
+
+    cout << "\nFILE\t\t\tBEFORE\t\tAFTER\t\tGROWTH (bytes)\n";
+    for (size_t i = 0; i < trackedFiles.size(); i++) {
+        uintmax_t sizeAfter = simulationFileSize(trackedFiles[i]);
+        cout << left << setw(24) << trackedFiles[i] << setw(16) << sizesBefore[i] << setw(16) << sizeAfter
+             << (long long)sizeAfter - (long long)sizesBefore[i] << "\n";
+    }
+    cout << "============================================================\n";
+}
+
+// Function to place and pay for one simulated order, going through the same steps as a customer does:
+// every line is reserved by acceptOrder, the cart is priced with the branch's promotions and the payment is
+// handed over to be settled. The order is finished by finishSimulatedOrders once its payment has been settled,
+// so the simulated front end (like a real one) is not held up by the payment gateway
+void simulateOrder(UserDetails& ud, time_t placedAt, char deliveryAreaNum, const vector<SimulatedLine>& lines, deque<SimulatedOrder>& unsettled, SimulationStats& stats) {
+    shared_ptr<BranchCatalog> catalog = loadBranchCatalog(currentBranchId);
+    int numOfLines = lines.size(); // Number of lines in the order
+    SimulatedOrder order; // The order, as it is finished once paid
+    vector<CartLine> cartLines; // The accepted lines, for pricing
+
+    ++stats.numOfOrders;
+    stats.numOfLines += numOfLines;
+    ud.orderId = createReservation();
+    ud.pinnedPrices = catalog->prices;
+
+    // Reserve the stock of each line, in the order layout used by orderOnline
+    int** arrOrder = new int*[numOfLines];
+    for (int x = 0; x < numOfLines; x++) {
+        arrOrder[x] = new int[3];
+        arrOrder[x][0] = stoi(catalog->arrMenuContent[lines[x].row][MENU_INDEX]);
+        arrOrder[x][1] = lines[x].quantity;
+        arrOrder[x][2] = lines[x].modifierMask;
+
+        if (acceptOrder(arrOrder, x, ud.orderId, *ud.pinnedPrices) != 0) {
+            ++stats.numOfRejectedLines;
+            continue;
+        }
+        order.orderedMenuIndices.push_back(arrOrder[x][0]);
+        order.orderedItemNames.push_back(orderLineName(catalog->arrMenuContent, catalog->model, lines[x].row, lines[x].modifierMask));
+        order.orderedQuantities.push_back(lines[x].quantity);
+        cartLines.push_back({lines[x].row, orderLinePrice(*ud.pinnedPrices, catalog->arrMenuContent, catalog->model, lines[x].row, lines[x].modifierMask),
+                             lines[x].quantity});
+    }
+    for (int x = 0; x < numOfLines; x++)
+        delete[] arrOrder[x];
+    delete[] arrOrder;
+
+    if (cartLines.empty()) {
+        ++stats.numOfEmptyOrders;
+        releaseReservation(ud.orderId);
+        return;
+    }
+
+    // Price the order (the cart's reservation holds its stock until the payment is settled)
+    order.orderId = ud.orderId;
+    ud.orderId = 0;
+    ud.pinnedPrices = nullptr;
+    order.previousOrders = customerVisitCount(ud.phoneNumber);
+    PricedCart pricedCart = priceCart(catalog->promotions, catalog->model, cartLines, order.previousOrders, placedAt);
+
+    // Pay with each tender in turn (paying by card and e-wallet through the payment gateway, in the background
+    // when the gateway is slow)
+    Payment payment;
+    payment.key = paymentKey(order.orderId, 1);
+    payment.tender = stats.numOfOrders % NUM_OF_TENDERS;
+    if (TENDERS[payment.tender].reference == TenderReference::CardNumber)
+        payment.reference = SIMULATION_CARD_NUMBER;
+    else if (TENDERS[payment.tender].reference == TenderReference::PhoneNumber)
+        payment.reference = ud.phoneNumber;
+    payment.amount = pricedCart.total;
+    payment.paidAt = placedAt;
+    payment.awaited = true;
+    submitPayment(payment);
+
+    order.customer = ud;
+    order.paymentKey = payment.key;
+    order.placedAt = placedAt;
+    order.deliveryAreaNum = deliveryAreaNum;
+    order.total = pricedCart.total;
+    order.lineRevenue = pricedCart.lineRevenue;
+    unsettled.push_back(move(order));
+}
+
+// Function to finish the simulated orders whose payment has been settled, oldest first, as makePayments does:
+// the stock is deducted and the order is recorded in the sales files and the customer's profile
+// An order whose payment was not settled is cancelled. With wait set, every order is finished
+void finishSimulatedOrders(deque<SimulatedOrder>& unsettled, bool wait, SimulationStats& stats) {
+    PaymentState state = PaymentState::Failed; // Outcome of the oldest order's payment
+
+    while (!unsettled.empty() && takeSettlement(unsettled.front().paymentKey, state, wait)) {
+        SimulatedOrder& order = unsettled.front();
+        int unavailableItem = 0; // Menu index of an item no longer available (or STOCK_NOT_SAVED)
+        if (state == PaymentState::Settled)
+            unavailableItem = commitOrderStock(order.orderId, order.orderedMenuIndices, order.orderedQuantities);
+        else
+            releaseReservation(order.orderId);
+
+        vector<EventRecord> events;
+        if (state != PaymentState::Settled) {
+            ++stats.numOfUnsettledOrders;
+        } else if (unavailableItem != 0) {
+            ++stats.numOfFailedPayments;
+            addEvent(events, EVENT_ORDER_CANCELLED, order.orderId, 0, 0, order.total.cents);
+        } else {
+            queueAppend(dataPath("total_sales.txt"), order.total.str() + "\n"); // As makePayments does
+            recordCustomerOrder(order.customer, order.placedAt, order.total, order.orderedMenuIndices, order.orderedQuantities);
+            recordOrderHistory(order.placedAt, order.deliveryAreaNum, order.previousOrders == 0, order.orderedMenuIndices,
+                               order.orderedItemNames, order.orderedQuantities, order.lineRevenue);
+            addEvent(events, EVENT_PAYMENT_COMPLETED, order.orderId, 0, (int)order.orderedMenuIndices.size(), order.total.cents);
+
+            ++stats.numOfPaidOrders;
+            if (order.previousOrders == 0)
+                ++stats.numOfNewcomers;
+            stats.totalRevenue += order.total;
+        }
+        if (!events.empty())
+            queueEvents(events);
+        unsettled.pop_front();
+    }
+}
+
+// Function to return the size of a data file of the simulation branch (0 if it does not exist)
+uintmax_t simulationFileSize(string fileName) {
+    error_code error; // Set (instead of throwing) when the file does not exist
+    uintmax_t size = filesystem::file_size(branchPath(SIMULATION_BRANCH_ID, fileName), error);
+    return error ? 0 : size;
+}
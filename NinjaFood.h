@@ -0,0 +1,11 @@
+// NinjaFood food ordering system
+// The whole system is built as a library; the application (Main.cpp) only starts it, so the
+// benchmark and profiling builds run exactly the same code as the kiosks
+#ifndef NINJAFOOD_H
+#define NINJAFOOD_H
+
+// Function to run the program from its main page until the user exits
+// With the NINJAFOOD_SIMULATE environment variable set, runs a simulated day of orders instead
+int runProgram();
+
+#endif
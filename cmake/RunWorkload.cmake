@@ -0,0 +1,68 @@
+# Runs the benchmark workload: a simulated day of ORDERS orders (NINJAFOOD_SIMULATE) against the menu and
+# promotions in WORKLOAD_DIR, started afresh in RUN_DIR for every run. The best orders per second of RUNS
+# runs is reported (the best run is the one least disturbed by the rest of the machine).
+#
+#   APP                 The NinjaFood application to run
+#   WORKLOAD_DIR        Folder with the workload's menu.txt and promotions.txt
+#   RUN_DIR             Scratch folder the runs write their data files to
+#   ORDERS              Number of orders in the simulated day
+#   RUNS                Number of runs (default 3)
+#   BASELINE_FILE       File holding the baseline orders per second
+#   THRESHOLD_PERCENT   Fail if the orders per second is more than this much below the baseline
+#   RECORD_BASELINE     Write the orders per second to BASELINE_FILE instead of checking it
+
+foreach(required APP WORKLOAD_DIR RUN_DIR ORDERS)
+    if(NOT DEFINED ${required})
+        message(FATAL_ERROR "RunWorkload.cmake needs -D${required}=...")
+    endif()
+endforeach()
+if(NOT DEFINED RUNS)
+    set(RUNS 3)
+endif()
+
+set(best_rate 0)
+foreach(run RANGE 1 ${RUNS})
+    file(REMOVE_RECURSE "${RUN_DIR}")
+    file(MAKE_DIRECTORY "${RUN_DIR}")
+    file(COPY "${WORKLOAD_DIR}/menu.txt" "${WORKLOAD_DIR}/promotions.txt" DESTINATION "${RUN_DIR}")
+
+    execute_process(
+        COMMAND "${CMAKE_COMMAND}" -E env NINJAFOOD_SIMULATE=${ORDERS} --unset=NINJAFOOD_BRANCH "${APP}"
+        WORKING_DIRECTORY "${RUN_DIR}"
+        RESULT_VARIABLE result
+        OUTPUT_VARIABLE output
+        ERROR_VARIABLE output)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "The workload failed (${result}):\n${output}")
+    endif()
+
+    string(REGEX MATCH "\\(([0-9]+) orders per second\\)" rate_match "${output}")
+    if(NOT rate_match)
+        message(FATAL_ERROR "The workload did not report its orders per second:\n${output}")
+    endif()
+    set(rate ${CMAKE_MATCH_1})
+    message(STATUS "Run ${run} of ${RUNS}: ${rate} orders per second")
+    if(rate GREATER best_rate)
+        set(best_rate ${rate})
+        set(best_output "${output}")
+    endif()
+endforeach()
+
+message("${best_output}")
+message(STATUS "Best of ${RUNS}: ${best_rate} orders per second")
+
+if(RECORD_BASELINE)
+    file(WRITE "${BASELINE_FILE}" "${best_rate}\n")
+    message(STATUS "Baseline written to ${BASELINE_FILE}")
+elseif(DEFINED BASELINE_FILE)
+    if(NOT EXISTS "${BASELINE_FILE}")
+        message(FATAL_ERROR "No baseline at ${BASELINE_FILE}; record one with the perf-baseline target")
+    endif()
+    file(STRINGS "${BASELINE_FILE}" baseline LIMIT_COUNT 1)
+    math(EXPR minimum_rate "${baseline} * (100 - ${THRESHOLD_PERCENT}) / 100")
+    if(best_rate LESS minimum_rate)
+        message(FATAL_ERROR "Performance regression: ${best_rate} orders per second, below ${minimum_rate} "
+                            "(baseline ${baseline} less ${THRESHOLD_PERCENT}%)")
+    endif()
+    message(STATUS "Perf check passed: ${best_rate} orders per second (minimum ${minimum_rate}, baseline ${baseline})")
+endif()
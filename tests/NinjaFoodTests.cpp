@@ -0,0 +1,594 @@
+// Unit tests of the NinjaFood library
+// Most of the system is internal to NinjaFood.cpp, so the tests are built from the same source instead of
+// linking the library. Each group of tests is run by name (ninjafood_tests <group>), or every group without one
+#include "NinjaFood.cpp"
+#ifndef _WIN32
+#include <sys/wait.h>
+#endif
+
+// Number of checks that failed in the groups run so far
+int numOfFailedChecks = 0;
+
+// Checks a condition, reporting where it failed without stopping the group
+#define CHECK(condition) checkCondition((condition), #condition, __FILE__, __LINE__)
+
+// Function to record the result of one check, printing the check if it failed
+void checkCondition(bool passed, const char* condition, const char* file, int line) {
+    if (passed)
+        return;
+    cerr << file << ":" << line << ": check failed: " << condition << "\n";
+    ++numOfFailedChecks;
+}
+
+// Function to test parseMoney on amounts in every accepted form and on text that is not an amount
+void testParseMoney() {
+    Money amount;
+
+    CHECK(parseMoney("12.50", amount) && amount.cents == 1250);
+    CHECK(parseMoney("12.5", amount) && amount.cents == 1250);
+    CHECK(parseMoney("12", amount) && amount.cents == 1200);
+    CHECK(parseMoney("-0.80", amount) && amount.cents == -80);
+    CHECK(parseMoney("+3.05", amount) && amount.cents == 305);
+    CHECK(parseMoney(" 7.00\r", amount) && amount.cents == 700);
+    CHECK(parseMoney(".5", amount) && amount.cents == 50);
+    CHECK(parseMoney("999999999999999", amount) && amount.cents == 99999999999999900);
+
+    // A rejected amount leaves the previous one in place
+    amount = Money{42};
+    CHECK(!parseMoney("", amount));
+    CHECK(!parseMoney("  ", amount));
+    CHECK(!parseMoney("1.234", amount));
+    CHECK(!parseMoney("1.2.3", amount));
+    CHECK(!parseMoney("12a", amount));
+    CHECK(!parseMoney("-", amount));
+    CHECK(!parseMoney(".", amount));
+    CHECK(!parseMoney("1 000", amount));
+    CHECK(!parseMoney("1000000000000000", amount));
+    CHECK(amount.cents == 42);
+
+    CHECK(Money{1250}.str() == "12.50");
+    CHECK(Money{-80}.str() == "-0.80");
+}
+
+// Function to make a file the standard input, so the input layer reads it as if it were typed
+void typeInput(string path, string text) {
+    ofstream(path, ios::binary | ios::trunc) << text;
+    CHECK(freopen(path.c_str(), "r", stdin) != nullptr);
+}
+
+// Function to test that the input layer reads junk a line at a time, recovers from it, and stops at the end of input
+void testInputParser() {
+    const string path = "input_test.txt"; // Stands in for what the user types
+    stringstream prompts; // Holds the prompts shown, which are not part of the test output
+    streambuf* screen = cout.rdbuf(prompts.rdbuf());
+
+    // Lines longer than the buffer, Windows line ends, blank lines and a last line without a newline
+    typeInput(path, "first line\r\n\nmore than one block\nlast");
+    InputReader reader;
+    reader.buffer.resize(4);
+    string line;
+    CHECK(readInputLine(reader, line) && line == "first line");
+    CHECK(readInputLine(reader, line) && line.empty());
+    CHECK(readInputLine(reader, line) && line == "more than one block");
+    CHECK(readInputLine(reader, line) && line == "last");
+    CHECK(!readInputLine(reader, line) && !readInputLine(reader, line));
+
+    // Whole numbers only, with nothing left over
+    int value = 7;
+    CHECK(parseInt("42", value) && value == 42);
+    CHECK(parseInt("+5", value) && value == 5);
+    CHECK(parseInt("-3", value) && value == -3);
+    value = 7;
+    CHECK(!parseInt("", value) && !parseInt("+", value) && !parseInt("12abc", value) && !parseInt("1.5", value));
+    CHECK(!parseInt(" 1", value) && !parseInt("99999999999", value) && !parseInt("\xff\xfe", value));
+    CHECK(value == 7);
+
+    // Junk costs one line each: a prompt asks again until it gets an answer it accepts
+    typeInput(path, "   \n  Yes  \n\x01\n  y \n12x\n 12 \nzz\n\xc3\xa9\nQ\nb\n");
+    input = InputReader();
+    CHECK(readChoice() == '\0'); // "Yes"
+    CHECK(readChoice() == '\x01');
+    CHECK(readChoice() == 'y');
+    CHECK(!readInt(value) && value == 7);
+    CHECK(readInt(value) && value == 12);
+    CHECK(promptChoice("=> Choose [A/B]: ", "AaBb") == 'b');
+    CHECK(prompts.str().find("Invalid selection") != string::npos);
+    cout.rdbuf(screen);
+
+#ifndef _WIN32
+    // A prompt that can never be answered ends the program instead of waiting forever
+    typeInput(path, "\n  \n");
+    input = InputReader();
+    pid_t kiosk = fork();
+    if (kiosk == 0) {
+        cout.rdbuf(prompts.rdbuf());
+        readToken();
+        _exit(1); // Not reached if the end of input ended the program
+    }
+    int status = 0; // How the kiosk process ended
+    waitpid(kiosk, &status, 0);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+#endif
+
+    remove(path.c_str());
+}
+
+// Function to test that menu lines read back into the same line, and the parsing of combo components
+void testMenuLines() {
+    const string lines[] = {
+        "1,Chicken Rice,8.50,12,40,Mains,S:Regular:0.00;S:Large:1.50;A:Egg:0.80",
+        "2,Iced Tea,2.00,2,100",
+        "3,Soup,4.00,5,0,Sides",
+        "4,Lunch Set,10.00,15,0,Combos,,1:1;2:1",
+    };
+    const int numOfLines = sizeof(lines) / sizeof(lines[0]);
+    string fields[numOfLines][NUM_OF_MENU_FIELDS]; // Details of each item
+    string* arrMenuContent[numOfLines]; // The items as the rows of a menu
+
+    for (int i = 0; i < numOfLines; i++) {
+        CHECK(parseMenuLine(lines[i], fields[i]));
+        CHECK(formatMenuLine(fields[i]) == lines[i]);
+        arrMenuContent[i] = fields[i];
+    }
+    CHECK(fields[1][MENU_CATEGORY].empty() && fields[1][MENU_COMPONENTS].empty());
+    CHECK(fields[3][MENU_MODIFIERS].empty() && fields[3][MENU_COMPONENTS] == "1:1;2:1");
+
+    // Numbers and prices are stored in their usual form, and Windows line ends are dropped
+    string item[NUM_OF_MENU_FIELDS]; // Details of one item
+    CHECK(parseMenuLine("5, Noodles ,7.5, 09 ,3\r", item));
+    CHECK(item[MENU_NAME] == " Noodles " && item[MENU_PRICE] == "7.50" && item[MENU_PREP_TIME] == "9");
+    CHECK(formatMenuLine(item) == "5, Noodles ,7.50,9,3");
+
+    CHECK(!parseMenuLine("6,Cake,3.00,4", item)); // No stock
+    CHECK(!parseMenuLine("6,Cake,three,4,10", item));
+    CHECK(!parseMenuLine("6,Cake,3.00,4,ten", item));
+
+    // Combo components: repeated items are merged, and each entry must be an existing item that is not a combo
+    vector<ComboComponent> components;
+    CHECK(parseComboComponents("1:1;2:2;1:1", arrMenuContent, numOfLines, components));
+    CHECK(components.size() == 2 && components[0].row == 0 && components[0].quantity == 2);
+    CHECK(components.size() == 2 && components[1].row == 1 && components[1].quantity == 2);
+    CHECK(parseComboComponents("", arrMenuContent, numOfLines, components) && components.size() == 2);
+
+    CHECK(!parseComboComponents("4:1", arrMenuContent, numOfLines, components)); // A combo
+    CHECK(!parseComboComponents("9:1", arrMenuContent, numOfLines, components)); // No such item
+    CHECK(!parseComboComponents("1:0", arrMenuContent, numOfLines, components));
+    CHECK(!parseComboComponents("1:x", arrMenuContent, numOfLines, components));
+    CHECK(!parseComboComponents("1", arrMenuContent, numOfLines, components));
+    CHECK(!parseComboComponents(":1", arrMenuContent, numOfLines, components));
+    CHECK(!parseComboComponents("1:1,2:1", arrMenuContent, numOfLines, components));
+}
+
+// Function to test that a search of the item names finds every name containing the query, prefix matches first
+void testMenuSearch() {
+    const string names[] = {"Chicken Rice", "Fried Rice", "Rice Pudding", "Iced Tea", "Spicy Chicken Wings", "Tea"};
+    const int numOfItems = sizeof(names) / sizeof(names[0]);
+    string fields[numOfItems][NUM_OF_MENU_FIELDS]; // Details of each item
+    string* arrMenuContent[numOfItems]; // The items as the rows of a menu
+    for (int i = 0; i < numOfItems; i++) {
+        fields[i][MENU_NAME] = names[i];
+        arrMenuContent[i] = fields[i];
+    }
+    MenuSearchIndex searchIndex;
+    buildMenuSearchIndex(arrMenuContent, numOfItems, searchIndex);
+
+    CHECK(searchMenu(searchIndex, "rice") == vector<int>({2, 0, 1})); // "Rice Pudding" starts with the query
+    CHECK(searchMenu(searchIndex, "CHICKEN") == vector<int>({0, 4})); // Case is ignored
+    CHECK(searchMenu(searchIndex, "ken wi") == vector<int>({4})); // Across words
+    CHECK(searchMenu(searchIndex, "tea") == vector<int>({5, 3}));
+    CHECK(searchMenu(searchIndex, "te") == vector<int>({5, 3})); // Too short for a trigram
+    CHECK(searchMenu(searchIndex, "e") == vector<int>({0, 1, 2, 3, 4, 5}));
+    CHECK(searchMenu(searchIndex, "iced rice").empty()); // Every trigram is in the menu, but no name has all of them
+    CHECK(searchMenu(searchIndex, "rice tea").empty()); // "e t" is in no name
+    CHECK(searchMenu(searchIndex, "noodle").empty());
+    CHECK(searchMenu(searchIndex, "").empty());
+}
+
+// Function to return a time of today, in local time
+time_t timeOfDay(int hour, int minute) {
+    time_t now = time(0);
+    tm day;
+    localtime_r(&now, &day);
+    day.tm_hour = hour;
+    day.tm_min = minute;
+    day.tm_sec = 0;
+    day.tm_isdst = -1;
+    return mktime(&day);
+}
+
+// Function to test that priceCart picks the best discount of each line and shares the order discount out exactly
+void testPriceCart() {
+    MenuModel model; // Row 0 is in the "Mains" category, row 1 has no category
+    model.categories = {"", "Mains"};
+    model.itemCategory = {1, 0};
+
+    PromotionPlan plan;
+    plan.ruleNames = {"Mains 10% off", "Drinks 3 for 2", "Loyalty 5%", "Welcome 10%", "Lunch hour", "Late night"};
+    plan.rowPercent = {10, 0};
+    plan.rowPercentRule = {0, 0};
+    plan.rowBuyQuantity = {0, 2};
+    plan.rowFreeQuantity = {0, 1};
+    plan.rowDealRule = {0, 1};
+    plan.loyaltyTiers = {{5, 5, 2}};
+    plan.newcomerPercent = 10;
+    plan.newcomerRule = 3;
+    plan.happyHours = {{15 * 60, 17 * 60, 1, 20, 4}, {22 * 60, 2 * 60, -1, 30, 5}};
+
+    const vector<CartLine> lines = {{0, Money{1000}, 2}, {1, Money{300}, 3}};
+
+    // A loyal customer outside the happy hours: 10% off the mains, one drink free, then 5% off the rest
+    PricedCart cart = priceCart(plan, model, lines, 5, timeOfDay(12, 0));
+    CHECK(cart.subtotal.cents == 2900);
+    CHECK(cart.discount.cents == 620);
+    CHECK(cart.total.cents == 2280);
+    CHECK(cart.lineRevenue.size() == 2 && cart.lineRevenue[0].cents == 1710 && cart.lineRevenue[1].cents == 570);
+    CHECK(cart.ruleSavings.size() == 6 && cart.ruleSavings[0].cents == 200 && cart.ruleSavings[1].cents == 300
+          && cart.ruleSavings[2].cents == 120 && cart.ruleSavings[3].cents == 0);
+
+    // A new customer in the lunch hour: the happy hour beats the mains discount
+    cart = priceCart(plan, model, lines, 0, timeOfDay(16, 0));
+    CHECK(cart.total.cents == 1980);
+    CHECK(cart.lineRevenue.size() == 2 && cart.lineRevenue[0].cents == 1440 && cart.lineRevenue[1].cents == 540);
+    CHECK(cart.ruleSavings.size() == 6 && cart.ruleSavings[0].cents == 0 && cart.ruleSavings[4].cents == 400
+          && cart.ruleSavings[3].cents == 220);
+
+    // A window running past midnight is open after midnight; the drink deal still beats its 30%
+    cart = priceCart(plan, model, lines, 0, timeOfDay(1, 0));
+    CHECK(cart.total.cents == 1800);
+    CHECK(cart.ruleSavings.size() == 6 && cart.ruleSavings[5].cents == 600 && cart.ruleSavings[1].cents == 300);
+
+    // An item no longer on the menu gets no item discount, and a customer below every tier no order discount
+    cart = priceCart(plan, model, {{7, Money{150}, 2}}, 1, timeOfDay(12, 0));
+    CHECK(cart.subtotal.cents == 300 && cart.discount.cents == 0 && cart.total.cents == 300);
+    CHECK(priceCart(plan, model, {}, 0, timeOfDay(12, 0)).total.cents == 0);
+}
+
+// Function to test that a cart is paid at the prices it was pinned to, whatever price update came after
+void testPinnedPrices() {
+    const string lines[] = {
+        "1,Chicken Rice,8.50,12,40,Mains,S:Regular:0.00;S:Large:1.50;A:Egg:0.80",
+        "2,Iced Tea,2.00,2,100",
+    };
+    BranchCatalog catalog; // The menu, released by the catalog like a loaded one
+    catalog.totalNumItems = 2;
+    catalog.arrMenuContent = new string*[catalog.totalNumItems];
+    for (int i = 0; i < catalog.totalNumItems; i++) {
+        catalog.arrMenuContent[i] = new string[NUM_OF_MENU_FIELDS];
+        CHECK(parseMenuLine(lines[i], catalog.arrMenuContent[i]));
+    }
+    buildMenuModel(catalog.arrMenuContent, catalog.totalNumItems, catalog.model);
+    shared_ptr<const PriceSnapshot> pinned = buildPriceSnapshot(catalog.arrMenuContent, catalog.totalNumItems, nullptr);
+
+    // A large chicken rice with egg, two iced teas, and an item taken off the menu after it was ordered
+    vector<ReceiptLine> cart(3);
+    cart[0].menuIndex = 1;
+    cart[0].modifierMask = 0b110;
+    cart[0].quantity = 1;
+    cart[1].menuIndex = 2;
+    cart[1].quantity = 2;
+    cart[2].menuIndex = 9;
+    cart[2].itemPrice = Money{450};
+    cart[2].quantity = 1;
+
+    // The manager raises both prices while the customer is paying
+    catalog.arrMenuContent[0][MENU_PRICE] = "9.00";
+    catalog.arrMenuContent[1][MENU_PRICE] = "2.20";
+    shared_ptr<const PriceSnapshot> updated = buildPriceSnapshot(catalog.arrMenuContent, catalog.totalNumItems, pinned);
+    CHECK(updated != pinned && updated->version > pinned->version);
+
+    vector<CartLine> cartLines = priceReceiptLines(cart, *pinned, catalog);
+    CHECK(cartLines.size() == 3 && cartLines[0].row == 0 && cartLines[0].unitPrice.cents == 1080);
+    CHECK(cartLines.size() == 3 && cartLines[1].row == 1 && cartLines[1].unitPrice.cents == 200 && cartLines[1].quantity == 2);
+    CHECK(cartLines.size() == 3 && cartLines[2].row == -1 && cartLines[2].unitPrice.cents == 450);
+    CHECK(calcTotalPaymentsPerOrder(cartLines).cents == 1930);
+
+    // A cart started after the update pays the new prices
+    cartLines = priceReceiptLines(cart, *updated, catalog);
+    CHECK(calcTotalPaymentsPerOrder(cartLines).cents == 1130 + 440 + 450);
+
+    // A version with no price changed is the same version
+    CHECK(buildPriceSnapshot(catalog.arrMenuContent, catalog.totalNumItems, updated) == updated);
+}
+
+// Function to test that stock reserved by an unpaid cart is kept from other carts until the cart expires
+void testStockReservations() {
+    const string lines[] = {
+        "1,Chicken Rice,8.50,12,5",
+        "2,Iced Tea,2.00,2,3",
+        "3,Lunch Set,10.00,15,0,Combos,,1:1;2:1",
+    };
+    BranchCatalog catalog; // The menu, released by the catalog like a loaded one
+    catalog.totalNumItems = 3;
+    catalog.arrMenuContent = new string*[catalog.totalNumItems];
+    for (int i = 0; i < catalog.totalNumItems; i++) {
+        catalog.arrMenuContent[i] = new string[NUM_OF_MENU_FIELDS];
+        CHECK(parseMenuLine(lines[i], catalog.arrMenuContent[i]));
+    }
+    buildMenuModel(catalog.arrMenuContent, catalog.totalNumItems, catalog.model);
+    time_t start = time(0); // No cart reserved from here on expires before start + RESERVATION_TTL_SECONDS
+
+    // Two lunch sets reserve their components; a second cart cannot have the last two iced teas
+    int firstOrder = createReservation();
+    int secondOrder = createReservation();
+    CHECK(firstOrder != secondOrder);
+    CHECK(reserveStock(firstOrder, catalog.arrMenuContent, catalog.model, 2, 2));
+    CHECK(reservedQuantity(1) == 2 && reservedQuantity(2) == 2 && reservedQuantity(3) == 0);
+    CHECK(!reserveStock(secondOrder, catalog.arrMenuContent, catalog.model, 1, 2));
+    CHECK(reservedQuantity(2) == 2);
+    CHECK(reserveStock(secondOrder, catalog.arrMenuContent, catalog.model, 1, 1));
+    CHECK(!reserveStock(secondOrder, catalog.arrMenuContent, catalog.model, 2, 1)); // Only the rice is left
+    CHECK(reservedQuantity(1) == 2 && reservedQuantity(2) == 3);
+
+    // The carts are still held just before they are due to expire, and their stock comes back once they have
+    {
+        lock_guard<mutex> lock(stockReservations.lock);
+        advanceReservations(stockReservations, start + RESERVATION_TTL_SECONDS - 1);
+        CHECK(stockReservations.reservations.size() == 2);
+        advanceReservations(stockReservations, time(0) + RESERVATION_TTL_SECONDS);
+        CHECK(stockReservations.reservations.empty() && stockReservations.reservedStock.empty());
+    }
+    int thirdOrder = createReservation();
+    CHECK(reserveStock(thirdOrder, catalog.arrMenuContent, catalog.model, 1, 3));
+    CHECK(reservedQuantity(2) == 3);
+
+    // A cart given up gives its stock back at once
+    releaseReservation(thirdOrder);
+    CHECK(reservedQuantity(2) == 0);
+}
+
+// Function to write a branch's menu file, replacing any it had
+void writeTestMenu(string branchId, string content) {
+    ofstream file(branchPath(branchId, "menu.txt"), ios::trunc);
+    file << content;
+}
+
+// Function to test that a branch's catalog cache is used while only the stock changes, and rebuilt once the layout does
+void testCatalogCache() {
+    const string branchId = "cache_test"; // A branch of its own, so the working directory's menu is left alone
+    filesystem::create_directories(branchPath(branchId, ""));
+    writeTestMenu(branchId, "1,Chicken Rice,8.50,12,40\n2,Iced Tea,2.00,2,100\n");
+
+    // The first load parses the menu file and writes the cache
+    shared_ptr<BranchCatalog> catalog = loadBranchCatalog(branchId);
+    CHECK(catalog->totalNumItems == 2 && !catalog->cacheFile.mapped);
+    CHECK(filesystem::exists(branchPath(branchId, "menu.cache")));
+
+    // A change of stock alone keeps the cache current: the menu comes from it, with the new stock
+    writeTestMenu(branchId, "1,Chicken Rice,8.50,12,7\n2,Iced Tea,2.00,2,100\n");
+    catalog = loadBranchCatalog(branchId);
+    CHECK(catalog->totalNumItems == 2 && catalog->cacheFile.mapped);
+    CHECK(catalog->arrMenuContent[0][MENU_STOCK] == "7" && catalog->arrMenuContent[1][MENU_NAME] == "Iced Tea");
+    CHECK(searchMenu(catalog->searchIndex, "tea") == vector<int>({1}));
+
+    // A renamed item changes the layout, so the cache is rejected and the menu parsed again
+    writeTestMenu(branchId, "1,Chicken Rice,8.50,12,7\n2,Iced Lemon Tea,2.50,2,100\n");
+    catalog = loadBranchCatalog(branchId);
+    CHECK(catalog->totalNumItems == 2 && !catalog->cacheFile.mapped);
+    CHECK(catalog->arrMenuContent[1][MENU_NAME] == "Iced Lemon Tea" && catalog->arrMenuContent[1][MENU_PRICE] == "2.50");
+    CHECK(searchMenu(catalog->searchIndex, "lemon") == vector<int>({1}));
+
+    // So is a new item
+    writeTestMenu(branchId, "1,Chicken Rice,8.50,12,7\n2,Iced Lemon Tea,2.50,2,100\n3,Soup,4.00,5,20\n");
+    catalog = loadBranchCatalog(branchId);
+    CHECK(catalog->totalNumItems == 3 && !catalog->cacheFile.mapped);
+
+    // The cache written for the new layout is used by the next load
+    writeTestMenu(branchId, "1,Chicken Rice,8.50,12,6\n2,Iced Lemon Tea,2.50,2,100\n3,Soup,4.00,5,20\n");
+    catalog = loadBranchCatalog(branchId);
+    CHECK(catalog->totalNumItems == 3 && catalog->cacheFile.mapped);
+    CHECK(catalog->arrMenuContent[0][MENU_STOCK] == "6" && catalog->arrMenuContent[2][MENU_NAME] == "Soup");
+
+    catalog.reset();
+    branchCatalogCache.clear();
+    filesystem::remove_all(branchPath(branchId, ""));
+    error_code error; // Set (instead of throwing) when other branches are left in the folder
+    filesystem::remove("branches", error);
+}
+
+// Function to test that a consumption rate follows the orders: it settles at a steady flow, fades while nothing
+// is ordered, and does not depend on the order the uses are added in
+void testConsumptionRates() {
+    const time_t start = 1700000000; // A fixed time, so the test does not depend on the clock
+
+    // Three units every hour for two days comes close to three units per hour
+    ConsumptionRate steady;
+    for (int hour = 0; hour <= 48; hour++)
+        addConsumption(steady, 3, start + hour * 3600);
+    CHECK(fabs(currentRate(steady, start + 48 * 3600) - 3.0) < 0.5);
+
+    // Without orders it fades by e^-1 every CONSUMPTION_WINDOW_HOURS, and never changes looking back
+    double rate = currentRate(steady, start + 48 * 3600);
+    time_t later = start + 48 * 3600 + (time_t)(CONSUMPTION_WINDOW_HOURS * 3600);
+    CHECK(fabs(currentRate(steady, later) - rate * exp(-1.0)) < 1e-9);
+    CHECK(currentRate(steady, start) == steady.perHour);
+
+    // Uses added out of order come to the same rate as in order
+    ConsumptionRate inOrder;
+    ConsumptionRate outOfOrder;
+    addConsumption(inOrder, 5, start);
+    addConsumption(inOrder, 2, start + 1800);
+    addConsumption(inOrder, 4, start + 7200);
+    addConsumption(outOfOrder, 4, start + 7200);
+    addConsumption(outOfOrder, 5, start);
+    addConsumption(outOfOrder, 2, start + 1800);
+    CHECK(outOfOrder.updatedAt == inOrder.updatedAt);
+    CHECK(fabs(outOfOrder.perHour - inOrder.perHour) < 1e-9);
+}
+
+// Function to test that events written to a stream read back unchanged, numbered in the order they were written
+void testEventStream() {
+    string path = (filesystem::temp_directory_path() / ("ninjafood_tests_events_" + to_string(getpid()) + ".log")).string();
+    filesystem::remove(path);
+
+    vector<EventRecord> events; // Events to write
+    addEvent(events, EVENT_ORDER_ACCEPTED, 12, 3, 2, 850);
+    addEvent(events, EVENT_STOCK_CHANGED, 0, 3, 2, 38);
+    CHECK(appendEvents(path, string((const char*)events.data(), events.size() * sizeof(EventRecord))));
+
+    // A record left half written is dropped before the next batch is numbered
+    {
+        ofstream file(path, ios::binary | ios::app);
+        file << "torn";
+    }
+    vector<EventRecord> payment; // Event of a second batch
+    addEvent(payment, EVENT_PAYMENT_COMPLETED, 12, 0, 1, 1700);
+    CHECK(appendEvents(path, string((const char*)payment.data(), sizeof(EventRecord))));
+    CHECK(filesystem::file_size(path) == 3 * sizeof(EventRecord));
+
+    vector<EventRecord> read; // Events read back
+    CHECK(readEvents(path, 0, read) == 3);
+    if (read.size() == 3) {
+        for (size_t i = 0; i < read.size(); i++)
+            CHECK(read[i].sequence == i + 1);
+        CHECK(read[0].type == EVENT_ORDER_ACCEPTED && read[0].orderId == 12 && read[0].menuIndex == 3
+              && read[0].quantity == 2 && read[0].value == 850);
+        CHECK(read[0].kiosk == (uint32_t)getpid() && read[0].time == events[0].time);
+        CHECK(read[1].type == EVENT_STOCK_CHANGED && read[1].value == 38);
+        CHECK(read[2].type == EVENT_PAYMENT_COMPLETED && read[2].quantity == 1 && read[2].value == 1700);
+        CHECK(describeEvent(read[1]).find("STOCK_CHANGED item=3 used=2 left=38") != string::npos);
+        CHECK(describeEvent(read[2]).find("PAYMENT_COMPLETED kiosk=" + to_string(getpid()) + " order=12 lines=1 paid=17.00")
+              != string::npos);
+    }
+
+    // A subscriber only reads the events after the last one it has seen
+    read.clear();
+    CHECK(readEvents(path, 2, read) == 1 && read[0].sequence == 3);
+    read.clear();
+    CHECK(readEvents(path, 3, read) == 0);
+    filesystem::remove(path);
+}
+
+// Function to test that kiosk processes paying at the same time all update the same customer profiles
+// Each kiosk records orders for one shared customer and one customer of its own, each time under a new name
+void testCustomerProfiles() {
+#ifndef _WIN32
+    const int numOfKiosks = 4;
+    const int numOfOrders = 200; // Orders each kiosk records for each of its two customers
+    currentBranchId = "tests-profiles-" + to_string(getpid());
+    filesystem::create_directories(dataPath(""));
+
+    vector<pid_t> kiosks; // The kiosk processes
+    for (int kiosk = 0; kiosk < numOfKiosks; kiosk++) {
+        pid_t child = fork();
+        if (child == 0) {
+            UserDetails shared; // The customer every kiosk serves
+            shared.phoneNumber = "0123456789";
+            UserDetails own; // The customer only this kiosk serves
+            own.phoneNumber = "01100000000" + to_string(kiosk);
+            own.phoneNumber = own.phoneNumber.substr(own.phoneNumber.length() - 11);
+            for (int order = 0; order < numOfOrders; order++) {
+                shared.customerName = "Ali " + to_string(kiosk) + "-" + to_string(order);
+                own.customerName = "Kiosk " + to_string(kiosk) + " regular " + to_string(order);
+                recordCustomerOrder(shared, order, Money{100}, {1}, {1});
+                recordCustomerOrder(own, order, Money{250}, {2}, {2});
+            }
+            _exit(0);
+        }
+        kiosks.push_back(child);
+    }
+    for (pid_t kiosk : kiosks) {
+        int status = 0;
+        waitpid(kiosk, &status, 0);
+        CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+
+    // Every order is counted once, in a profile of its own for each customer
+    vector<CustomerProfile> profiles;
+    CHECK(readCustomerProfiles(dataPath("customer_profiles.dat"), profiles));
+    CHECK(profiles.size() == numOfKiosks + 1);
+    int numOfShared = 0; // Profiles of the shared customer
+    for (const CustomerProfile& profile : profiles) {
+        if (profile.phoneKey == customerPhoneKey("0123456789")) {
+            ++numOfShared;
+            CHECK(profile.visitCount == numOfKiosks * numOfOrders);
+            CHECK(profile.lifetimeSpend == numOfKiosks * numOfOrders * 100);
+            CHECK(readCustomerName(dataPath("customer_names.dat"), profile).rfind("Ali ", 0) == 0);
+        } else {
+            CHECK(profile.visitCount == numOfOrders);
+            CHECK(profile.lifetimeSpend == numOfOrders * 250);
+            CHECK(readCustomerName(dataPath("customer_names.dat"), profile).find(" regular " + to_string(numOfOrders - 1)) != string::npos);
+        }
+    }
+    CHECK(numOfShared == 1);
+
+    // A kiosk that has loaded the profiles sees the orders other kiosks record afterwards
+    CHECK(customerVisitCount("0123456789") == numOfKiosks * numOfOrders);
+    CHECK(customerVisitCount("0199999999") == 0);
+    pid_t kiosk = fork();
+    if (kiosk == 0) {
+        UserDetails newcomer; // A customer the loaded profiles do not have yet
+        newcomer.phoneNumber = "0199999999";
+        newcomer.customerName = "Siti";
+        recordCustomerOrder(newcomer, 0, Money{500}, {3}, {1});
+        _exit(0);
+    }
+    waitpid(kiosk, nullptr, 0);
+    CHECK(customerVisitCount("0199999999") == 1);
+
+    customerProfiles.file.close();
+    filesystem::remove_all(branchPath(currentBranchId, ""));
+    error_code error; // Set (instead of throwing) when other branches are left in the folder
+    filesystem::remove("branches", error);
+    currentBranchId.clear();
+#endif
+}
+
+// Function to test the checks of the card numbers and phone numbers customers pay from
+void testTenderReferences() {
+    CHECK(validTenderReference(TenderReference::CardNumber, "4111111111111111"));
+    CHECK(validTenderReference(TenderReference::CardNumber, "4000000000000002")); // Declined by the gateway, not here
+    CHECK(validTenderReference(TenderReference::CardNumber, "378282246310005")); // 15 digits
+    CHECK(validTenderReference(TenderReference::CardNumber, "000000000000"));
+    CHECK(!validTenderReference(TenderReference::CardNumber, "4111111111111112")); // Mistyped digit
+    CHECK(!validTenderReference(TenderReference::CardNumber, "4111111111111121")); // Swapped digits
+    CHECK(!validTenderReference(TenderReference::CardNumber, "00000000000")); // Too short
+    CHECK(!validTenderReference(TenderReference::CardNumber, "00000000000000000000")); // Too long
+    CHECK(!validTenderReference(TenderReference::CardNumber, "4111 1111 1111 1111"));
+    CHECK(!validTenderReference(TenderReference::CardNumber, ""));
+
+    CHECK(validTenderReference(TenderReference::PhoneNumber, "0123456789"));
+    CHECK(validTenderReference(TenderReference::PhoneNumber, "01234567890"));
+    CHECK(!validTenderReference(TenderReference::PhoneNumber, "012345678"));
+    CHECK(!validTenderReference(TenderReference::PhoneNumber, "012345678901"));
+    CHECK(!validTenderReference(TenderReference::PhoneNumber, "012-3456789"));
+
+    CHECK(validTenderReference(TenderReference::None, ""));
+}
+
+// Structure to name one group of tests
+struct TestGroup {
+    const char* name; // Name the group is run by
+    void (*run)(); // Function running the group's checks
+};
+
+// Every group of tests, in the order they run
+const TestGroup TEST_GROUPS[] = {
+    {"money", testParseMoney},
+    {"input", testInputParser},
+    {"menu", testMenuLines},
+    {"search", testMenuSearch},
+    {"cache", testCatalogCache},
+    {"pricing", testPriceCart},
+    {"events", testEventStream},
+    {"tenders", testTenderReferences},
+    {"prices", testPinnedPrices},
+    {"reservations", testStockReservations},
+    {"forecast", testConsumptionRates},
+    {"profiles", testCustomerProfiles},
+};
+
+// Entry point of the tests: runs the group named on the command line, or every group
+int main(int argc, char** argv) {
+    bool found = false; // Whether a group was run
+    for (const TestGroup& group : TEST_GROUPS) {
+        if (argc > 1 && strcmp(argv[1], group.name) != 0)
+            continue;
+        group.run();
+        found = true;
+    }
+    if (!found) {
+        cerr << "No test group named " << argv[1] << "\n";
+        return 2;
+    }
+    return numOfFailedChecks == 0 ? 0 : 1;
+}